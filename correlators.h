@@ -23,11 +23,132 @@ Class member function: functionMember
 #include <string>
 #include <sstream>
 #include <cassert>
+#include <type_traits>
 #include "dsp_complex.h"
+#include "dsptl_simd.h"
 
 
 //#define CREATE_DEBUG_FILES
 
+namespace dsptl
+{
+
+	/// Internal status of the correlators. This is mainly done in order to
+	/// have visibility in the correlator operation from the calling code
+	struct CorrelatorState
+	{
+		static const int Nelements = 3;
+		float InputEnergy;
+		uint32_t coeffsEnergy;
+		int coeffScaling;
+		uint32_t energyValue[Nelements] ;
+		uint32_t corrValue[Nelements] ;
+		double thresholdFactor;
+		std::string prettyString()
+		{	std::ostringstream os;
+			os << "Input Energy: " << InputEnergy << '\n';
+			os << "Coeffs Energy: " << coeffsEnergy << '\n';
+			os << "Coeff Scaling: " << coeffScaling << '\n';	
+			os << "Threshold Factor: " << thresholdFactor << '\n';
+			for(int index = 0; index < Nelements; ++index)
+				os << "Energy Value " << index << ": " << energyValue[index] << '\n';
+			for(int index = 0; index < Nelements; ++index)
+				os << "CorrValue " << index << ": " << corrValue[index] << '\n';
+
+			return os.str();
+		}
+	};
+
+} // End of namespace
+
+namespace dsptl_private
+{
+
+	/*-----------------------------------------------------------------------------
+	Squared magnitude of an input sample, with the arithmetic of the energy
+	computation of the correlators
+	------------------------------------------------------------------------------*/
+	template<class CompType, class InType>
+	uint32_t correlatorPower(const std::complex<InType> &sample)
+	{
+		std::complex<CompType> x(sample);
+		return x.real() * x.real() + x.imag() * x.imag();
+	}
+
+	/*-----------------------------------------------------------------------------
+	Store the conjugate of a correlation pattern and compute the energy and the
+	scaling related to it
+
+	@param[in] in Correlation pattern
+	@param[out] coeffs Conjugate of the pattern
+	@param[out] state Status of the correlator holding the energy and scaling
+	@param[in] thresholdCoeff Threshold factor
+	------------------------------------------------------------------------------*/
+	template<class CompType, size_t N>
+	void setCorrelatorPattern(const std::array<std::complex<CompType>, N > &in, std::array<std::complex<CompType>, N > &coeffs,
+		dsptl::CorrelatorState &state, double thresholdCoeff)
+	{
+		coeffs = in;
+
+		// We conjuguate the coefficients
+		for (auto it = coeffs.begin(); it != coeffs.end(); ++it)
+		{
+			*it = std::complex<CompType>(it->real(), -it->imag());
+		}
+
+		// We compute the energy in the coefficients
+		state.coeffsEnergy = 0;
+		double tmp = 0;
+		for (size_t index = 0; index < N; ++index)
+		{
+			tmp += (coeffs[index].real() * coeffs[index].real() + coeffs[index].imag() * coeffs[index].imag());
+		}
+		assert(tmp <= 1073217600); // Each coeffs value must be less than 13 bits.
+
+		state.coeffsEnergy = static_cast<uint32_t>(tmp);
+		state.thresholdFactor = thresholdCoeff * sqrt(state.coeffsEnergy);
+
+		state.coeffScaling = static_cast<int>(floor(log2(sqrt(state.coeffsEnergy))));
+	}
+
+	/*-----------------------------------------------------------------------------
+	Push the correlation value and the energy of a new sample in the status of a
+	correlator and test if the previous sample is a correlation peak
+
+	@param[in,out] state Status of the correlator
+	@param[in] corr Correlation value of the new sample, before scaling
+	@param[in] energy Energy of the samples used by the correlation, before scaling
+
+	@return true if the previous sample is a peak which exceeded the threshold
+	------------------------------------------------------------------------------*/
+	template<class CompType>
+	bool correlatorPeak(dsptl::CorrelatorState &state, std::complex<CompType> corr, uint32_t energy)
+	{
+		state.energyValue[2] = state.energyValue[1];
+		state.energyValue[1] = state.energyValue[0];
+
+		corr = scale32(corr, state.coeffScaling);  // V2 dimension
+		state.energyValue[0] = energy >> (state.coeffScaling/2);  // V2 dimension
+
+		// Store the squared magnitude of the correlation values
+		state.corrValue[2] = state.corrValue[1];
+		state.corrValue[1] = state.corrValue[0];
+		state.corrValue[0] = (corr.real() >> 2)*(corr.real()>>2) + (corr.imag()>>2) * (corr.imag()>>2);
+
+		// Is the middle point (index 1) a peak?
+		if (state.corrValue[1] > state.corrValue[2] && state.corrValue[1] > state.corrValue[0])
+		{
+			// Has the middle point (index 1) exceeded the threshold?
+			double corrMagnitude = sqrt(state.corrValue[1]); // magnitude of the correlation
+			double energyMagnitude = sqrt(state.energyValue[1]); // magnitude of the signal energy
+			// Initial values before debugging were 2.5 and 200
+			return corrMagnitude > energyMagnitude * 2.7 && energyMagnitude > 300;
+		}
+		return false;
+	}
+
+} // End of namespace
+
 namespace dsptl
 {
 
@@ -41,6 +162,14 @@ namespace dsptl
 	When debugging files are created, the routine will not exit after the first found correlation
 	point.
 
+	Each correlation point uses the last N samples of one of the S phases of the input
+	(the position of the samples in the stream modulo S). The history is made of S buffers,
+	one per phase, in which each sample is stored twice, at pos and pos + N. The N
+	samples of a phase are then contiguous, the oldest first, and each correlation point
+	is a unit stride inner product with the coefficients. For int16_t inputs and int32_t
+	computations, the inner product uses the SSE2 or AVX2 kernels of dsptl_simd.h when
+	the coefficients fit in 16 bits.
+
 
 
 	@tparam InType Data type of the input signal
@@ -54,45 +183,38 @@ namespace dsptl
 	template<class InType = int16_t, class CompType = int32_t, size_t N = 32, size_t S = 4 >
 	class FixedPatternCorrelator
 	{
-		/// Internal status of the correlator. This is mainly done in order to
-		/// have visibility in the correlator operation from the calling code
-		struct CorrState 
-		{
-			static const int Nelements = 3;
-			float InputEnergy;
-			uint32_t coeffsEnergy;
-			int coeffScaling;
-			uint32_t energyValue[Nelements] ;
-			uint32_t corrValue[Nelements] ;
-			double thresholdFactor;
-			std::string prettyString()
-			{	std::ostringstream os;
-				os << "Input Energy: " << InputEnergy << '\n';
-				os << "Coeffs Energy: " << coeffsEnergy << '\n';
-				os << "Coeff Scaling: " << coeffScaling << '\n';	
-				os << "Threshold Factor: " << thresholdFactor << '\n';
-				for(int index = 0; index < Nelements; ++index)
-					os << "Energy Value " << index << ": " << energyValue[index] << '\n';
-				for(int index = 0; index < Nelements; ++index)
-					os << "CorrValue " << index << ": " << corrValue[index] << '\n';
-
-				return os.str();
-			}
-		};
-
-
 	public:
+		/// Internal status of the correlator
+		typedef CorrelatorState CorrState;
+
 		FixedPatternCorrelator();
 		bool step(const std::vector <std::complex<InType> > &in, int & corrIndex);
+		bool step(const std::complex<InType> *in, size_t size, int & corrIndex);
 		void setPattern(const std::array<std::complex<CompType>, N > &in, double thresholdCoeff = 0.8 );
 		void reset();
 		std::vector<std::complex<InType>> getRefBitSamples();
 		CorrState getStatus(){return state;};
 
 	private:
-		std::array < std::complex<CompType>, N*S> history;
+		/// Indicates if the vectorized inner product can be used with these types
+		typedef std::integral_constant<bool, std::is_same<InType, int16_t>::value
+			&& std::is_same<CompType, int32_t>::value> SimdEligible;
+
+		// Inner product of the coefficients with the N samples of a phase
+		std::complex<CompType> innerProduct(const std::complex<InType> *window, std::true_type);
+		std::complex<CompType> innerProduct(const std::complex<InType> *window, std::false_type);
+
+		/// Phase buffers of 2N samples. Phase p starts at p * 2N
+		std::array < std::complex<InType>, 2*N*S> history;
 		std::array < std::complex<CompType>, N > coeffs;
+		/// Coefficients as the pairs of 16 bits values used by dotComplexByComplex16()
+		std::array < int16_t, 2*N > coeffsRe;
+		std::array < int16_t, 2*N > coeffsIm;
+		bool useSimd;		///< True if the vectorized inner product is used
 		std::vector < std::complex<InType> > bitSamples;
+		/// Energy of the history samples of each phase modulo S. The N samples
+		/// used by a correlation point all have the same phase
+		std::array < uint32_t, S > phaseEnergy;
 
 		//uint32_t state.coeffsEnergy;
 		//uint32_t corrValue[3] ;
@@ -121,7 +243,7 @@ namespace dsptl
 	------------------------------------------------------------------------------*/
 	template<class InType, class CompType, size_t N, size_t S >
 		FixedPatternCorrelator<InType, CompType, N, S >::FixedPatternCorrelator()
-	:top(0)
+	:useSimd(false), top(0)
 	{
 		bitSamples.assign(N, {});
 		reset();
@@ -149,6 +271,8 @@ namespace dsptl
 			history[k] = {};
 		for (size_t k = 0; k < bitSamples.size(); ++k)
 			bitSamples[k] = {};
+		for (size_t k = 0; k < S; ++k)
+			phaseEnergy[k] = 0;
 		cntProcessedSamples = 0;
 
 	}
@@ -167,28 +291,22 @@ namespace dsptl
 	template<class InType, class CompType, size_t N, size_t S >
 	void FixedPatternCorrelator<InType, CompType, N, S >::setPattern(const std::array<std::complex<CompType>, N > &in, double thresholdCoeff)
 	{
-		coeffs = in;
-
-		// We conjuguate the coefficients
-		for (auto it = coeffs.begin(); it != coeffs.end(); ++it)
-		{
-			*it = std::complex<CompType>(it->real(), -it->imag());
-		}
+		dsptl_private::setCorrelatorPattern(in, coeffs, state, thresholdCoeff);
 
-		// We compute the energy in the coefficients
-		state.coeffsEnergy = 0;
-		double tmp = 0;
+		// Pairs used by the vectorized inner product. See dotComplexByComplex16()
+		useSimd = SimdEligible::value;
 		for (size_t index = 0; index < N; ++index)
 		{
-			tmp += (coeffs[index].real() * coeffs[index].real() + coeffs[index].imag() * coeffs[index].imag());
+			CompType re = coeffs[index].real();
+			CompType im = coeffs[index].imag();
+			// -im must also fit in 16 bits
+			if (re > INT16_MAX || re < INT16_MIN || im > INT16_MAX || im <= INT16_MIN)
+				useSimd = false;
+			coeffsRe[2 * index] = static_cast<int16_t>(re);
+			coeffsRe[2 * index + 1] = static_cast<int16_t>(-im);
+			coeffsIm[2 * index] = static_cast<int16_t>(im);
+			coeffsIm[2 * index + 1] = static_cast<int16_t>(re);
 		}
-		assert(tmp <= 1073217600); // Each coeffs value must be less than 13 bits.
-
-		state.coeffsEnergy = static_cast<uint32_t>(tmp);
-		state.thresholdFactor = thresholdCoeff * sqrt(state.coeffsEnergy);
-
-		state.coeffScaling = static_cast<int>(floor(log2(sqrt(state.coeffsEnergy))));
-
 
 
 	}
@@ -197,7 +315,12 @@ namespace dsptl
 	/*-----------------------------------------------------------------------------
 	Each S element of the input vector is copied in the history buffer at the right
 	location. The inner product between the history and the coeffs buffer is then 
-	computed
+	computed\n
+
+	The energy of the N samples of the inner product is not recomputed: the energy
+	of each phase modulo S of the history is updated with the sample which enters
+	the history and the one it replaces. The arithmetic is modulo 2^32 as the sum
+	over the N samples, hence the result is identical.
 
 	@param[in] in Samples to correlate
 	@param[out] corrIndex Index related to the input buffer at which the correlation occurred
@@ -209,11 +332,25 @@ namespace dsptl
 	template<class InType, class CompType, size_t N, size_t S >
 	bool FixedPatternCorrelator<InType, CompType, N, S >::step(const std::vector < std::complex<InType> > &in, int & corrIndex)
 	{
-		int inSize = in.size();
-		int historySize = static_cast<int>(history.size());
+		return step(in.data(), in.size(), corrIndex);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Version of step() working on a range of samples without any copy, for example
+	part of a larger capture buffer
+
+	@param[in] in First sample to correlate
+	@param[in] size Number of samples to correlate
+	@param[out] corrIndex Index related to in at which the correlation occurred
+
+	@return true if correlation peak has been detected; false otherwise
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S >
+	bool FixedPatternCorrelator<InType, CompType, N, S >::step(const std::complex<InType> *in, size_t size, int & corrIndex)
+	{
+		int inSize = static_cast<int>(size);
+		const size_t historySize = N * S;
 		std::complex< CompType> tmp;
-		int k;
-		int hIndex;
 		bool syncFound = false;
 
 
@@ -221,33 +358,19 @@ namespace dsptl
 		for (int index = 0; index < inSize; index++)
 		{
 			++cntProcessedSamples;
-			// Each element is copied into the history buffer
-			history[top] = in[index];
-			tmp = std::complex<CompType>{};
-
-			state.energyValue[2] = state.energyValue[1];
-			state.energyValue[1] = state.energyValue[0];
-			state.energyValue[0] = 0;
-
-			// We iterate with a stride S on the history buffer
-			for (k = 0; (hIndex = top - k*S) >=0 ; ++k)
-			{
-				tmp += history[hIndex] * coeffs[N-1-k];
-				state.energyValue[0] += history[hIndex].real() * history[hIndex].real() + history[hIndex].imag() *  history[hIndex].imag();
-			}
-			for (k = 0; (hIndex = top + (k + 1 )*S) < historySize ; ++k)
-			{
-				tmp += history[hIndex] * coeffs[k];
-				state.energyValue[0] += history[hIndex].real() * history[hIndex].real() + history[hIndex].imag() *  history[hIndex].imag();
-			}
-
-			tmp = scale32(tmp, state.coeffScaling);  // V2 dimension
-			state.energyValue[0] = state.energyValue[0] >> (state.coeffScaling/2);  // V2 dimension
-
-			// Store the squared magnitude of the correlation values
-			state.corrValue[2] = state.corrValue[1];
-			state.corrValue[1] = state.corrValue[0];
-			state.corrValue[0] = (tmp.real() >> 2)*(tmp.real()>>2) + (tmp.imag()>>2) * (tmp.imag()>>2);
+			// Each element is copied twice into the buffer of its phase. The energy
+			// of the phase is updated with the sample it replaces
+			size_t pos = top / S;
+			std::complex<InType> *buffer = &history[2 * N * (top % S)];
+			uint32_t &phaseSum = phaseEnergy[top % S];
+			phaseSum -= dsptl_private::correlatorPower<CompType>(buffer[pos]);
+			buffer[pos] = in[index];
+			buffer[pos + N] = in[index];
+			phaseSum += dsptl_private::correlatorPower<CompType>(buffer[pos]);
+
+			// The last N samples of the phase start after the new one
+			tmp = innerProduct(buffer + pos + 1, SimdEligible());
+			bool peakFound = dsptl_private::correlatorPeak(state, tmp, phaseSum);
 
 			// DEBUG ONLY
 			#ifdef CREATE_DEBUG_FILES
@@ -258,42 +381,30 @@ namespace dsptl
 
 
 
-			// Is the middle point (index 1) a peak?
-			if (state.corrValue[1] > state.corrValue[2] && state.corrValue[1] > state.corrValue[0])
+			// Is the middle point (index 1) a peak which exceeded the threshold?
+			if (peakFound)
 			{
-				// Has the middle point (index 1) exceeded the threshold?
-				double corr = sqrt(state.corrValue[1]); // magnitude of the correlation
-				double energy = sqrt(state.energyValue[1]); // magnitude of the signal energy   
-				// Initial values before debugging were 2.5 and 200
-				if (corr > energy * 2.7 && energy > 300)
-				{
-					// Index 1 is a peak which exceeded the threshold
-					// -1 to refer to the previous sample
-					corrIndex = index - 1;
-					//  We extract the bit samples corresponding to the found correlation
-					// top represents the location of the last input sample process
-					// top - 1 modulo historySize is the location of the sample at which the peak occurred
-					// From this peak correlation sample, extract every S bit samples from the history buffer.
-					// We iterate with a stride S on the history buffer
-					size_t newTop;
-					if (top > 0) newTop = top - 1;
-					else newTop = historySize - 1;
-					for (int k = 0; (hIndex = newTop - k*S) >= 0; ++k)
-					{
-						bitSamples[N - 1 - k] = history[hIndex];
-					}
-					for (int k = 0; (hIndex = newTop + (k + 1)*S) < historySize; ++k)
-					{
-						bitSamples[k] = history[hIndex];
-					}
-					syncFound = true;
-					//#ifndef CREATE_DEBUG_FILES
-					break;
-					//#endif
-				}
+				// Index 1 is a peak which exceeded the threshold
+				// -1 to refer to the previous sample
+				corrIndex = index - 1;
+				//  We extract the bit samples corresponding to the found correlation
+				// top represents the location of the last input sample process
+				// top - 1 modulo historySize is the location of the sample at which the peak occurred
+				// The bit samples are the last N samples of its phase. With S = 1, the
+				// oldest one has already been replaced by the last input sample
+				size_t newTop;
+				if (top > 0) newTop = top - 1;
+				else newTop = historySize - 1;
+				const std::complex<InType> *window = &history[2 * N * (newTop % S) + newTop / S + 1];
+				for (size_t k = 0; k < N; ++k)
+					bitSamples[k] = window[k];
+				syncFound = true;
+				//#ifndef CREATE_DEBUG_FILES
+				break;
+				//#endif
 			}
 
-			top = (top + 1) % historySize;
+			top = (top + 1 == historySize) ? 0 : top + 1;
 			
 
 		}
@@ -302,6 +413,35 @@ namespace dsptl
 		return syncFound;
 	}
 
+	/**************************************************************************//**
+	Inner product of the coefficients with the N samples of a phase, the oldest
+	first. Vectorized version for int16_t samples and int32_t computations.
+
+	******************************************************************************/
+	template<class InType, class CompType, size_t N, size_t S >
+	std::complex<CompType> FixedPatternCorrelator<InType, CompType, N, S >::innerProduct(const std::complex<InType> *window, std::true_type)
+	{
+		if (!useSimd)
+			return innerProduct(window, std::false_type());
+		int32_t re, im;
+		dsptl_private::dotComplexByComplex16(reinterpret_cast<const int16_t *>(window), coeffsRe.data(), coeffsIm.data(), N, re, im);
+		return std::complex<CompType>(re, im);
+	}
+
+	/**************************************************************************//**
+	Inner product of the coefficients with the N samples of a phase, the oldest
+	first. Generic version.
+
+	******************************************************************************/
+	template<class InType, class CompType, size_t N, size_t S >
+	std::complex<CompType> FixedPatternCorrelator<InType, CompType, N, S >::innerProduct(const std::complex<InType> *window, std::false_type)
+	{
+		std::complex<CompType> tmp{};
+		for (size_t k = 0; k < N; ++k)
+			tmp += std::complex<CompType>(window[k]) * coeffs[k];
+		return tmp;
+	}
+
 	/**************************************************************************//**
 	Return the bitSamples corresponding to a successful correlation. The number of
 	bit samples returned is the same as the number of bits used to compute each 
@@ -316,6 +456,262 @@ namespace dsptl
 	}
 
 
+	/*-----------------------------------------------------------------------------
+	Implements a bank of fixed pattern complex correlators working on the same input
+
+	P patterns are searched at once, for example the sync words of several frame
+	types. The history and the energy of the input samples are kept once for all the
+	patterns, with the layout of FixedPatternCorrelator, and for each sample the
+	inner products of the P patterns are computed on the same window. For int16_t
+	inputs and int32_t computations, the samples are loaded once for 4 patterns by
+	the AVX2 kernel of dsptl_simd.h.\n
+
+	Each pattern has its own status and peak detection, identical to the ones of a
+	FixedPatternCorrelator with this pattern. step() stops at the first sample at
+	which a pattern detects a peak and reports the pattern of lowest index among the
+	ones which detected it at this sample. As in FixedPatternCorrelator, this sample
+	is then replaced by the first sample of the next call.
+
+	@tparam InType Data type of the input signal
+	@tparam CompType Internal computation type
+	@tparam N Number of points of each correlation pattern
+	@tparam S Stride used to scan the input vector
+	@tparam P Number of patterns
+
+	------------------------------------------------------------------------------*/
+	template<class InType = int16_t, class CompType = int32_t, size_t N = 32, size_t S = 4, size_t P = 4 >
+	class FixedPatternCorrelatorBank
+	{
+	public:
+		/// Internal status of the correlator of one pattern
+		typedef CorrelatorState CorrState;
+
+		FixedPatternCorrelatorBank();
+		bool step(const std::vector <std::complex<InType> > &in, int & corrIndex, size_t & patternIndex);
+		bool step(const std::complex<InType> *in, size_t size, int & corrIndex, size_t & patternIndex);
+		void setPattern(size_t patternIndex, const std::array<std::complex<CompType>, N > &in, double thresholdCoeff = 0.8 );
+		void reset();
+		/// Bit samples of the last detection. They do not depend on the pattern
+		std::vector<std::complex<InType>> getRefBitSamples() { return bitSamples; }
+		/// Status of the correlator of a pattern
+		CorrState getStatus(size_t patternIndex) { return state[patternIndex]; }
+
+	private:
+		/// Indicates if the vectorized inner products can be used with these types
+		typedef std::integral_constant<bool, std::is_same<InType, int16_t>::value
+			&& std::is_same<CompType, int32_t>::value> SimdEligible;
+
+		// Inner products of the P patterns with the N samples of a phase
+		void innerProducts(const std::complex<InType> *window, std::true_type);
+		void innerProducts(const std::complex<InType> *window, std::false_type);
+
+		/// Phase buffers of 2N samples. Phase p starts at p * 2N
+		std::array < std::complex<InType>, 2*N*S> history;
+		std::array < std::array < std::complex<CompType>, N >, P > coeffs;
+		/// Coefficients as the pairs of 16 bits values used by dotComplexByComplex16Sets()
+		std::array < int16_t, 2*N*P > coeffsRe;
+		std::array < int16_t, 2*N*P > coeffsIm;
+		std::array < bool, P > fits16;		///< True if the pattern fits in 16 bits
+		std::array < bool, P > isSet;		///< True if the pattern has been set
+		bool useSimd;						///< True if the vectorized inner products are used
+		std::vector < std::complex<InType> > bitSamples;
+		/// Energy of the history samples of each phase modulo S
+		std::array < uint32_t, S > phaseEnergy;
+		size_t top;
+		std::array < std::complex<CompType>, P > corr;	///< Correlation values of the current sample
+		std::array < CorrState, P > state;
+	};
+
+
+	/*-----------------------------------------------------------------------------
+	Constructor
+
+	Internal variables are initialized. All the patterns must be set by setPattern()
+	before step() is called.
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t P >
+	FixedPatternCorrelatorBank<InType, CompType, N, S, P >::FixedPatternCorrelatorBank()
+		:useSimd(false), top(0)
+	{
+		for (size_t p = 0; p < P; ++p)
+		{
+			fits16[p] = true;
+			isSet[p] = false;
+		}
+		bitSamples.assign(N, {});
+		reset();
+	}
+
+	/*-----------------------------------------------------------------------------
+	Reset all internals of the correlators
+
+	Correlator coefficients and associated energy are not modified
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t P >
+	void FixedPatternCorrelatorBank<InType, CompType, N, S, P >::reset()
+	{
+		top = 0;
+		for (size_t p = 0; p < P; ++p)
+		{
+			state[p].corrValue[0] = state[p].corrValue[1] = state[p].corrValue[2] = 0;
+			state[p].energyValue[0] = state[p].energyValue[1] = state[p].energyValue[2] = 0;
+		}
+		for (size_t k = 0; k < history.size(); ++k)
+			history[k] = {};
+		for (size_t k = 0; k < bitSamples.size(); ++k)
+			bitSamples[k] = {};
+		for (size_t k = 0; k < S; ++k)
+			phaseEnergy[k] = 0;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Copy locally one of the patterns. See FixedPatternCorrelator::setPattern()
+
+	@param[in] patternIndex Index of the pattern, less than P
+	@param[in] in Correlation pattern
+	@param[in] thresholdCoeff Threshold factor
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t P >
+	void FixedPatternCorrelatorBank<InType, CompType, N, S, P >::setPattern(size_t patternIndex, const std::array<std::complex<CompType>, N > &in, double thresholdCoeff)
+	{
+		assert(patternIndex < P);
+		dsptl_private::setCorrelatorPattern(in, coeffs[patternIndex], state[patternIndex], thresholdCoeff);
+		isSet[patternIndex] = true;
+
+		// Pairs used by the vectorized inner products. See dotComplexByComplex16()
+		int16_t *pairsRe = &coeffsRe[2 * N * patternIndex];
+		int16_t *pairsIm = &coeffsIm[2 * N * patternIndex];
+		fits16[patternIndex] = true;
+		for (size_t index = 0; index < N; ++index)
+		{
+			CompType re = coeffs[patternIndex][index].real();
+			CompType im = coeffs[patternIndex][index].imag();
+			// -im must also fit in 16 bits
+			if (re > INT16_MAX || re < INT16_MIN || im > INT16_MAX || im <= INT16_MIN)
+				fits16[patternIndex] = false;
+			pairsRe[2 * index] = static_cast<int16_t>(re);
+			pairsRe[2 * index + 1] = static_cast<int16_t>(-im);
+			pairsIm[2 * index] = static_cast<int16_t>(im);
+			pairsIm[2 * index + 1] = static_cast<int16_t>(re);
+		}
+		useSimd = SimdEligible::value;
+		for (size_t p = 0; p < P; ++p)
+			useSimd = useSimd && fits16[p];
+	}
+
+	/*-----------------------------------------------------------------------------
+	Correlate a block of samples with all the patterns
+
+	@param[in] in Samples to correlate
+	@param[out] corrIndex Index related to the input buffer at which the correlation occurred
+	@param[out] patternIndex Index of the pattern which detected the correlation
+	The values only make sense if the function returned true
+
+	@return true if correlation peak has been detected; false otherwise
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t P >
+	bool FixedPatternCorrelatorBank<InType, CompType, N, S, P >::step(const std::vector < std::complex<InType> > &in, int & corrIndex, size_t & patternIndex)
+	{
+		return step(in.data(), in.size(), corrIndex, patternIndex);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Version of step() working on a range of samples without any copy
+
+	Each sample is stored and its energy accounted once, then the P correlation
+	values are computed on the same window and pushed in the status of each pattern.
+
+	@param[in] in First sample to correlate
+	@param[in] size Number of samples to correlate
+	@param[out] corrIndex Index related to in at which the correlation occurred
+	@param[out] patternIndex Index of the pattern which detected the correlation
+
+	@return true if correlation peak has been detected; false otherwise
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t P >
+	bool FixedPatternCorrelatorBank<InType, CompType, N, S, P >::step(const std::complex<InType> *in, size_t size, int & corrIndex, size_t & patternIndex)
+	{
+		const size_t historySize = N * S;
+		for (size_t p = 0; p < P; ++p)
+			assert(isSet[p]);
+
+		for (size_t index = 0; index < size; ++index)
+		{
+			// Each element is copied twice into the buffer of its phase
+			size_t pos = top / S;
+			std::complex<InType> *buffer = &history[2 * N * (top % S)];
+			uint32_t &phaseSum = phaseEnergy[top % S];
+			phaseSum -= dsptl_private::correlatorPower<CompType>(buffer[pos]);
+			buffer[pos] = in[index];
+			buffer[pos + N] = in[index];
+			phaseSum += dsptl_private::correlatorPower<CompType>(buffer[pos]);
+
+			innerProducts(buffer + pos + 1, SimdEligible());
+			bool syncFound = false;
+			for (size_t p = 0; p < P; ++p)
+			{
+				if (dsptl_private::correlatorPeak(state[p], corr[p], phaseSum) && !syncFound)
+				{
+					syncFound = true;
+					patternIndex = p;
+				}
+			}
+
+			if (syncFound)
+			{
+				// -1 to refer to the previous sample
+				corrIndex = static_cast<int>(index) - 1;
+				// The bit samples are the last N samples of the phase of the peak.
+				// See FixedPatternCorrelator::step()
+				size_t newTop = (top > 0) ? top - 1 : historySize - 1;
+				const std::complex<InType> *window = &history[2 * N * (newTop % S) + newTop / S + 1];
+				for (size_t k = 0; k < N; ++k)
+					bitSamples[k] = window[k];
+				return true;
+			}
+
+			top = (top + 1 == historySize) ? 0 : top + 1;
+		}
+		return false;
+	}
+
+	/**************************************************************************//**
+	Inner products of the P patterns with the N samples of a phase, the oldest
+	first. Vectorized version for int16_t samples and int32_t computations.
+
+	******************************************************************************/
+	template<class InType, class CompType, size_t N, size_t S, size_t P >
+	void FixedPatternCorrelatorBank<InType, CompType, N, S, P >::innerProducts(const std::complex<InType> *window, std::true_type)
+	{
+		if (!useSimd)
+		{
+			innerProducts(window, std::false_type());
+			return;
+		}
+		int32_t re[P], im[P];
+		dsptl_private::dotComplexByComplex16Sets(reinterpret_cast<const int16_t *>(window), coeffsRe.data(), coeffsIm.data(), N, P, re, im);
+		for (size_t p = 0; p < P; ++p)
+			corr[p] = std::complex<CompType>(re[p], im[p]);
+	}
+
+	/**************************************************************************//**
+	Inner products of the P patterns with the N samples of a phase, the oldest
+	first. Generic version.
+
+	******************************************************************************/
+	template<class InType, class CompType, size_t N, size_t S, size_t P >
+	void FixedPatternCorrelatorBank<InType, CompType, N, S, P >::innerProducts(const std::complex<InType> *window, std::false_type)
+	{
+		for (size_t p = 0; p < P; ++p)
+		{
+			std::complex<CompType> tmp{};
+			for (size_t k = 0; k < N; ++k)
+				tmp += std::complex<CompType>(window[k]) * coeffs[p][k];
+			corr[p] = tmp;
+		}
+	}
+
+
 } // End of namespace 
 
 
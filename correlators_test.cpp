@@ -0,0 +1,478 @@
+#include "correlators.h"
+#include "dsptl_fft_correlator.h"
+#include "dsptl_doppler_correlator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <complex>
+#include <array>
+#include <vector>
+#include <iostream>
+
+/*-----------------------------------------------------------------------------
+Reference correlator: the original implementation of FixedPatternCorrelator,
+which recomputes the inner product and the energy with a stride S on a single
+history buffer, extended to P patterns searched on the same input. Each pattern
+has its own status and the pattern of lowest index wins when several detect a
+peak on the same sample.
+------------------------------------------------------------------------------*/
+template<class InType, class CompType, size_t N, size_t S, size_t P = 1>
+class BaselineCorrelator
+{
+public:
+	BaselineCorrelator() : top(0)
+	{
+		bitSamples.assign(N, {});
+		for (size_t k = 0; k < history.size(); ++k)
+			history[k] = {};
+		for (size_t p = 0; p < P; ++p)
+		{
+			state[p].corrValue[0] = state[p].corrValue[1] = state[p].corrValue[2] = 0;
+			state[p].energyValue[0] = state[p].energyValue[1] = state[p].energyValue[2] = 0;
+		}
+	}
+
+	void setPattern(size_t p, const std::array<std::complex<CompType>, N > &in, double thresholdCoeff = 0.8)
+	{
+		dsptl_private::setCorrelatorPattern(in, coeffs[p], state[p], thresholdCoeff);
+	}
+
+	bool step(const std::complex<InType> *in, size_t size, int &corrIndex, size_t &patternIndex)
+	{
+		int historySize = static_cast<int>(history.size());
+		int hIndex;
+		for (size_t index = 0; index < size; index++)
+		{
+			history[top] = in[index];
+			bool syncFound = false;
+			for (size_t p = 0; p < P; ++p)
+			{
+				dsptl::CorrelatorState &st = state[p];
+				std::complex<CompType> tmp{};
+				st.energyValue[2] = st.energyValue[1];
+				st.energyValue[1] = st.energyValue[0];
+				st.energyValue[0] = 0;
+				for (int k = 0; (hIndex = static_cast<int>(top) - k * static_cast<int>(S)) >= 0; ++k)
+				{
+					tmp += history[hIndex] * coeffs[p][N - 1 - k];
+					st.energyValue[0] += history[hIndex].real() * history[hIndex].real() + history[hIndex].imag() * history[hIndex].imag();
+				}
+				for (int k = 0; (hIndex = static_cast<int>(top) + (k + 1) * static_cast<int>(S)) < historySize; ++k)
+				{
+					tmp += history[hIndex] * coeffs[p][k];
+					st.energyValue[0] += history[hIndex].real() * history[hIndex].real() + history[hIndex].imag() * history[hIndex].imag();
+				}
+				tmp = scale32(tmp, st.coeffScaling);
+				st.energyValue[0] = st.energyValue[0] >> (st.coeffScaling / 2);
+				st.corrValue[2] = st.corrValue[1];
+				st.corrValue[1] = st.corrValue[0];
+				st.corrValue[0] = (tmp.real() >> 2) * (tmp.real() >> 2) + (tmp.imag() >> 2) * (tmp.imag() >> 2);
+
+				if (st.corrValue[1] > st.corrValue[2] && st.corrValue[1] > st.corrValue[0] && !syncFound)
+				{
+					double corr = sqrt(st.corrValue[1]);
+					double energy = sqrt(st.energyValue[1]);
+					if (corr > energy * 2.7 && energy > 300)
+					{
+						syncFound = true;
+						patternIndex = p;
+					}
+				}
+			}
+
+			if (syncFound)
+			{
+				corrIndex = static_cast<int>(index) - 1;
+				int newTop = (top > 0) ? static_cast<int>(top) - 1 : historySize - 1;
+				for (int k = 0; (hIndex = newTop - k * static_cast<int>(S)) >= 0; ++k)
+					bitSamples[N - 1 - k] = std::complex<InType>(history[hIndex].real(), history[hIndex].imag());
+				for (int k = 0; (hIndex = newTop + (k + 1) * static_cast<int>(S)) < historySize; ++k)
+					bitSamples[k] = std::complex<InType>(history[hIndex].real(), history[hIndex].imag());
+				return true;
+			}
+			top = (top + 1) % historySize;
+		}
+		return false;
+	}
+
+	std::vector<std::complex<InType> > getRefBitSamples() { return bitSamples; }
+	dsptl::CorrelatorState getStatus(size_t p) { return state[p]; }
+
+private:
+	std::array < std::complex<CompType>, N*S> history;
+	std::array < std::array < std::complex<CompType>, N >, P > coeffs;
+	std::vector < std::complex<InType> > bitSamples;
+	size_t top;
+	std::array < dsptl::CorrelatorState, P > state;
+};
+
+/// Comparison of the fields of the status of two correlators
+bool sameStatus(const dsptl::CorrelatorState &a, const dsptl::CorrelatorState &b)
+{
+	bool same = a.coeffsEnergy == b.coeffsEnergy && a.coeffScaling == b.coeffScaling && a.thresholdFactor == b.thresholdFactor;
+	for (int k = 0; k < dsptl::CorrelatorState::Nelements; ++k)
+		same = same && a.energyValue[k] == b.energyValue[k] && a.corrValue[k] == b.corrValue[k];
+	return same;
+}
+
+/*-----------------------------------------------------------------------------
+Random pattern of QPSK points fitting in 13 bits. The long patterns are smaller
+so that their energy fits in 30 bits
+------------------------------------------------------------------------------*/
+template<class CompType, size_t N>
+std::array<std::complex<CompType>, N> randomPattern()
+{
+	const CompType amplitude = (N <= 64) ? 2000 : 1000;
+	std::array<std::complex<CompType>, N> pattern;
+	for (size_t n = 0; n < N; ++n)
+		pattern[n] = std::complex<CompType>((rand() & 1) ? amplitude : -amplitude, (rand() & 1) ? amplitude : -amplitude);
+	return pattern;
+}
+
+/*-----------------------------------------------------------------------------
+Noise with bursts of the patterns, taken every S samples, and segments of
+strong samples of up to 14 bits, whose correlation cannot overflow 32 bits
+------------------------------------------------------------------------------*/
+template<class InType, class CompType, size_t N, size_t S, size_t P>
+std::vector<std::complex<InType> > testSignal(const std::array<std::array<std::complex<CompType>, N>, P> &patterns, size_t numBursts)
+{
+	std::vector<std::complex<InType> > signal;
+	for (size_t b = 0; b < numBursts; ++b)
+	{
+		size_t gap = 50 + rand() % (2 * N * S);
+		bool strong = (rand() % 4 == 0);
+		for (size_t j = 0; j < gap; ++j)
+		{
+			int amplitude = strong ? std::min<int>(8191, (1 << 30) / (N * 2000)) : 200;
+			signal.push_back(std::complex<InType>(rand() % (2 * amplitude + 1) - amplitude, rand() % (2 * amplitude + 1) - amplitude));
+		}
+		const std::array<std::complex<CompType>, N> &pattern = patterns[b % P];
+		for (size_t n = 0; n < N; ++n)
+			for (size_t s = 0; s < S; ++s)
+			{
+				std::complex<InType> noise(rand() % 401 - 200, rand() % 401 - 200);
+				signal.push_back(s == 0 ? std::complex<InType>(pattern[n].real() + noise.real(), pattern[n].imag() + noise.imag()) : noise);
+			}
+	}
+	return signal;
+}
+
+/*-----------------------------------------------------------------------------
+Feed the same blocks of random sizes to a correlator and to the reference and
+compare the detections, the status and the bit samples after each call. After a
+detection, the following call starts after the sample which revealed the peak.
+------------------------------------------------------------------------------*/
+template<class Correlator, class InType, class CompType, size_t N, size_t S>
+bool compareWithBaseline(const char *name, Correlator &correlator)
+{
+	std::array<std::array<std::complex<CompType>, N>, 1> patterns = { { randomPattern<CompType, N>() } };
+	BaselineCorrelator<InType, CompType, N, S> reference;
+	reference.setPattern(0, patterns[0]);
+	correlator.setPattern(patterns[0]);
+	std::vector<std::complex<InType> > signal = testSignal<InType, CompType, N, S, 1>(patterns, 20);
+
+	bool passed = true;
+	size_t numDetections = 0;
+	size_t offset = 0;
+	while (offset < signal.size() && passed)
+	{
+		size_t size = std::min<size_t>(rand() % 700, signal.size() - offset);
+		int index = -10, expectedIndex = -10;
+		size_t patternIndex = 0;
+		bool found = correlator.step(signal.data() + offset, size, index);
+		bool expected = reference.step(signal.data() + offset, size, expectedIndex, patternIndex);
+		passed = found == expected && sameStatus(correlator.getStatus(), reference.getStatus(0));
+		if (expected)
+		{
+			passed = passed && index == expectedIndex && correlator.getRefBitSamples() == reference.getRefBitSamples();
+			offset += expectedIndex + 2;
+			++numDetections;
+		}
+		else
+			offset += size;
+	}
+	passed = passed && numDetections > 0;
+	std::cout << "+++++ " << name << ": " << numDetections << " detections: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+Same comparison for a bank of P patterns, with bursts of each pattern in turn.
+The pattern reported and the status of every pattern must be the ones of the
+reference. The last pattern repeats the first one, so that both detect the same
+peaks and the first must be reported.
+------------------------------------------------------------------------------*/
+template<class Bank, class InType, class CompType, size_t N, size_t S, size_t P>
+bool compareBankWithBaseline(const char *name, Bank &bank)
+{
+	std::array<std::array<std::complex<CompType>, N>, P> patterns;
+	BaselineCorrelator<InType, CompType, N, S, P> reference;
+	for (size_t p = 0; p < P; ++p)
+	{
+		patterns[p] = (p == P - 1) ? patterns[0] : randomPattern<CompType, N>();
+		reference.setPattern(p, patterns[p]);
+		bank.setPattern(p, patterns[p]);
+	}
+	std::vector<std::complex<InType> > signal = testSignal<InType, CompType, N, S, P>(patterns, 8 * P);
+
+	bool passed = true;
+	size_t numDetections = 0;
+	std::array<size_t, P> detectionsPerPattern{};
+	size_t offset = 0;
+	while (offset < signal.size() && passed)
+	{
+		size_t size = std::min<size_t>(rand() % 700, signal.size() - offset);
+		int index = -10, expectedIndex = -10;
+		size_t patternIndex = P, expectedPatternIndex = P;
+		bool found = bank.step(signal.data() + offset, size, index, patternIndex);
+		bool expected = reference.step(signal.data() + offset, size, expectedIndex, expectedPatternIndex);
+		passed = found == expected;
+		for (size_t p = 0; p < P; ++p)
+			passed = passed && sameStatus(bank.getStatus(p), reference.getStatus(p));
+		if (expected)
+		{
+			passed = passed && index == expectedIndex && patternIndex == expectedPatternIndex
+				&& bank.getRefBitSamples() == reference.getRefBitSamples();
+			offset += expectedIndex + 2;
+			++numDetections;
+			++detectionsPerPattern[expectedPatternIndex];
+		}
+		else
+			offset += size;
+	}
+	for (size_t p = 0; p < P - 1; ++p)
+		passed = passed && detectionsPerPattern[p] > 0;
+	std::cout << "+++++ " << name << ": " << numDetections << " detections: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+Noise with bursts of a pattern, taken every S samples, each received with a
+random frequency offset up to maxDoppler cycles per sample and a random phase
+------------------------------------------------------------------------------*/
+template<class InType, class CompType, size_t N, size_t S>
+std::vector<std::complex<InType> > dopplerSignal(const std::array<std::complex<CompType>, N> &pattern, size_t numBursts, double maxDoppler)
+{
+	std::vector<std::complex<InType> > signal;
+	for (size_t b = 0; b < numBursts; ++b)
+	{
+		size_t gap = 50 + rand() % (2 * N * S);
+		for (size_t j = 0; j < gap; ++j)
+			signal.push_back(std::complex<InType>(rand() % 401 - 200, rand() % 401 - 200));
+		double frequency = maxDoppler * (2.0 * rand() / RAND_MAX - 1);
+		double phase = 2 * dsptl::pi * rand() / RAND_MAX;
+		for (size_t n = 0; n < N * S; ++n)
+		{
+			std::complex<double> x(rand() % 401 - 200, rand() % 401 - 200);
+			if (n % S == 0)
+				x += std::complex<double>(pattern[n / S].real(), pattern[n / S].imag()) * std::polar(1.0, phase + 2 * dsptl::pi * frequency * n);
+			signal.push_back(std::complex<InType>(static_cast<InType>(lround(x.real())), static_cast<InType>(lround(x.imag()))));
+		}
+	}
+	return signal;
+}
+
+/*-----------------------------------------------------------------------------
+Brute force search of DopplerCorrelator in floating point. For each sample from
+start, the window is made of the last N samples of its phase and the correlation
+of bin f is the sum over n of x[n] conj(p[n]) exp(j 2 pi v_f c(n)), where c(n) is
+the distance to the last sample of the centre of the segment of n. The metric is
+|C|^2 / (pattern energy * window energy). The lag is relative to start.
+------------------------------------------------------------------------------*/
+template<class InType, class CompType, size_t N, size_t S, size_t K>
+dsptl::DopplerPeak referenceDopplerSearch(const std::vector<std::complex<InType> > &signal, size_t start, size_t size,
+	const std::array<std::complex<CompType>, N> &pattern, const std::vector<double> &binFrequency)
+{
+	const size_t segmentLength = N / K;
+	double patternEnergy = 0;
+	for (size_t n = 0; n < N; ++n)
+		patternEnergy += std::norm(std::complex<double>(pattern[n].real(), pattern[n].imag()));
+
+	dsptl::DopplerPeak peak = { -1, 0, 0, -1 };
+	for (size_t m = start; m < start + size; ++m)
+	{
+		std::array<std::complex<double>, N> product;
+		double energy = 0;
+		for (size_t n = 0; n < N; ++n)
+		{
+			size_t distance = (N - 1 - n) * S;
+			std::complex<double> x = (m >= distance) ? std::complex<double>(signal[m - distance].real(), signal[m - distance].imag()) : 0;
+			energy += std::norm(x);
+			product[n] = x * std::conj(std::complex<double>(pattern[n].real(), pattern[n].imag()));
+		}
+		if (energy == 0)
+			continue;
+		for (size_t f = 0; f < binFrequency.size(); ++f)
+		{
+			std::complex<double> corr;
+			for (size_t n = 0; n < N; ++n)
+			{
+				size_t k = n / segmentLength;
+				double centre = (N - 1 - (k * segmentLength + (segmentLength - 1) / 2.0)) * S;
+				corr += product[n] * std::polar(1.0, 2 * dsptl::pi * binFrequency[f] * centre);
+			}
+			double metric = std::norm(corr) / (patternEnergy * energy);
+			if (metric > peak.metric)
+			{
+				peak.lag = static_cast<int>(m - start);
+				peak.bin = f;
+				peak.metric = metric;
+			}
+		}
+	}
+	return peak;
+}
+
+/*-----------------------------------------------------------------------------
+DopplerCorrelator must give the lag, the bin and the metric of the brute force
+search over blocks of random sizes, Doppler shifted bursts straddling the blocks
+------------------------------------------------------------------------------*/
+template<class InType, class CompType, size_t N, size_t S, size_t K>
+bool compareDopplerWithReference(const char *name, size_t numBins, double maxDoppler)
+{
+	const double threshold = 0.5;
+	std::array<std::complex<CompType>, N> pattern = randomPattern<CompType, N>();
+	dsptl::DopplerCorrelator<InType, CompType, N, S, K> correlator(numBins, maxDoppler, threshold);
+	correlator.setPattern(pattern);
+	std::vector<double> binFrequency(numBins);
+	for (size_t f = 0; f < numBins; ++f)
+		binFrequency[f] = correlator.getBinFrequency(f);
+	std::vector<std::complex<InType> > signal = dopplerSignal<InType, CompType, N, S>(pattern, 20, maxDoppler);
+
+	bool passed = true;
+	size_t numDetections = 0;
+	size_t offset = 0;
+	while (offset < signal.size() && passed)
+	{
+		size_t size = std::min<size_t>(1 + rand() % 700, signal.size() - offset);
+		dsptl::DopplerPeak peak;
+		bool found = correlator.search(signal.data() + offset, size, peak);
+		dsptl::DopplerPeak expected = referenceDopplerSearch<InType, CompType, N, S, K>(signal, offset, size, pattern, binFrequency);
+		passed = found == (expected.metric >= threshold);
+		if (found)
+		{
+			passed = passed && peak.lag == expected.lag && peak.bin == expected.bin && fabs(peak.metric - expected.metric) < 1e-9;
+			++numDetections;
+		}
+		offset += size;
+	}
+	passed = passed && numDetections > 0;
+	std::cout << "+++++ " << name << ": " << numDetections << " detections: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+On a burst without frequency offset, the best lag of DopplerCorrelator must be the
+peak found by the original correlator, in the bin of zero frequency. With an offset
+between two bins, the interpolated frequency must be closer to the offset than a
+fifth of the spacing of the bins.
+------------------------------------------------------------------------------*/
+template<class InType, class CompType, size_t N, size_t S, size_t K>
+bool testDopplerEstimates(const char *name)
+{
+	const size_t numBins = 9;
+	const double maxDoppler = 2.0 / (N * S);
+	const double spacing = 2 * maxDoppler / (numBins - 1);
+	std::array<std::complex<CompType>, N> pattern = randomPattern<CompType, N>();
+
+	bool passed = true;
+	{
+		std::vector<std::complex<InType> > signal = dopplerSignal<InType, CompType, N, S>(pattern, 1, 0);
+		signal.resize(signal.size() + 10);
+		dsptl::DopplerCorrelator<InType, CompType, N, S, K> correlator(numBins, maxDoppler);
+		correlator.setPattern(pattern);
+		BaselineCorrelator<InType, CompType, N, S> reference;
+		reference.setPattern(0, pattern);
+		dsptl::DopplerPeak peak;
+		int expectedIndex = -10;
+		size_t patternIndex = 0;
+		bool found = correlator.search(signal, peak);
+		bool expected = reference.step(signal.data(), signal.size(), expectedIndex, patternIndex);
+		passed = found && expected && peak.lag == expectedIndex && peak.bin == numBins / 2 && fabs(peak.frequency) < spacing / 5;
+	}
+
+	double maxError = 0;
+	for (int t = 0; t < 8 && passed; ++t)
+	{
+		double offset = (t - 3.5) * spacing * 0.45;
+		dsptl::DopplerCorrelator<InType, CompType, N, S, K> correlator(numBins, maxDoppler);
+		correlator.setPattern(pattern);
+		std::vector<std::complex<InType> > signal = dopplerSignal<InType, CompType, N, S>(pattern, 1, 0);
+		size_t start = signal.size() - N * S;
+		for (size_t n = start; n < signal.size(); ++n)
+		{
+			std::complex<double> x = std::complex<double>(signal[n].real(), signal[n].imag()) * std::polar(1.0, 2 * dsptl::pi * offset * (n - start));
+			signal[n] = std::complex<InType>(static_cast<InType>(lround(x.real())), static_cast<InType>(lround(x.imag())));
+		}
+		dsptl::DopplerPeak peak;
+		passed = correlator.search(signal, peak) && peak.lag == static_cast<int>(signal.size() - S);
+		maxError = std::max(maxError, fabs(peak.frequency - offset));
+	}
+	passed = passed && maxError < spacing / 5;
+	std::cout << "+++++ " << name << ": frequency error " << maxError / spacing << " bin: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+int main()
+{
+	using namespace dsptl;
+	srand(1);
+
+	bool passed = true;
+	{
+		FixedPatternCorrelator<int16_t, int32_t, 32, 4> correlator;
+		passed = compareWithBaseline<FixedPatternCorrelator<int16_t, int32_t, 32, 4>, int16_t, int32_t, 32, 4>(
+			"FixedPatternCorrelator N 32 S 4", correlator) && passed;
+	}
+	{
+		FixedPatternCorrelator<int16_t, int32_t, 64, 1> correlator;
+		passed = compareWithBaseline<FixedPatternCorrelator<int16_t, int32_t, 64, 1>, int16_t, int32_t, 64, 1>(
+			"FixedPatternCorrelator N 64 S 1", correlator) && passed;
+	}
+	{
+		FixedPatternCorrelator<int32_t, int32_t, 20, 3> correlator;
+		passed = compareWithBaseline<FixedPatternCorrelator<int32_t, int32_t, 20, 3>, int32_t, int32_t, 20, 3>(
+			"FixedPatternCorrelator N 20 S 3, generic", correlator) && passed;
+	}
+
+	{
+		FftPatternCorrelator<int16_t, int32_t, 256, 4> correlator;
+		passed = compareWithBaseline<FftPatternCorrelator<int16_t, int32_t, 256, 4>, int16_t, int32_t, 256, 4>(
+			"FftPatternCorrelator N 256 S 4", correlator) && passed;
+	}
+	{
+		FftPatternCorrelator<int16_t, int32_t, 32, 1> correlator;
+		passed = compareWithBaseline<FftPatternCorrelator<int16_t, int32_t, 32, 1>, int16_t, int32_t, 32, 1>(
+			"FftPatternCorrelator N 32 S 1", correlator) && passed;
+	}
+
+	{
+		FixedPatternCorrelatorBank<int16_t, int32_t, 32, 4, 3> bank;
+		passed = compareBankWithBaseline<FixedPatternCorrelatorBank<int16_t, int32_t, 32, 4, 3>, int16_t, int32_t, 32, 4, 3>(
+			"FixedPatternCorrelatorBank N 32 S 4 P 3", bank) && passed;
+	}
+	{
+		FixedPatternCorrelatorBank<int16_t, int32_t, 64, 1, 4> bank;
+		passed = compareBankWithBaseline<FixedPatternCorrelatorBank<int16_t, int32_t, 64, 1, 4>, int16_t, int32_t, 64, 1, 4>(
+			"FixedPatternCorrelatorBank N 64 S 1 P 4", bank) && passed;
+	}
+	{
+		FixedPatternCorrelatorBank<int16_t, int32_t, 32, 2, 5> bank;
+		passed = compareBankWithBaseline<FixedPatternCorrelatorBank<int16_t, int32_t, 32, 2, 5>, int16_t, int32_t, 32, 2, 5>(
+			"FixedPatternCorrelatorBank N 32 S 2 P 5", bank) && passed;
+	}
+	{
+		FixedPatternCorrelatorBank<int32_t, int32_t, 20, 3, 3> bank;
+		passed = compareBankWithBaseline<FixedPatternCorrelatorBank<int32_t, int32_t, 20, 3, 3>, int32_t, int32_t, 20, 3, 3>(
+			"FixedPatternCorrelatorBank N 20 S 3 P 3, generic", bank) && passed;
+	}
+
+	passed = compareDopplerWithReference<int16_t, int32_t, 32, 4, 4>("DopplerCorrelator N 32 S 4 K 4", 9, 1.0 / 128) && passed;
+	passed = compareDopplerWithReference<int16_t, int32_t, 64, 1, 8>("DopplerCorrelator N 64 S 1 K 8", 7, 1.0 / 64) && passed;
+	passed = compareDopplerWithReference<int32_t, int32_t, 20, 3, 5>("DopplerCorrelator N 20 S 3 K 5, generic", 5, 1.0 / 60) && passed;
+	passed = testDopplerEstimates<int16_t, int32_t, 32, 4, 4>("DopplerCorrelator N 32 S 4 K 4 estimates") && passed;
+	passed = testDopplerEstimates<int16_t, int32_t, 64, 2, 8>("DopplerCorrelator N 64 S 2 K 8 estimates") && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
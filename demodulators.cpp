@@ -147,10 +147,24 @@ namespace dsptl
 
 	------------------------------------------------------------------------------*/
 
-	std::vector<int8_t> DemodulatorOqpsk<int16_t>::step(std::vector<std::complex<int16_t>> in, int32_t & error)
+	std::vector<int8_t> DemodulatorOqpsk<int16_t>::step(const std::vector<std::complex<int16_t>> &in, int32_t & error)
+	{
+		return step(in.data(), in.size(), error);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Version of step() working on a range of samples without any copy, for example
+	part of a larger capture buffer
+
+	@param in First bit sample of the waveform to demodulate
+	@param numIn Number of bit samples
+	@param error Sum of the magnitude of the phase error
+
+	------------------------------------------------------------------------------*/
+
+	std::vector<int8_t> DemodulatorOqpsk<int16_t>::step(const std::complex<int16_t> *in, size_t numIn, int32_t & error)
 	{
 		std::vector<int8_t> softBits;
-		size_t numIn = in.size();
 
 		// Initialize local variables
 		auto bitCnt = stateVar.bitCnt;
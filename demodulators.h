@@ -55,7 +55,8 @@ namespace dsptl
 	{
 	public:
 		DemodulatorOqpsk();
-		std::vector<int8_t> step(std::vector<std::complex<int16_t>> in, int32_t & error);
+		std::vector<int8_t> step(const std::vector<std::complex<int16_t>> &in, int32_t & error);
+		std::vector<int8_t> step(const std::complex<int16_t> *in, size_t numIn, int32_t & error);
 		void reset();
 		void setSyncPattern(std::vector<int8_t> bits){ bitSyncPattern = bits; };
 		/// Initial frequency of the loop. The input parameter is  in rad/samples with a sampling
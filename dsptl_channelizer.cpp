@@ -0,0 +1,192 @@
+/***********************************************************************//**
+@file
+
+Polyphase filterbank channelizer.
+
+***************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include "dsptl_channelizer.h"
+#include "dsp_complex.h"
+
+namespace dsptl
+{
+
+	/**************************************************************************//**
+	Constructor
+
+	@param numChannels Number of channels C. Must be a power of 2
+	@param prototype Coefficients of the prototype lowpass filter. The number of
+	coefficients must be a multiple of C. The cutoff frequency is normally Fs / (2 C)
+	******************************************************************************/
+	PolyphaseChannelizer::PolyphaseChannelizer(size_t numChannels, const std::vector<int32_t> &prototype)
+		: fft(numChannels), numChannels(numChannels), top(0), phase(0), coeffScaling(0), leftShift(0), branch(numChannels)
+	{
+		setPrototype(prototype);
+	}
+
+	/**************************************************************************//**
+	Constructor with a prototype shared with other instances
+
+	@param numChannels Number of channels C. Must be a power of 2
+	@param prototype Coefficients of the prototype lowpass filter. Must not be null.
+	See PolyphaseChannelizer(size_t, const std::vector<int32_t> &)
+	******************************************************************************/
+	PolyphaseChannelizer::PolyphaseChannelizer(size_t numChannels, const std::shared_ptr<const std::vector<int32_t> > &prototype)
+		: fft(numChannels), numChannels(numChannels), top(0), phase(0), coeffScaling(0), leftShift(0), branch(numChannels)
+	{
+		setPrototype(prototype);
+	}
+
+	/**************************************************************************//**
+	Replace the prototype filter. The history is cleared.
+
+	@param prototype Coefficients of the prototype lowpass filter. The number of
+	coefficients must be a multiple of C.
+	******************************************************************************/
+	void PolyphaseChannelizer::setPrototype(const std::vector<int32_t> &prototype)
+	{
+		setPrototype(std::shared_ptr<const std::vector<int32_t> >(new std::vector<int32_t>(prototype)));
+	}
+
+	/**************************************************************************//**
+	Replace the prototype filter without copying it. The instances using the same
+	table share it. The table must not be modified afterwards. The history is
+	cleared.
+
+	@param prototype Coefficients of the prototype lowpass filter. Must not be null.
+	The number of coefficients must be a multiple of C.
+	******************************************************************************/
+	void PolyphaseChannelizer::setPrototype(const std::shared_ptr<const std::vector<int32_t> > &prototype)
+	{
+		assert(prototype && !prototype->empty());
+		assert(prototype->size() % numChannels == 0);
+		coeff = prototype;
+		history.resize(2 * coeff->size());
+		// bit growth due to coefficient and number of taps
+		double sumMagnitude = 0;
+		for (size_t index = 0; index < coeff->size(); ++index)
+			sumMagnitude += std::abs(static_cast<double>((*coeff)[index]));
+		coeffScaling = static_cast<unsigned>(floor(log2(sumMagnitude)));
+		leftShift = 0;
+		reset();
+	}
+
+	/**************************************************************************//**
+	Reset the history and the decimation phase. The phase of the channels restarts
+	from 0 at the next sample.
+
+	******************************************************************************/
+	void PolyphaseChannelizer::reset()
+	{
+		top = 0;
+		phase = 0;
+		for (size_t index = 0; index < history.size(); ++index)
+			history[index] = std::complex<int16_t>();
+	}
+
+	/**************************************************************************//**
+	Channelize a number of samples multiple of C
+
+	@param input First input sample
+	@param inputSize Number of input samples. Must be a multiple of C
+	@param output Room for inputSize samples, channel interleaved
+	******************************************************************************/
+	void PolyphaseChannelizer::step(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output)
+	{
+		assert(inputSize % numChannels == 0);
+		size_t numOut = stepStream(input, inputSize, output);
+		// Only true if the previous calls were made with multiples of C samples
+		assert(numOut * numChannels == inputSize);
+		(void)numOut;
+	}
+
+	/**************************************************************************//**
+	Channelize a number of samples multiple of C. The output is provided as one
+	vector per channel.
+
+	@param input Input samples. The size must be a multiple of C
+	@param channels Resized to C vectors of input.size() / C samples
+	******************************************************************************/
+	void PolyphaseChannelizer::step(const std::vector<std::complex<int16_t> > &input, std::vector<std::vector<std::complex<int16_t> > > &channels)
+	{
+		assert(input.size() % numChannels == 0);
+		size_t numOut = input.size() / numChannels;
+		std::vector<std::complex<int16_t> > interleaved(input.size());
+		step(input.data(), input.size(), interleaved.data());
+
+		channels.resize(numChannels);
+		for (size_t k = 0; k < numChannels; ++k)
+		{
+			channels[k].resize(numOut);
+			for (size_t m = 0; m < numOut; ++m)
+				channels[k][m] = interleaved[m * numChannels + k];
+		}
+	}
+
+	/**************************************************************************//**
+	Channelize a block of any size
+
+	Each input sample is written twice in the history buffer, as in
+	FilterDnsamplingFir::stepStream(), so that the last N samples are contiguous
+	from top, the most recent first. An output of all the channels is computed for
+	each input sample whose position in the stream is a multiple of C.\n
+
+	With w[n] the history and h[n] the prototype, the output of channel k is
+	sum h[n] w[n] exp(j 2 pi k n / C). Splitting n into p C + r, the C polyphase
+	branches v[r] = sum over p of h[p C + r] w[p C + r] are computed in 32 bits,
+	then the inverse FFT of v gives all the channels at once.
+
+	@param input First input sample
+	@param inputSize Number of input samples. Can be any value including 0
+	@param output Room for getMaxOutputSize(inputSize) * C samples, channel
+	interleaved. Must not overlap the input
+
+	@return Number of samples written to each channel
+	******************************************************************************/
+	size_t PolyphaseChannelizer::stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output)
+	{
+		size_t N = coeff->size();
+		size_t numOut = 0;
+		const int32_t *c = coeff->data();
+
+		for (size_t j = 0; j < inputSize; ++j)
+		{
+			history[top] = input[j];
+			history[top + N] = input[j];
+			const std::complex<int16_t> *window = &history[top];
+			bool compute = (phase == 0);
+
+			top = (top == 0) ? N - 1 : top - 1;
+			phase = (phase + 1 == numChannels) ? 0 : phase + 1;
+			if (!compute)
+				continue;
+
+			for (size_t r = 0; r < numChannels; ++r)
+			{
+				int32_t re = 0;
+				int32_t im = 0;
+				for (size_t n = r; n < N; n += numChannels)
+				{
+					re += c[n] * window[n].real();
+					im += c[n] * window[n].imag();
+				}
+				branch[r] = std::complex<double>(re, im);
+			}
+			fft.inverse(branch.data());
+
+			// Same scaling as FilterDnsamplingFir. The exact result of the FFT is
+			// not an integer: it is rounded before the scaling
+			std::complex<int16_t> *frame = output + numOut * numChannels;
+			for (size_t k = 0; k < numChannels; ++k)
+			{
+				std::complex<int64_t> y(llround(branch[k].real()), llround(branch[k].imag()));
+				frame[k] = limitScale<std::complex<int16_t> >(y, coeffScaling - leftShift);
+			}
+			++numOut;
+		}
+		return numOut;
+	}
+
+} // End of namespace
@@ -0,0 +1,84 @@
+/***********************************************************************//**
+@file
+
+Polyphase filterbank channelizer.\n
+
+The channelizer splits a wideband stream into C equally spaced channels with a
+single prototype lowpass filter and one inverse FFT of C points per output
+sample. It gives the same result as C chains of a mixer followed by a decimating
+filter, for a cost per channel of P + log2(C) multiplications instead of the
+P * C multiplications of each chain, where P * C is the length of the prototype.
+
+***************************************************************************/
+
+#ifndef DSPTL_CHANNELIZER_H
+#define DSPTL_CHANNELIZER_H
+
+#include <cstdint>
+#include <complex>
+#include <vector>
+#include <memory>
+#include "dsptl_fft.h"
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Critically sampled polyphase FFT channelizer for complex 16 bits samples
+
+	Channel k is centred on the frequency k * Fs / C, where Fs is the input rate,
+	and the channels k >= C / 2 hold the negative frequencies (k - C) * Fs / C. Each
+	channel is sampled at Fs / C.\n
+
+	The output of channel k is the output of FilterDnsamplingFir<..., C> applied to
+	the input multiplied by exp(-j 2 pi k t / C), where t is the position of the
+	sample in the stream since the last reset, with the prototype as coefficients.
+	The gain is about 0 dB with the same scaling as FilterDnsamplingFir.\n
+
+	The output is channel interleaved: sample m of channel k is located at
+	m * C + k.\n
+
+	The prototype can be shared with other channelizers and filters, for example
+	when it is obtained from the cache of dsptl_filter_design.h.
+
+	***************************************************************************/
+	class PolyphaseChannelizer
+	{
+	public:
+		PolyphaseChannelizer(size_t numChannels, const std::vector<int32_t> &prototype);
+		PolyphaseChannelizer(size_t numChannels, const std::shared_ptr<const std::vector<int32_t> > &prototype);
+		// Replace the prototype filter
+		void setPrototype(const std::vector<int32_t> &prototype);
+		// Version of setPrototype() sharing the prototype with other instances
+		void setPrototype(const std::shared_ptr<const std::vector<int32_t> > &prototype);
+		// Channelize a number of samples multiple of C
+		void step(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output);
+		// Channelize a number of samples multiple of C. One output vector per channel
+		void step(const std::vector<std::complex<int16_t> > &input, std::vector<std::vector<std::complex<int16_t> > > &channels);
+		// Channelize any number of samples and return the number of samples per channel
+		size_t stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output);
+		// Reset the history and the decimation phase
+		void reset();
+		/// Number of channels C
+		size_t getNumChannels() const { return numChannels; }
+		/// Maximum number of samples per channel for inputSize input samples
+		size_t getMaxOutputSize(size_t inputSize) const { return (inputSize + numChannels - 1) / numChannels; }
+		/// Set the gain of the channelizer in terms of left shift. The default gain
+		/// is about 0 dB
+		void setLeftShiftBy2(int leftShiftBy2) { leftShift = leftShiftBy2; }
+
+	private:
+		Fft fft;
+		size_t numChannels;						///< Number of channels C, also the decimation ratio
+		std::shared_ptr<const std::vector<int32_t> > coeff;	///< Prototype filter, possibly shared with other instances
+		std::vector<std::complex<int16_t> > history;	///< History buffer. Each sample is stored twice
+		size_t top;								///< Current insertion point in the history buffer
+		size_t phase;							///< Position in the stream modulo C. An output is computed when 0
+		unsigned coeffScaling;
+		int leftShift;							///< Amount of left shift related to the 0 dB gain
+		std::vector<std::complex<double> > branch;	///< Outputs of the polyphase branches, then of the FFT
+	};
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,108 @@
+#include "dsptl_channelizer.h"
+#include "dsp_complex.h"
+#include "generators.h" // for pi
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+typedef std::complex<int16_t> Sample;
+
+std::vector<std::vector<Sample> > referenceChannels(size_t numChannels, const std::vector<int32_t> &prototype, const std::vector<Sample> &input);
+bool testChannelizer(size_t numChannels, size_t numTapsPerBranch);
+
+int main()
+{
+	srand(1);
+	bool passed = testChannelizer(2, 5);
+	passed = testChannelizer(8, 6) && passed;
+	passed = testChannelizer(16, 3) && passed;
+	passed = testChannelizer(32, 1) && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Each channel computed on its own in double precision: the input is mixed with
+exp(-j 2 pi k t / C), filtered by the prototype and decimated by C. The sum is
+rounded, then scaled as in FilterDnsamplingFir.
+------------------------------------------------------------------------------*/
+std::vector<std::vector<Sample> > referenceChannels(size_t numChannels, const std::vector<int32_t> &prototype, const std::vector<Sample> &input)
+{
+	double sumMagnitude = 0;
+	for (size_t n = 0; n < prototype.size(); ++n)
+		sumMagnitude += std::abs(static_cast<double>(prototype[n]));
+	unsigned scaling = static_cast<unsigned>(floor(log2(sumMagnitude)));
+
+	std::vector<std::vector<Sample> > channels(numChannels);
+	std::vector<std::complex<double> > mixed(input.size());
+	for (size_t k = 0; k < numChannels; ++k)
+	{
+		for (size_t t = 0; t < input.size(); ++t)
+		{
+			double angle = -2 * dsptl::pi * static_cast<double>((k * t) % numChannels) / numChannels;
+			mixed[t] = std::complex<double>(input[t].real(), input[t].imag()) * std::polar(1.0, angle);
+		}
+		for (size_t t = 0; t < input.size(); t += numChannels)
+		{
+			std::complex<double> y;
+			for (size_t n = 0; n < prototype.size() && n <= t; ++n)
+				y += static_cast<double>(prototype[n]) * mixed[t - n];
+			std::complex<int64_t> rounded(llround(y.real()), llround(y.imag()));
+			channels[k].push_back(limitScale<Sample>(rounded, scaling));
+		}
+	}
+	return channels;
+}
+
+/*-----------------------------------------------------------------------------
+PolyphaseChannelizer must give the output of the mix and decimate chain of each
+channel, which checks the sign of the FFT, the absence of normalization of the
+inverse FFT and the scaling. The input is split in blocks of arbitrary sizes,
+including 0, so that the decimation phase is carried from one block to the
+other. The FFT and the reference do not round the same way, so the outputs may
+differ by 1 LSB.
+------------------------------------------------------------------------------*/
+bool testChannelizer(size_t numChannels, size_t numTapsPerBranch)
+{
+	std::vector<int32_t> prototype(numChannels * numTapsPerBranch);
+	int32_t range = static_cast<int32_t>(65536 / prototype.size());
+	for (size_t n = 0; n < prototype.size(); ++n)
+		prototype[n] = rand() % (range + 1) - range / 2;
+
+	std::vector<Sample> input(300 * numChannels + 5);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = Sample(static_cast<int16_t>(rand() % 30001 - 15000), static_cast<int16_t>(rand() % 30001 - 15000));
+	std::vector<std::vector<Sample> > expected = referenceChannels(numChannels, prototype, input);
+
+	dsptl::PolyphaseChannelizer channelizer(numChannels, prototype);
+	std::vector<Sample> output(channelizer.getMaxOutputSize(input.size()) * numChannels);
+	size_t numOut = 0;
+	for (size_t start = 0; start < input.size(); )
+	{
+		size_t blockSize = std::min<size_t>(rand() % (2 * numChannels + 4), input.size() - start);
+		numOut += channelizer.stepStream(&input[start], blockSize, output.data() + numOut * numChannels);
+		start += blockSize;
+	}
+
+	size_t numErrors = (numOut == expected[0].size()) ? 0 : 1;
+	int maxError = 0;
+	for (size_t k = 0; k < numChannels; ++k)
+	{
+		for (size_t m = 0; m < numOut && m < expected[k].size(); ++m)
+		{
+			Sample y = output[m * numChannels + k];
+			int error = std::max(std::abs(y.real() - expected[k][m].real()), std::abs(y.imag() - expected[k][m].imag()));
+			maxError = std::max(maxError, error);
+			numErrors += (error > 1) ? 1 : 0;
+		}
+	}
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ PolyphaseChannelizer C " << numChannels << ", " << prototype.size() << " taps: maximum error "
+		<< maxError << " LSB: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
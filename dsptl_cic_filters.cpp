@@ -0,0 +1,123 @@
+/***********************************************************************//**
+@file
+
+Cascaded integrator comb (CIC) filters: design of the compensation filter
+
+***************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include "dsptl_cic_filters.h"
+#include "constants.h"
+
+namespace
+{
+	/// Number of points of the frequency grid used to design the compensation filter
+	const size_t designGridSize = 2048;
+	/// Sum of the quantized coefficients of the compensation filter: 0 dB with a
+	/// scaling of 15 bits
+	const int32_t compensationDcGain = 32768;
+	/// Limit of the sum of the magnitudes of the quantized coefficients, which keeps
+	/// the scaling of FilterDnsamplingFir at 15 bits
+	const int32_t compensationMaxMagnitude = 65536;
+}
+
+namespace dsptl
+{
+
+	/**************************************************************************//**
+	Design the coefficients of the FIR filter compensating the passband droop of a
+	CIC filter.\n
+
+	The magnitude response of the CIC filter at the frequency f, relative to its
+	output rate, is |sin(pi f) / (R sin(pi f / R))|^K. The desired response of the
+	compensation filter is its inverse in the passband, zero in the stopband and a
+	linear transition in between. The coefficients are obtained by the inverse
+	Fourier transform of the desired response, computed on a dense frequency grid,
+	then weighted by a Hamming window.\n
+
+	The coefficients are quantized so that their sum is exactly 2^15, the rounding
+	error being moved to the two centre coefficients. When the sum of their
+	magnitudes reaches 2^16, for high orders and long filters, the sum is divided by
+	2 until it is below: the filtering of 16 bits samples then cannot overflow
+	32 bits and the scaling of FilterDnsamplingFir is 15 bits. The gain at DC of the
+	filter is 2^-shift where shift is dsptl_private::cicCompensationShift(), 0 in
+	most cases. FilterCicCompensatedDecimator compensates it.
+
+	@param K Order of the CIC filter
+	@param R Decimation ratio of the CIC filter
+	@param numTaps Number of coefficients. Must be a multiple of 2 to be used with
+	FilterDnsamplingFir<..., 2>
+	@param passband Edge of the passband, in cycles per sample at the output rate
+	of the CIC filter
+	@param stopband Edge of the stopband, in cycles per sample at the output rate
+	of the CIC filter. Must be larger than passband and at most 0.5
+
+	@return Symmetric coefficients
+	******************************************************************************/
+	std::vector<int32_t> cicCompensationCoeffs(unsigned K, unsigned R, size_t numTaps, double passband, double stopband)
+	{
+		assert(K > 0 && R > 0 && numTaps > 0);
+		assert(passband > 0 && passband < stopband && stopband <= 0.5);
+
+		// Desired response on the grid, midpoint rule between 0 and 0.5
+		std::vector<double> desired(designGridSize);
+		const double df = 0.5 / designGridSize;
+		for (size_t g = 0; g < designGridSize; ++g)
+		{
+			double f = (g + 0.5) * df;
+			double cic = fabs(sin(pi * f) / (R * sin(pi * f / R)));
+			double inverse = 1.0 / pow(cic, static_cast<double>(K));
+			if (f <= passband)
+				desired[g] = inverse;
+			else if (f < stopband)
+				desired[g] = inverse * (stopband - f) / (stopband - passband);
+			else
+				desired[g] = 0;
+		}
+
+		std::vector<double> h(numTaps);
+		double centre = (numTaps - 1) / 2.0;
+		double sum = 0;
+		for (size_t n = 0; n < numTaps; ++n)
+		{
+			double t = n - centre;
+			double acc = 0;
+			for (size_t g = 0; g < designGridSize; ++g)
+				acc += desired[g] * cos(2 * pi * (g + 0.5) * df * t);
+			double window = (numTaps > 1) ? 0.54 - 0.46 * cos(2 * pi * n / (numTaps - 1)) : 1.0;
+			h[n] = 2 * acc * df * window;
+			sum += h[n];
+		}
+
+		std::vector<int32_t> coeff(numTaps);
+		for (int32_t dcGain = compensationDcGain; ; dcGain /= 2)
+		{
+			int32_t total = 0;
+			for (size_t n = 0; n < numTaps; ++n)
+			{
+				coeff[n] = static_cast<int32_t>(lround(h[n] * dcGain / sum));
+				total += coeff[n];
+			}
+			// The rounding keeps the symmetry of the coefficients: with an even
+			// number of taps, the error is even
+			int32_t error = dcGain - total;
+			if (numTaps % 2 == 1)
+				coeff[numTaps / 2] += error;
+			else
+			{
+				coeff[numTaps / 2 - 1] += error / 2;
+				coeff[numTaps / 2] += error - error / 2;
+			}
+
+			int32_t sumMagnitude = 0;
+			for (size_t n = 0; n < numTaps; ++n)
+				sumMagnitude += std::abs(coeff[n]);
+			if (sumMagnitude < compensationMaxMagnitude)
+				break;
+		}
+		return coeff;
+	}
+
+} // End of namespace
@@ -0,0 +1,395 @@
+/***********************************************************************//**
+@file
+
+Cascaded integrator comb (CIC) decimation and interpolation filters.\n
+
+A CIC filter of order K and rate change R is made of K integrators at the high
+sampling rate and K combs (differential delay of 1) at the low sampling rate.
+It does not perform any multiplication, which makes it the filter of choice for
+large rate changes. Its passband droop is corrected by a short compensation FIR
+filter operating at the low rate.
+
+***************************************************************************/
+
+#ifndef DSPTL_CIC_FILTERS_H
+#define DSPTL_CIC_FILTERS_H
+
+#include <cassert>
+#include <cstdint>
+#include <complex>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include "dsp_complex.h"
+#include "dsptl_dnsampling_filters.h"
+
+namespace dsptl_private
+{
+
+	/***********************************************************************//**
+	Access to the components of the samples processed by the CIC filters. The
+	real and imaginary parts of complex samples are filtered independently.
+
+	***************************************************************************/
+	template<class T>
+	struct CicSample
+	{
+		static const size_t numComponents = 1;
+		/// Type of the wide result before scaling
+		typedef int64_t WideType;
+		/// Number of significant bits of one component including the sign
+		static const int componentBits = std::numeric_limits<T>::digits + 1;
+		static uint64_t component(const T &x, size_t) { return static_cast<uint64_t>(static_cast<int64_t>(x)); }
+		static WideType wide(const uint64_t *v) { return static_cast<int64_t>(v[0]); }
+	};
+
+	template<class T>
+	struct CicSample<std::complex<T> >
+	{
+		static const size_t numComponents = 2;
+		typedef std::complex<int64_t> WideType;
+		static const int componentBits = std::numeric_limits<T>::digits + 1;
+		static uint64_t component(const std::complex<T> &x, size_t index)
+		{
+			return static_cast<uint64_t>(static_cast<int64_t>(index == 0 ? x.real() : x.imag()));
+		}
+		static WideType wide(const uint64_t *v) { return WideType(static_cast<int64_t>(v[0]), static_cast<int64_t>(v[1])); }
+	};
+
+	/// Number of bits of growth of a CIC filter: ceil(K log2(R))
+	inline int cicBitGrowth(unsigned K, unsigned R)
+	{
+		return static_cast<int>(ceil(K * log2(static_cast<double>(R)) - 1e-9));
+	}
+
+	/// Right shift giving a gain of 0 to 6 dB for a gain of R^K: floor(K log2(R))
+	inline unsigned cicShift(unsigned K, unsigned R)
+	{
+		return static_cast<unsigned>(floor(K * log2(static_cast<double>(R)) + 1e-9));
+	}
+
+	/// Attenuation of the compensation filter, as a number of bits: the sum of the
+	/// coefficients of dsptl::cicCompensationCoeffs() is 2^(15 - shift)
+	inline int cicCompensationShift(const std::vector<int32_t> &coeff)
+	{
+		int32_t sum = 0;
+		for (size_t n = 0; n < coeff.size(); ++n)
+			sum += coeff[n];
+		assert(sum > 0);
+		int shift = 0;
+		while ((sum << shift) < 32768)
+			++shift;
+		assert((sum << shift) == 32768);
+		return shift;
+	}
+
+} // End of namespace
+
+namespace dsptl
+{
+
+	// Design the coefficients of the FIR filter compensating the droop of a CIC filter
+	std::vector<int32_t> cicCompensationCoeffs(unsigned K, unsigned R, size_t numTaps, double passband, double stopband);
+
+
+	/***********************************************************************//**
+	CIC decimation filter
+
+	@tparam InType Type of the input signal. Integer or complex of integers
+	@tparam OutType Type of the output signal. Integer or complex of integers
+	@tparam K Order of the filter (number of integrators and of combs)
+	@tparam R Decimation ratio
+
+	The integrators and the combs use unsigned 64 bits registers which wrap around.
+	Thanks to the modular arithmetic, the output of the last comb is exact as long
+	as it fits in 64 bits, even though the integrators overflow.\n
+
+	The gain of the filter is R^K. The output is shifted right by floor(K log2(R))
+	then saturated, which gives a gain between 0 and 6 dB.\n
+
+	Like FilterDnsamplingFir, an output is computed for each input sample whose
+	position in the stream is a multiple of R, and the decimation phase is kept from
+	one call to the other.
+
+	***************************************************************************/
+	template<class InType, class OutType, unsigned K, unsigned R>
+	class FilterCicDecimator
+	{
+		static_assert(K > 0 && R > 0, "The order and the decimation ratio must be positive");
+		typedef dsptl_private::CicSample<InType> Sample;
+		static const size_t C = Sample::numComponents;
+	public:
+		FilterCicDecimator()
+		{
+			// The result must fit in the registers
+			assert(Sample::componentBits + dsptl_private::cicBitGrowth(K, R) <= 64);
+			shift = dsptl_private::cicShift(K, R);
+			reset();
+		}
+		// The input size must be a multiple of R. The output is 1/R the size of the input
+		void step(const std::vector<InType> & input, std::vector<OutType> & filteredSignal);
+		// Version of step() working on a range of samples without any copy
+		void step(const InType *input, size_t inputSize, OutType *filteredSignal);
+		// Filter any number of samples and return the number of outputs
+		size_t stepStream(const InType *input, size_t inputSize, OutType *filteredSignal);
+		/// Reset the internal registers
+		void reset()
+		{
+			phase = 0;
+			for (size_t k = 0; k < K; ++k)
+				for (size_t c = 0; c < C; ++c)
+					integrator[k][c] = combDelay[k][c] = 0;
+		}
+		/// Right shift applied to the output
+		unsigned getShift() const { return shift; }
+
+	private:
+		uint64_t integrator[K][C];	///< Integrator registers
+		uint64_t combDelay[K][C];	///< Previous input of each comb
+		unsigned phase;				///< Position in the stream modulo R. An output is computed when 0
+		unsigned shift;				///< Right shift applied to the output
+	};
+
+	/***********************************************************************//**
+	CIC decimation filter
+
+	@param input Input to the filter. The size must be a multiple of R
+	@param filteredSignal Output of the filter. Must be 1/R the size of the input
+
+	***************************************************************************/
+	template<class InType, class OutType, unsigned K, unsigned R>
+	void FilterCicDecimator<InType, OutType, K, R>::step(const std::vector<InType> & input, std::vector<OutType> & filteredSignal)
+	{
+		assert(filteredSignal.size() * R == input.size());
+		step(input.data(), input.size(), filteredSignal.data());
+	}
+
+	/***********************************************************************//**
+	Version of step() which filters a range of samples without any copy
+
+	@param input First sample of the input of the filter
+	@param inputSize Number of input samples. Must be a multiple of R
+	@param filteredSignal Output of the filter. Room for inputSize / R samples
+
+	***************************************************************************/
+	template<class InType, class OutType, unsigned K, unsigned R>
+	void FilterCicDecimator<InType, OutType, K, R>::step(const InType *input, size_t inputSize, OutType *filteredSignal)
+	{
+		assert(inputSize % R == 0);
+		size_t numOut = stepStream(input, inputSize, filteredSignal);
+		// Only true if the previous calls were made with multiples of R samples
+		assert(numOut * R == inputSize);
+		(void)numOut;
+	}
+
+	/***********************************************************************//**
+	Streaming CIC decimation filter
+
+	@param input First sample of the input of the filter
+	@param inputSize Number of input samples. Can be any value including 0
+	@param filteredSignal Output of the filter. Must have room for
+	(inputSize + R - 1) / R samples. It can be the same location as the input.
+
+	@return Number of samples written to filteredSignal
+
+	***************************************************************************/
+	template<class InType, class OutType, unsigned K, unsigned R>
+	size_t FilterCicDecimator<InType, OutType, K, R>::stepStream(const InType *input, size_t inputSize, OutType *filteredSignal)
+	{
+		size_t outIndex = 0;
+		uint64_t v[C];
+
+		for (size_t j = 0; j < inputSize; ++j)
+		{
+			for (size_t c = 0; c < C; ++c)
+			{
+				uint64_t acc = Sample::component(input[j], c);
+				for (size_t k = 0; k < K; ++k)
+				{
+					integrator[k][c] += acc;
+					acc = integrator[k][c];
+				}
+				v[c] = acc;
+			}
+			bool compute = (phase == 0);
+			phase = (phase + 1 == R) ? 0 : phase + 1;
+			if (!compute)
+				continue;
+
+			for (size_t c = 0; c < C; ++c)
+			{
+				for (size_t k = 0; k < K; ++k)
+				{
+					uint64_t diff = v[c] - combDelay[k][c];
+					combDelay[k][c] = v[c];
+					v[c] = diff;
+				}
+			}
+			filteredSignal[outIndex++] = limitScale<OutType>(Sample::wide(v), shift);
+		}
+		return outIndex;
+	}
+
+
+	/***********************************************************************//**
+	CIC interpolation filter
+
+	@tparam InType Type of the input signal. Integer or complex of integers
+	@tparam OutType Type of the output signal. Integer or complex of integers
+	@tparam K Order of the filter (number of combs and of integrators)
+	@tparam R Interpolation ratio
+
+	Each input sample goes through the K combs, then R - 1 zeros are inserted and
+	the K integrators run at the output rate. The registers wrap around like in
+	FilterCicDecimator.\n
+
+	The gain of the filter is R^(K-1). The output is shifted right by
+	floor((K-1) log2(R)) then saturated.
+
+	***************************************************************************/
+	template<class InType, class OutType, unsigned K, unsigned R>
+	class FilterCicInterpolator
+	{
+		static_assert(K > 0 && R > 0, "The order and the interpolation ratio must be positive");
+		typedef dsptl_private::CicSample<InType> Sample;
+		static const size_t C = Sample::numComponents;
+	public:
+		FilterCicInterpolator()
+		{
+			// The result must fit in the registers
+			assert(Sample::componentBits + 1 + dsptl_private::cicBitGrowth(K, R) <= 64);
+			shift = dsptl_private::cicShift(K - 1, R);
+			reset();
+		}
+		// The output is R times the size of the input
+		void step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal);
+		// Version of step() working on a range of samples without any copy
+		void step(const InType *signal, size_t size, OutType *filteredSignal);
+		/// Reset the internal registers
+		void reset()
+		{
+			for (size_t k = 0; k < K; ++k)
+				for (size_t c = 0; c < C; ++c)
+					integrator[k][c] = combDelay[k][c] = 0;
+		}
+		/// Right shift applied to the output
+		unsigned getShift() const { return shift; }
+
+	private:
+		uint64_t integrator[K][C];	///< Integrator registers
+		uint64_t combDelay[K][C];	///< Previous input of each comb
+		unsigned shift;				///< Right shift applied to the output
+	};
+
+	/***********************************************************************//**
+	CIC interpolation filter
+
+	@param signal Input to the filter
+	@param filteredSignal Output of the filter. Must be R times the size of the input
+
+	***************************************************************************/
+	template<class InType, class OutType, unsigned K, unsigned R>
+	void FilterCicInterpolator<InType, OutType, K, R>::step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal)
+	{
+		assert(signal.size() * R == filteredSignal.size());
+		step(signal.data(), signal.size(), filteredSignal.data());
+	}
+
+	/***********************************************************************//**
+	Version of step() which filters a range of samples without any copy
+
+	@param signal First sample of the input of the filter
+	@param size Number of input samples
+	@param filteredSignal Output of the filter. Room for R * size samples. The
+	output must not overlap the input.
+
+	***************************************************************************/
+	template<class InType, class OutType, unsigned K, unsigned R>
+	void FilterCicInterpolator<InType, OutType, K, R>::step(const InType *signal, size_t size, OutType *filteredSignal)
+	{
+		uint64_t v[C];		// Output of the combs
+		uint64_t out[C];	// Output of the integrators
+
+		for (size_t j = 0; j < size; ++j)
+		{
+			for (size_t c = 0; c < C; ++c)
+			{
+				v[c] = Sample::component(signal[j], c);
+				for (size_t k = 0; k < K; ++k)
+				{
+					uint64_t diff = v[c] - combDelay[k][c];
+					combDelay[k][c] = v[c];
+					v[c] = diff;
+				}
+			}
+			for (size_t r = 0; r < R; ++r)
+			{
+				for (size_t c = 0; c < C; ++c)
+				{
+					// The comb output is followed by R - 1 zeros
+					uint64_t acc = (r == 0) ? v[c] : 0;
+					for (size_t k = 0; k < K; ++k)
+					{
+						integrator[k][c] += acc;
+						acc = integrator[k][c];
+					}
+					out[c] = acc;
+				}
+				filteredSignal[R * j + r] = limitScale<OutType>(Sample::wide(out), shift);
+			}
+		}
+	}
+
+
+	/***********************************************************************//**
+	CIC decimator followed by a compensation FIR filter decimating by 2
+
+	@tparam InType Type of the input signal. Complex of integers: the fixed point
+	scaling of FilterDnsamplingFir only exists for complex samples
+	@tparam OutType Type of the output signal and of the output of the CIC filter
+	@tparam InternalType Type used internally for the computation of the FIR filter
+	@tparam K Order of the CIC filter
+	@tparam R Decimation ratio of the CIC filter. The total ratio is 2R
+
+	The compensation filter is designed by cicCompensationCoeffs() and run by
+	FilterDnsamplingFir. Its gain at DC is 0 dB: the attenuation of the long
+	filters of high order, whose coefficients are scaled down to avoid overflows, is
+	compensated by the left shift of FilterDnsamplingFir.
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, unsigned K, unsigned R>
+	class FilterCicCompensatedDecimator
+	{
+		static_assert(dsptl_private::CicSample<InType>::numComponents == 2, "The samples must be complex");
+
+	public:
+		/// Constructor. The frequencies are relative to the output rate of the CIC
+		/// filter (twice the output rate)
+		FilterCicCompensatedDecimator(size_t numTaps = 32, double passband = 0.2, double stopband = 0.3)
+		{
+			std::vector<int32_t> coeff = cicCompensationCoeffs(K, R, numTaps, passband, stopband);
+			fir.setCoeffs(coeff);
+			fir.setLeftShiftBy2(dsptl_private::cicCompensationShift(coeff));
+		}
+		// Filter any number of samples and return the number of outputs
+		size_t stepStream(const InType *input, size_t inputSize, OutType *filteredSignal)
+		{
+			work.resize((inputSize + R - 1) / R);
+			size_t numCic = cic.stepStream(input, inputSize, work.data());
+			return fir.stepStream(work.data(), numCic, filteredSignal);
+		}
+		/// Reset both stages
+		void reset()
+		{
+			cic.reset();
+			fir.reset();
+		}
+	private:
+		FilterCicDecimator<InType, OutType, K, R> cic;
+		FilterDnsamplingFir<OutType, OutType, InternalType, int32_t, 2> fir;
+		std::vector<OutType> work;	///< Output of the CIC filter
+	};
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,64 @@
+#include "dsptl_cic_filters.h"
+#include <cmath>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+namespace
+{
+	/// Tolerance on the gain at DC
+	const double dcGainToleranceDb = 0.05;
+}
+
+template<unsigned K, unsigned R>
+bool testCompensatedDecimatorGain(size_t numTaps);
+
+int main()
+{
+	bool passed = true;
+	const size_t tapCounts[] = { 16, 32, 64 };
+	for (size_t numTaps : tapCounts)
+	{
+		passed = testCompensatedDecimatorGain<1, 8>(numTaps) && passed;
+		passed = testCompensatedDecimatorGain<3, 4>(numTaps) && passed;
+		passed = testCompensatedDecimatorGain<4, 8>(numTaps) && passed;
+		passed = testCompensatedDecimatorGain<5, 4>(numTaps) && passed;
+		passed = testCompensatedDecimatorGain<5, 8>(numTaps) && passed;
+		passed = testCompensatedDecimatorGain<6, 8>(numTaps) && passed;
+	}
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+The coefficients of the compensation filter must keep its scaling at 15 bits,
+so that 16 bits samples cannot overflow, and the compensated decimator must have
+a gain of 0 dB at DC. R is a power of 2 so that the gain of the CIC filter is
+exactly compensated by its shift.
+------------------------------------------------------------------------------*/
+template<unsigned K, unsigned R>
+bool testCompensatedDecimatorGain(size_t numTaps)
+{
+	using namespace dsptl;
+	typedef std::complex<int16_t> Sample;
+
+	std::vector<int32_t> coeff = cicCompensationCoeffs(K, R, numTaps, 0.2, 0.3);
+	int32_t sumMagnitude = 0;
+	for (size_t n = 0; n < coeff.size(); ++n)
+		sumMagnitude += std::abs(coeff[n]);
+
+	FilterCicCompensatedDecimator<Sample, Sample, std::complex<int32_t>, K, R> decimator(numTaps);
+	const Sample level(8000, -8000);
+	std::vector<Sample> input(2 * R * (numTaps + 16), level);
+	std::vector<Sample> output(input.size() / (2 * R) + 1);
+	size_t numOut = decimator.stepStream(input.data(), input.size(), output.data());
+	std::complex<double> last(output[numOut - 1].real(), output[numOut - 1].imag());
+	double dcGainDb = 20 * log10(std::abs(last) / std::abs(std::complex<double>(level.real(), level.imag())));
+
+	bool passed = sumMagnitude < 65536 && fabs(dcGainDb) < dcGainToleranceDb;
+	std::cout << "+++++ K " << K << ", R " << R << ", " << numTaps << " taps: sum of the magnitudes "
+		<< sumMagnitude << ", gain at DC " << dcGainDb << " dB: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -0,0 +1,277 @@
+/***********************************************************************//**
+@file
+
+Digital down-converter: mixing with a local oscillator followed by a decimating
+FIR filter, performed in a single pass over the input.\n
+
+The result is the same as Mixer::step() followed by FilterDnsamplingFir::stepStream()
+but the mixed samples are written directly into the history of the filter, so
+there is no intermediate buffer at the input rate. When the filter is shorter than
+the decimation ratio, the samples which do not contribute to any output are not
+mixed at all: only the phase of the local oscillator is advanced.
+
+***************************************************************************/
+
+#ifndef DSPTL_DDC_H
+#define DSPTL_DDC_H
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <complex>
+#include <vector>
+#include <memory>
+#include "dsp_complex.h"
+#include "dsptl_filter_common.h"
+#include "mixers.h"
+
+namespace dsptl
+{
+
+	/*-----------------------------------------------------------------------------
+	Digital down-converter for complex 16 bits samples
+
+	@tparam CoefType Type of the coefficients of the filter
+	@tparam M Decimation ratio
+	@tparam N Number of points of the sine table of the local oscillator
+
+	The local oscillator is the one of Mixer and the filter follows the conventions
+	of FilterDnsamplingFir: the gain is about 0 dB and symmetric coefficients are
+	detected. The internal precision is 32 bits. Unlike FilterDnsamplingFir, any
+	number of coefficients is accepted. With fewer coefficients than M, only the
+	input samples used by the filter are mixed.
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N = 4096>
+	class DownConverter
+	{
+	public:
+		DownConverter() : coeff(new std::vector<CoefType>()), top(0), phase(0), coeffScaling(0), leftShift(0), symmetry(dsptl_private::CoeffSymmetry::none) {}
+		DownConverter(const std::vector<CoefType> &firCoeff, float loFreq = 0);
+		DownConverter(const std::shared_ptr<const std::vector<CoefType> > &firCoeff, float loFreq = 0);
+		// Mix and filter a number of samples multiple of M
+		void step(const std::vector<std::complex<int16_t> > &input, std::vector<std::complex<int16_t> > &output);
+		void step(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output);
+		// Mix and filter any number of samples and return the number of outputs
+		size_t stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output);
+		size_t stepStream(const std::vector<std::complex<int16_t> > &input, std::vector<std::complex<int16_t> > &output);
+		// Reset the phase of the local oscillator and the history of the filter
+		void reset(float loFreq = 0);
+		void setCoeffs(const std::vector<CoefType> &firCoeff);
+		// Version of setCoeffs() sharing the coefficients with other instances
+		void setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+		/// Sets the frequency of the local oscillator. See Mixer
+		void setFrequency(float loFreq) { mixer.setFrequency(loFreq); }
+		/// Adjusts the frequency of the local oscillator with continuous phase. See Mixer
+		void adjustFrequency(float adjustFreq) { mixer.adjustFrequency(adjustFreq); }
+		/// Set the gain of the filter in terms of left shift. The default gain is
+		/// about 0 dB
+		void setLeftShiftBy2(int leftShiftBy2) { leftShift = leftShiftBy2; }
+		/// Maximum number of outputs for inputSize input samples
+		static size_t getMaxOutputSize(size_t inputSize) { return (inputSize + M - 1) / M; }
+
+	private:
+		Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N> mixer;
+		std::shared_ptr<const std::vector<CoefType> > coeff;	///< Coefficients, possibly shared with other instances
+		std::vector<std::complex<int16_t> > history;	///< Mixed samples. Each sample is stored twice
+		size_t top;						///< Current insertion point in the history buffer
+		unsigned phase;					///< Position in the stream modulo M. An output is computed when 0
+		unsigned coeffScaling;
+		int leftShift;					///< Amount of left shift related to the 0 dB gain
+		dsptl_private::CoeffSymmetry symmetry;	///< Symmetry of the coefficients
+	};
+
+
+	/*-----------------------------------------------------------------------------
+	Constructor
+
+	@param firCoeff Coefficients of the filter
+	@param loFreq Frequency of the local oscillator in normalized frequency (-1 to 1)
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	DownConverter<CoefType, M, N>::DownConverter(const std::vector<CoefType> &firCoeff, float loFreq)
+	{
+		setCoeffs(firCoeff);
+		mixer.reset(loFreq);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Constructor with coefficients shared with other instances, for example
+	obtained from the cache of dsptl_filter_design.h
+
+	@param firCoeff Coefficients of the filter. Must not be null
+	@param loFreq Frequency of the local oscillator in normalized frequency (-1 to 1)
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	DownConverter<CoefType, M, N>::DownConverter(const std::shared_ptr<const std::vector<CoefType> > &firCoeff, float loFreq)
+	{
+		setCoeffs(firCoeff);
+		mixer.reset(loFreq);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Sets the coefficients of the filter. The history of the filter is cleared but the
+	local oscillator is not modified.
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	void DownConverter<CoefType, M, N>::setCoeffs(const std::vector<CoefType> &firCoeff)
+	{
+		setCoeffs(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+	}
+
+	/*-----------------------------------------------------------------------------
+	Sets the coefficients of the filter without copying them. The instances using
+	the same table share it. The table must not be modified afterwards.
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	void DownConverter<CoefType, M, N>::setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+	{
+		assert(firCoeff && !firCoeff->empty());
+		coeff = firCoeff;
+		history.resize(2 * coeff->size());
+		double sumMagnitude = 0;
+		for (size_t index = 0; index < coeff->size(); ++index)
+			sumMagnitude += abs((*coeff)[index]);
+		coeffScaling = static_cast<int>(floor(log2(sumMagnitude)));
+		leftShift = 0;
+		symmetry = dsptl_private::findSymmetry(*coeff);
+		top = 0;
+		phase = 0;
+		for (size_t index = 0; index < history.size(); ++index)
+			history[index] = std::complex<int16_t>();
+	}
+
+	/*-----------------------------------------------------------------------------
+	Resets the phase of the local oscillator, the decimation phase and the history
+	of the filter
+
+	@param loFreq New frequency of the local oscillator in normalized frequency
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	void DownConverter<CoefType, M, N>::reset(float loFreq)
+	{
+		mixer.reset(loFreq);
+		top = 0;
+		phase = 0;
+		for (size_t index = 0; index < history.size(); ++index)
+			history[index] = std::complex<int16_t>();
+	}
+
+	/*-----------------------------------------------------------------------------
+	Digital down-converter
+
+	The number of input samples must be a multiple of M and the output must have
+	room for inputSize / M samples.
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	void DownConverter<CoefType, M, N>::step(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output)
+	{
+		assert(inputSize % M == 0);
+		size_t numOut = stepStream(input, inputSize, output);
+		// Only true if the previous calls were made with multiples of M samples
+		assert(numOut * M == inputSize);
+		(void)numOut;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Digital down-converter
+
+	Version of step() with vectors. The output must be M times smaller than the input.
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	void DownConverter<CoefType, M, N>::step(const std::vector<std::complex<int16_t> > &input, std::vector<std::complex<int16_t> > &output)
+	{
+		assert(output.size() * M == input.size());
+		step(input.data(), input.size(), output.data());
+	}
+
+	/*-----------------------------------------------------------------------------
+	Streaming digital down-converter
+
+	Each input sample is mixed with the local oscillator and written twice in the
+	history of the filter, as in FilterDnsamplingFir::stepStream(). An output is
+	computed for each input sample whose position in the stream is a multiple of M.\n
+
+	The sample at a given decimation phase is used by the next output only if it is
+	one of its last N samples, where N is the number of taps. The others are never
+	read from the history, so they are skipped and the local oscillator is advanced
+	instead.
+
+	@param input First input sample
+	@param inputSize Number of input samples. Can be any value including 0
+	@param output Room for getMaxOutputSize(inputSize) samples. It can be the same
+	location as the input.
+
+	@return Number of samples written to output
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	size_t DownConverter<CoefType, M, N>::stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output)
+	{
+		assert(!coeff->empty());
+
+		size_t numTaps = coeff->size();
+		size_t outIndex = 0;
+		const CoefType *c = coeff->data();
+		std::complex<int32_t> y;
+
+		for (size_t j = 0; j < inputSize; ++j)
+		{
+			// Distance to the next output
+			unsigned distance = (phase == 0) ? 0 : M - phase;
+			if (distance < numTaps)
+			{
+				std::complex<int16_t> mixed = mixer.mixOne(input[j]);
+				history[top] = mixed;
+				history[top + numTaps] = mixed;
+			}
+			else
+				mixer.advance(1);
+			const std::complex<int16_t> *window = &history[top];
+
+			// The sample is consumed before the output is written since the
+			// processing can be made in place
+			top = (top == 0) ? numTaps - 1 : top - 1;
+			phase = (phase + 1 == M) ? 0 : phase + 1;
+			if (distance != 0)
+				continue;
+
+			if (symmetry != dsptl_private::CoeffSymmetry::none)
+				y = dsptl_private::foldedInnerProduct<std::complex<int32_t> >(c, window, numTaps, symmetry);
+			else
+			{
+				y = std::complex<int32_t>{};
+				for (size_t k = 0; k < numTaps; ++k)
+					y += c[k] * std::complex<int32_t>(window[k]);
+			}
+			output[outIndex++] = limitScale16(y, coeffScaling - leftShift);
+		}
+		return outIndex;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Streaming digital down-converter
+
+	Version of stepStream() with vectors. The output vector is resized to the number
+	of samples which are ready.
+
+	------------------------------------------------------------------------------*/
+	template<class CoefType, unsigned M, unsigned N>
+	size_t DownConverter<CoefType, M, N>::stepStream(const std::vector<std::complex<int16_t> > &input, std::vector<std::complex<int16_t> > &output)
+	{
+		output.resize(getMaxOutputSize(input.size()));
+		size_t numOut = stepStream(input.data(), input.size(), output.data());
+		output.resize(numOut);
+		return numOut;
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,98 @@
+#include "dsptl_ddc.h"
+#include "dsptl_dnsampling_filters.h"
+#include "mixers.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+typedef std::complex<int16_t> Sample;
+
+std::vector<int32_t> randomTaps(size_t numTaps, dsptl_private::CoeffSymmetry symmetry);
+template<unsigned M>
+bool testDownConverter(const char *name, const std::vector<int32_t> &coeff, float loFreq);
+
+int main()
+{
+	srand(1);
+	using dsptl_private::CoeffSymmetry;
+
+	bool passed = testDownConverter<8>("5 taps", randomTaps(5, CoeffSymmetry::none), -0.3f);
+	passed = testDownConverter<8>("7 symmetric taps", randomTaps(7, CoeffSymmetry::symmetric), 0.45f) && passed;
+	passed = testDownConverter<5>("5 taps", randomTaps(5, CoeffSymmetry::none), 0.2f) && passed;
+	passed = testDownConverter<3>("20 taps", randomTaps(20, CoeffSymmetry::none), -0.8f) && passed;
+	passed = testDownConverter<4>("33 symmetric taps", randomTaps(33, CoeffSymmetry::symmetric), -0.05f) && passed;
+	passed = testDownConverter<6>("16 antisymmetric taps", randomTaps(16, CoeffSymmetry::antisymmetric), 0.7f) && passed;
+	passed = testDownConverter<2>("1 tap", randomTaps(1, CoeffSymmetry::none), -1.0f) && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Random taps with a sum of magnitudes of about 2^15 and the requested symmetry
+------------------------------------------------------------------------------*/
+std::vector<int32_t> randomTaps(size_t numTaps, dsptl_private::CoeffSymmetry symmetry)
+{
+	std::vector<int32_t> coeff(numTaps);
+	int32_t range = static_cast<int32_t>(65536 / numTaps);
+	for (size_t k = 0; k < numTaps; ++k)
+		coeff[k] = rand() % (range + 1) - range / 2;
+	if (symmetry == dsptl_private::CoeffSymmetry::none)
+		return coeff;
+
+	int32_t sign = (symmetry == dsptl_private::CoeffSymmetry::symmetric) ? 1 : -1;
+	for (size_t k = 0; k < numTaps / 2; ++k)
+		coeff[numTaps - 1 - k] = sign * coeff[k];
+	if (numTaps % 2 == 1 && sign < 0)
+		coeff[numTaps / 2] = 0;
+	return coeff;
+}
+
+/*-----------------------------------------------------------------------------
+DownConverter must give the output of the mixer followed by the decimating
+filter. The taps of the reference filter are padded with zeros to a multiple
+of M, which does not change its scaling. The samples which are not used by the
+next output are not mixed by the down-converter, so the test covers filters
+shorter than M. The input is split in blocks of odd sizes, so that the decimation
+phase and the phase of the local oscillator are carried from one block to the other.
+------------------------------------------------------------------------------*/
+template<unsigned M>
+bool testDownConverter(const char *name, const std::vector<int32_t> &coeff, float loFreq)
+{
+	std::vector<Sample> input(4003);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = Sample(static_cast<int16_t>(rand() % 60001 - 30000), static_cast<int16_t>(rand() % 60001 - 30000));
+
+	dsptl::Mixer<Sample, Sample, int16_t, 4096> mixer;
+	mixer.reset(loFreq);
+	std::vector<Sample> mixed(input.size());
+	mixer.step(input.data(), input.size(), mixed.data());
+
+	std::vector<int32_t> paddedCoeff(coeff);
+	paddedCoeff.resize((coeff.size() + M - 1) / M * M, 0);
+	dsptl::FilterDnsamplingFir<Sample, Sample, std::complex<int32_t>, int32_t, M> filter(paddedCoeff);
+	std::vector<Sample> expected;
+	filter.stepStream(mixed, expected);
+
+	dsptl::DownConverter<int32_t, M> converter(coeff, loFreq);
+	std::vector<Sample> output(dsptl::DownConverter<int32_t, M>::getMaxOutputSize(input.size()));
+	size_t numOut = 0;
+	for (size_t start = 0; start < input.size(); )
+	{
+		size_t blockSize = std::min<size_t>(2 * (rand() % 12) + 1, input.size() - start);
+		numOut += converter.stepStream(&input[start], blockSize, output.data() + numOut);
+		start += blockSize;
+	}
+
+	size_t numErrors = (numOut == expected.size()) ? 0 : 1;
+	for (size_t m = 0; m < numOut && m < expected.size(); ++m)
+		numErrors += (output[m] != expected[m]) ? 1 : 0;
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ DownConverter M " << M << ", " << name << ", LO " << loFreq << ": "
+		<< numErrors << " differences: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -0,0 +1,284 @@
+/***********************************************************************//**
+@file
+
+Planning and construction of multi-stage decimation filters.
+
+***************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include "dsptl_decimation_planner.h"
+#include "dsptl_filter_design.h"
+
+namespace
+{
+	typedef std::complex<int16_t> Sample;
+	typedef std::complex<int32_t> Accumulator;
+
+	/// Largest decimation ratio of a single stage
+	const unsigned maxStageFactor = 8;
+
+	/// Attenuation in dB added to the requested one to design the stages. It covers
+	/// the error of Kaiser's estimate of the number of taps and the quantization of
+	/// the coefficients to 16 bits
+	const double designMarginDb = 3.0;
+
+	/// Characteristics of the filter of one stage
+	struct StageDesign
+	{
+		size_t numTaps;
+		double macsPerStageInput;	///< Multiplications per input sample of the stage
+	};
+
+	/**************************************************************************//**
+	Number of taps and cost of a stage. The filter must keep the passband and
+	reject the frequencies which alias into it: the stopband starts at the output
+	rate minus the passband. The remaining aliasing is removed by the following
+	stages.\n
+
+	A factor of 2 is implemented by a halfband filter of 4K-1 taps which needs K+1
+	multiplications per output. The other factors use FilterDnsamplingFir with a
+	multiple of the factor as number of taps, and half of the multiplications thanks
+	to the symmetry of the coefficients.
+
+	@param inputRate Input rate of the stage
+	@param factor Decimation ratio of the stage
+	@param passband Edge of the passband
+	@param attenuationDb Stopband attenuation
+	******************************************************************************/
+	StageDesign designStage(double inputRate, unsigned factor, double passband, double attenuationDb)
+	{
+		StageDesign design;
+		double stopband = inputRate / factor - passband;
+		size_t numTaps = dsptl::estimateNumTaps(attenuationDb, (stopband - passband) / inputRate);
+		if (factor == 2)
+		{
+			size_t K = std::max<size_t>(1, (numTaps + 1 + 3) / 4);
+			design.numTaps = 4 * K - 1;
+			design.macsPerStageInput = (K + 1) / 2.0;
+		}
+		else
+		{
+			design.numTaps = std::max<size_t>(factor, (numTaps + factor - 1) / factor * factor);
+			design.macsPerStageInput = ((design.numTaps + 1) / 2) / static_cast<double>(factor);
+		}
+		return design;
+	}
+
+	/**************************************************************************//**
+	Search of the factorization of the remaining decimation ratio with the lowest
+	cost. All the orders of the factors are tried.
+
+	@param ratio Remaining decimation ratio
+	@param inputRate Input rate of the next stage
+	@param relativeRate Input rate of the next stage relative to the input rate of
+	the cascade
+	@param factors Best factorization found
+	@return Cost of the best factorization, in multiplications per input sample of
+	the cascade. Negative if the ratio cannot be factorized.
+	******************************************************************************/
+	double searchFactors(unsigned ratio, double inputRate, double relativeRate, double passband, double attenuationDb,
+		std::vector<unsigned> &factors)
+	{
+		factors.clear();
+		if (ratio == 1)
+			return 0;
+
+		double bestCost = -1;
+		std::vector<unsigned> next;
+		for (unsigned factor = 2; factor <= maxStageFactor && factor <= ratio; ++factor)
+		{
+			if (ratio % factor != 0)
+				continue;
+			double cost = searchFactors(ratio / factor, inputRate / factor, relativeRate / factor, passband, attenuationDb, next);
+			if (cost < 0)
+				continue;
+			cost += relativeRate * designStage(inputRate, factor, passband, attenuationDb).macsPerStageInput;
+			if (bestCost < 0 || cost < bestCost)
+			{
+				bestCost = cost;
+				factors.assign(1, factor);
+				factors.insert(factors.end(), next.begin(), next.end());
+			}
+		}
+		return bestCost;
+	}
+
+	/// Construction of the stage of a cascade
+	std::unique_ptr<dsptl::DecimationStage> makeStage(const dsptl::DecimationStagePlan &plan)
+	{
+		using namespace dsptl;
+		switch (plan.factor)
+		{
+		case 2:
+			if (plan.halfband)
+				return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingHalfband<Sample, Sample, Accumulator, int32_t>, 2>(plan.coeffs));
+			return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingFir<Sample, Sample, Accumulator, int32_t, 2>, 2>(plan.coeffs));
+		case 3:
+			return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingFir<Sample, Sample, Accumulator, int32_t, 3>, 3>(plan.coeffs));
+		case 4:
+			return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingFir<Sample, Sample, Accumulator, int32_t, 4>, 4>(plan.coeffs));
+		case 5:
+			return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingFir<Sample, Sample, Accumulator, int32_t, 5>, 5>(plan.coeffs));
+		case 6:
+			return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingFir<Sample, Sample, Accumulator, int32_t, 6>, 6>(plan.coeffs));
+		case 7:
+			return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingFir<Sample, Sample, Accumulator, int32_t, 7>, 7>(plan.coeffs));
+		case 8:
+			return std::unique_ptr<DecimationStage>(new DecimationStageFilter<FilterDnsamplingFir<Sample, Sample, Accumulator, int32_t, 8>, 8>(plan.coeffs));
+		default:
+			assert(false);
+			return std::unique_ptr<DecimationStage>();
+		}
+	}
+}
+
+namespace dsptl
+{
+
+	/**************************************************************************//**
+	Select the factorization of the decimation ratio which minimizes the number of
+	multiplications per input sample, then design the quantized coefficients of
+	each stage.\n
+
+	The ratio is factorized with stages of 2 (halfband filters) to 8. The number of
+	taps of each stage is estimated from its transition band by Kaiser's formula,
+	which matches the Kaiser window the filters are designed with. The stages are
+	designed for a few dB more than the requested attenuation, which covers the
+	error of the estimate and the quantization of the coefficients.
+
+	@param inputRate Sampling rate of the input
+	@param outputRate Sampling rate of the output. The ratio inputRate / outputRate
+	must be an integer whose prime factors are at most 7
+	@param passband Edge of the passband. Must be smaller than half the output rate
+	@param attenuationDb Stopband attenuation of each stage in dB. The quantization
+	of the coefficients, whose sum is 2^15 (see quantizeCoeffs()), limits the
+	attenuation actually obtained to about 75 dB
+
+	@return Plan of the cascade. The stages are empty if the ratio is 1
+	******************************************************************************/
+	DecimationPlan planDecimation(double inputRate, double outputRate, double passband, double attenuationDb)
+	{
+		assert(inputRate > 0 && outputRate > 0 && outputRate <= inputRate);
+		assert(passband > 0 && 2 * passband < outputRate);
+		unsigned ratio = static_cast<unsigned>(lround(inputRate / outputRate));
+		assert(fabs(inputRate / outputRate - ratio) < 1e-6 * ratio);
+
+		DecimationPlan plan;
+		std::vector<unsigned> factors;
+		attenuationDb += designMarginDb;
+		plan.macsPerInput = searchFactors(ratio, inputRate, 1.0, passband, attenuationDb, factors);
+		assert(plan.macsPerInput >= 0);
+
+		double rate = inputRate;
+		double relativeRate = 1.0;
+		for (size_t s = 0; s < factors.size(); ++s)
+		{
+			DecimationStagePlan stage;
+			stage.factor = factors[s];
+			stage.halfband = (stage.factor == 2);
+			StageDesign design = designStage(rate, stage.factor, passband, attenuationDb);
+			if (stage.halfband)
+			{
+				stage.coeffs = quantizeCoeffs(designHalfbandKaiser(design.numTaps, attenuationDb));
+			}
+			else
+			{
+				double stopband = rate / stage.factor - passband;
+				double cutoff = (passband + stopband) / 2 / rate;
+				stage.coeffs = quantizeCoeffs(designLowpassKaiser(design.numTaps, cutoff, attenuationDb));
+			}
+			stage.macsPerInput = relativeRate * design.macsPerStageInput;
+			plan.stages.push_back(stage);
+			rate /= stage.factor;
+			relativeRate /= stage.factor;
+		}
+		return plan;
+	}
+
+
+	/**************************************************************************//**
+	Constructor. The stages of the plan are created.
+
+	******************************************************************************/
+	DecimationCascade::DecimationCascade(const DecimationPlan &plan)
+	{
+		for (size_t s = 0; s < plan.stages.size(); ++s)
+			stages.push_back(makeStage(plan.stages[s]));
+	}
+
+	/**************************************************************************//**
+	Filter a block of any size
+
+	@param input First input sample
+	@param inputSize Number of input samples
+	@param output Room for getMaxOutputSize(inputSize) samples
+
+	@return Number of output samples
+	******************************************************************************/
+	size_t DecimationCascade::stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output)
+	{
+		if (stages.empty())
+		{
+			for (size_t j = 0; j < inputSize; ++j)
+				output[j] = input[j];
+			return inputSize;
+		}
+		if (stages.size() == 1)
+			return stages[0]->stepStream(input, inputSize, output);
+
+		size_t firstSize = (inputSize + stages[0]->getFactor() - 1) / stages[0]->getFactor();
+		if (work.size() < firstSize)
+			work.resize(firstSize);
+		size_t size = stages[0]->stepStream(input, inputSize, work.data());
+		for (size_t s = 1; s + 1 < stages.size(); ++s)
+			size = stages[s]->stepStream(work.data(), size, work.data());
+		return stages.back()->stepStream(work.data(), size, output);
+	}
+
+	/**************************************************************************//**
+	Version of stepStream() with vectors. The output vector is resized to the
+	number of output samples.
+
+	******************************************************************************/
+	size_t DecimationCascade::stepStream(const std::vector<std::complex<int16_t> > &input, std::vector<std::complex<int16_t> > &output)
+	{
+		output.resize(getMaxOutputSize(input.size()));
+		size_t numOut = stepStream(input.data(), input.size(), output.data());
+		output.resize(numOut);
+		return numOut;
+	}
+
+	/**************************************************************************//**
+	Reset the history of all the stages
+
+	******************************************************************************/
+	void DecimationCascade::reset()
+	{
+		for (size_t s = 0; s < stages.size(); ++s)
+			stages[s]->reset();
+	}
+
+	/**************************************************************************//**
+	Return the total decimation ratio of the cascade
+
+	******************************************************************************/
+	unsigned DecimationCascade::getFactor() const
+	{
+		unsigned factor = 1;
+		for (size_t s = 0; s < stages.size(); ++s)
+			factor *= stages[s]->getFactor();
+		return factor;
+	}
+
+	/**************************************************************************//**
+	Return the maximum number of outputs for inputSize input samples
+
+	******************************************************************************/
+	size_t DecimationCascade::getMaxOutputSize(size_t inputSize) const
+	{
+		unsigned factor = getFactor();
+		return (inputSize + factor - 1) / factor;
+	}
+
+} // End of namespace
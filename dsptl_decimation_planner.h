@@ -0,0 +1,124 @@
+/***********************************************************************//**
+@file
+
+Planning and construction of multi-stage decimation filters.\n
+
+A large decimation ratio is much cheaper to implement as a cascade of small
+decimation stages than as a single filter: the first stages run at a high rate
+but have a wide transition band, while the sharp filters only run at the low
+rates. The planner selects the factorization of the decimation ratio which
+minimizes the number of multiplications per input sample, designs the
+coefficients of each stage and builds the cascade.
+
+***************************************************************************/
+
+#ifndef DSPTL_DECIMATION_PLANNER_H
+#define DSPTL_DECIMATION_PLANNER_H
+
+#include <cstdint>
+#include <complex>
+#include <vector>
+#include <memory>
+#include "dsptl_dnsampling_filters.h"
+#include "dsptl_halfband_filters.h"
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Description of one stage of a decimation cascade
+
+	***************************************************************************/
+	struct DecimationStagePlan
+	{
+		unsigned factor;				///< Decimation ratio of the stage
+		bool halfband;					///< True if the stage is a halfband filter (factor 2)
+		std::vector<int32_t> coeffs;	///< Quantized coefficients of the stage
+		double macsPerInput;			///< Multiplications per input sample of the cascade
+	};
+
+	/***********************************************************************//**
+	Description of a decimation cascade
+
+	***************************************************************************/
+	struct DecimationPlan
+	{
+		std::vector<DecimationStagePlan> stages;	///< Stages, the first one runs at the input rate
+		double macsPerInput;						///< Total multiplications per input sample
+	};
+
+	// Select and design the cheapest cascade of decimation stages
+	DecimationPlan planDecimation(double inputRate, double outputRate, double passband, double attenuationDb);
+
+
+	/***********************************************************************//**
+	Interface of a stage of a decimation cascade. The samples are complex 16 bits.
+
+	***************************************************************************/
+	class DecimationStage
+	{
+	public:
+		virtual ~DecimationStage() {}
+		/// Filter any number of samples and return the number of outputs
+		virtual size_t stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output) = 0;
+		/// Reset the history of the stage
+		virtual void reset() = 0;
+		/// Decimation ratio of the stage
+		virtual unsigned getFactor() const = 0;
+	};
+
+	/***********************************************************************//**
+	Decimation stage implemented by one of the decimation filters of the library
+
+	@tparam Filter FilterDnsamplingFir or FilterDnsamplingHalfband instantiated for
+	complex 16 bits samples
+	@tparam M Decimation ratio of the filter
+
+	***************************************************************************/
+	template<class Filter, unsigned M>
+	class DecimationStageFilter : public DecimationStage
+	{
+	public:
+		DecimationStageFilter(const std::vector<int32_t> &coeffs) : filter(coeffs) {}
+		size_t stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output)
+		{
+			return filter.stepStream(input, inputSize, output);
+		}
+		void reset() { filter.reset(); }
+		unsigned getFactor() const { return M; }
+	private:
+		Filter filter;
+	};
+
+
+	/***********************************************************************//**
+	Cascade of decimation stages built from a DecimationPlan
+
+	The intermediate results are stored in an internal buffer which only grows with
+	the size of the blocks. Since each stage writes its outputs behind the samples
+	it reads, the stages after the first one filter this buffer in place. Blocks of
+	any size can be processed.
+
+	***************************************************************************/
+	class DecimationCascade
+	{
+	public:
+		DecimationCascade(const DecimationPlan &plan);
+		// Filter any number of samples and return the number of outputs
+		size_t stepStream(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output);
+		// Version of stepStream with vectors. The output is resized
+		size_t stepStream(const std::vector<std::complex<int16_t> > &input, std::vector<std::complex<int16_t> > &output);
+		// Reset all the stages
+		void reset();
+		// Total decimation ratio
+		unsigned getFactor() const;
+		// Maximum number of outputs for inputSize input samples
+		size_t getMaxOutputSize(size_t inputSize) const;
+	private:
+		std::vector<std::unique_ptr<DecimationStage> > stages;
+		std::vector<std::complex<int16_t> > work;	///< Intermediate results, filtered in place
+	};
+
+} // End of namespace
+
+#endif
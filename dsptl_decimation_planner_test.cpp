@@ -0,0 +1,118 @@
+#include "dsptl_decimation_planner.h"
+#include <cmath>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+namespace
+{
+	/// Attenuation allowed by the quantization of the coefficients. See planDecimation()
+	const double quantizationLimitDb = 75.0;
+	/// Tolerance on the gain at DC
+	const double dcGainToleranceDb = 0.05;
+
+	/// Parameters of a plan
+	struct PlanCase
+	{
+		double inputRate;
+		double outputRate;
+		double passband;
+		double attenuationDb;
+	};
+}
+
+double toneAmplitude(dsptl::DecimationCascade &cascade, double inputRate, double outputRate, double frequency);
+bool testDecimationPlan(const PlanCase &test);
+
+int main()
+{
+	const PlanCase cases[] =
+	{
+		{ 8, 1, 0.4, 60 },
+		{ 64, 1, 0.4, 70 },
+		{ 48000, 8000, 3000, 60 },
+		{ 100, 1, 0.4, 60 },
+		{ 2, 1, 0.4, 60 },
+		{ 12, 1, 0.4, 80 }
+	};
+
+	bool passed = true;
+	for (const PlanCase &test : cases)
+		passed = testDecimationPlan(test) && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Amplitude of the output of the cascade for a complex tone of amplitude 1 at the
+input. The output is correlated with the tone at the frequency where it aliases
+after the decimation.
+------------------------------------------------------------------------------*/
+double toneAmplitude(dsptl::DecimationCascade &cascade, double inputRate, double outputRate, double frequency)
+{
+	const double amplitude = 16000;
+	const size_t settling = 128;
+	const size_t numOut = 512;
+
+	size_t factor = cascade.getFactor();
+	std::vector<std::complex<int16_t> > input((settling + numOut) * factor);
+	for (size_t n = 0; n < input.size(); ++n)
+	{
+		double phase = 2 * M_PI * frequency / inputRate * n;
+		input[n] = std::complex<int16_t>(static_cast<int16_t>(lround(amplitude * cos(phase))),
+			static_cast<int16_t>(lround(amplitude * sin(phase))));
+	}
+	std::vector<std::complex<int16_t> > output;
+	cascade.reset();
+	cascade.stepStream(input, output);
+
+	double alias = frequency - round(frequency / outputRate) * outputRate;
+	std::complex<double> sum;
+	for (size_t n = settling; n < output.size(); ++n)
+		sum += std::complex<double>(output[n].real(), output[n].imag()) * std::polar(1.0, -2 * M_PI * alias / outputRate * n);
+	return std::abs(sum) / (output.size() - settling) / amplitude;
+}
+
+/*-----------------------------------------------------------------------------
+The gain at DC of the cascade must be 0 dB and the tones which alias into the
+passband must be rejected by the requested attenuation
+------------------------------------------------------------------------------*/
+bool testDecimationPlan(const PlanCase &test)
+{
+	using namespace dsptl;
+
+	DecimationPlan plan = planDecimation(test.inputRate, test.outputRate, test.passband, test.attenuationDb);
+	DecimationCascade cascade(plan);
+	std::cout << "+++++ Ratio " << test.inputRate / test.outputRate << ", " << test.attenuationDb << " dB. Stages:";
+	for (size_t s = 0; s < plan.stages.size(); ++s)
+		std::cout << " " << plan.stages[s].factor << " (" << plan.stages[s].coeffs.size() << " taps)";
+	std::cout << "\n";
+
+	// Gain at DC
+	std::vector<std::complex<int16_t> > input(256 * cascade.getFactor(), std::complex<int16_t>(16000, -16000));
+	std::vector<std::complex<int16_t> > output;
+	cascade.stepStream(input, output);
+	double dcGainDb = 20 * log10(std::abs(std::complex<double>(output.back().real(), output.back().imag())) / std::abs(std::complex<double>(16000, -16000)));
+
+	// Tones between the edge of the stopband and half the input rate, which alias
+	// into the passband
+	double passbandGain = toneAmplitude(cascade, test.inputRate, test.outputRate, test.passband / 2);
+	double rejectionDb = 1000;
+	const int numTones = 240;
+	double lowest = test.outputRate - test.passband;
+	for (int k = 0; k <= numTones; ++k)
+	{
+		double frequency = lowest + (test.inputRate / 2 - lowest) * k / numTones;
+		if (fabs(frequency - round(frequency / test.outputRate) * test.outputRate) > test.passband)
+			continue;
+		double gain = toneAmplitude(cascade, test.inputRate, test.outputRate, frequency);
+		rejectionDb = std::min(rejectionDb, 20 * log10(passbandGain / gain));
+	}
+
+	double expectedDb = std::min(test.attenuationDb, quantizationLimitDb);
+	bool passed = fabs(dcGainDb) < dcGainToleranceDb && rejectionDb >= expectedDb;
+	std::cout << "Gain at DC " << dcGainDb << " dB, rejection " << rejectionDb << " dB (expected "
+		<< expectedDb << " dB): " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
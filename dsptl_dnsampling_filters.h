@@ -16,7 +16,9 @@ Class member function: functionMember
 
 #include <cassert>
 #include <vector>
+#include <memory>
 #include "dsp_complex.h"
+#include "dsptl_filter_common.h"
 #include <cmath>
 
 
@@ -38,7 +40,18 @@ namespace dsptl
 	work smoothly. Overflow and underflow conditions must not occur
 
 	@note The class is currently written to support int32_t coefficients, int16_t inputs
-	and int16_t outputs. Internal precision is int32_t.
+	and int16_t outputs. Internal precision is int32_t. It also supports float and
+	double samples, real or complex, with real coefficients of the same precision.
+	The output is then not scaled and the inner products use the FMA kernels of
+	dsptl_simd.h when the host supports them.
+
+	Symmetric and antisymmetric (linear phase) sets of coefficients are detected by
+	setCoeffs(). The mirrored samples are then added before the multiplication, which
+	halves the number of multiplications.
+
+	The decimation phase is kept from one call to the other. stepStream() accepts
+	blocks of any size, including blocks shorter than the filter, and returns the
+	number of outputs which are ready.
 
 	------------------------------------------------------------------------------*/
 	template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
@@ -49,24 +62,37 @@ namespace dsptl
 		/// buffer is reserved based on the number of coefficients
 		FilterDnsamplingFir();
 		FilterDnsamplingFir(const std::vector<CoefType> &firCoeff);
+		FilterDnsamplingFir(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
 		// This function is called for each iteration of the filtering process
 		void step(const std::vector<InType> & input, std::vector<OutType> & filteredSignal);
+		// Version of step() working on a range of samples without any copy
+		void step(const InType *input, size_t inputSize, OutType *filteredSignal);
+		// Filter any number of samples and return the number of outputs
+		size_t stepStream(const InType *input, size_t inputSize, OutType *filteredSignal);
+		size_t stepStream(const std::vector<InType> & input, std::vector<OutType> & filteredSignal);
 		// Reset the internal counters and buffers
 		void reset()
 		{
+			top = 0;
+			phase = 0;
 			for (size_t index = 0; index < history.size(); ++index)
 				history[index] = InType();
 		}
 		void setCoeffs(const std::vector<CoefType>&);
+		// Version of setCoeffs() sharing the coefficients with other filters
+		void setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &);
 		/// Set the gain of the upsampler in terms of left shift. The default gain is 
 		/// about 0 dB
 		void setLeftShiftBy2(int leftShiftBy2) {leftShift = leftShiftBy2;}
 		
 	private:
-		std::vector<CoefType> coeff;		///< Coefficients
-		std::vector<InType> history;  	///< History buffer
+		std::shared_ptr<const std::vector<CoefType> > coeff;	///< Coefficients, possibly shared with other filters
+		std::vector<InType> history;  	///< History buffer. Each sample is stored twice
+		size_t top;						///< Current insertion point in the history buffer
+		unsigned phase;					///< Position in the stream modulo M. An output is computed when 0
 		unsigned coeffScaling;  // Can be used to scale back the result 
 		int leftShift;          ///< Amount of left shift to perform on the decimated output related to the 0 dB
+		dsptl_private::CoeffSymmetry symmetry;	///< Symmetry of the coefficients
 	};
 
 
@@ -80,6 +106,7 @@ namespace dsptl
 	------------------------------------------------------------------------------*/
 	template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
 	FilterDnsamplingFir<InType, OutType, InternalType, CoefType, M>::FilterDnsamplingFir()
+		: coeff(new std::vector<CoefType>()), top(0), phase(0), symmetry(dsptl_private::CoeffSymmetry::none)
 	{};
 	
 	/*-----------------------------------------------------------------------------
@@ -100,6 +127,20 @@ namespace dsptl
 
 	}
 
+	/*-----------------------------------------------------------------------------
+	Downsampling FIR Filter Constructor with coefficients shared with other
+	filters, for example obtained from the cache of dsptl_filter_design.h
+
+	------------------------------------------------------------------------------*/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
+	FilterDnsamplingFir<InType, OutType, InternalType, CoefType, M>::FilterDnsamplingFir
+	(
+		const std::shared_ptr<const std::vector<CoefType> > &firCoeff ///< Coefficients. Must not be null
+	)
+	{
+		setCoeffs(firCoeff);
+	}
+
 
 	/*-----------------------------------------------------------------------------
 	Sets the coeffficients of the filter.
@@ -117,20 +158,40 @@ namespace dsptl
 		const std::vector<CoefType> &firCoeff ///< vector of real coefficients
 	)
 	{
+		setCoeffs(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+	}
+
+	/*-----------------------------------------------------------------------------
+	Sets the coeffficients of the filter without copying them. The filters using
+	the same table share it, which saves memory when many instances use the same
+	design. The table must not be modified afterwards.
+
+	@param firCoeff Filter Coefficients
+
+	------------------------------------------------------------------------------*/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
+	void FilterDnsamplingFir<InType, OutType, InternalType, CoefType, M>::setCoeffs
+	(
+		const std::shared_ptr<const std::vector<CoefType> > &firCoeff ///< vector of real coefficients. Must not be null
+	)
+	{
+		assert(firCoeff);
 		// The number of coefficients msut always be a multiple of the 
 		// decimation ratio
-		assert(firCoeff.size() % M == 0);
-		coeff.assign(firCoeff.begin(),firCoeff.end());
+		assert(firCoeff->size() % M == 0);
+		coeff = firCoeff;
 
 		// The internal history buffer is sized according to the 
-		// number of coefficients
-		history.resize(firCoeff.size()-1);
+		// number of coefficients. Each sample is stored twice
+		history.resize(2 * coeff->size());
 		// bit growth due to coefficient  and number of taps
 		double sumMagnitude = 0;
-		for (size_t index = 0; index < coeff.size(); ++index)
-			sumMagnitude += abs(coeff[index]);
+		for (size_t index = 0; index < coeff->size(); ++index)
+			sumMagnitude += abs((*coeff)[index]);
 		coeffScaling = static_cast<int>(floor(log2(sumMagnitude)));
 		leftShift = 0;
+		symmetry = dsptl_private::selectSymmetry<InternalType, InType>(*coeff);
+		reset();
 	}
 
 	/*-----------------------------------------------------------------------------
@@ -142,12 +203,7 @@ namespace dsptl
 
 	The algorithm computes a convolution sum every M samples where M is the decimation
 	ratio.\n
-	An internal buffer keeps the N-1 last samples from the previous call. \n
-	No copy of the input samples is made except for the last N-1.\n
-
-	The algorithm performs well as long as the number of input samples to process is
-	large compared to the number of coefficients of the filter.\n
-
+	See stepStream() for the details of the algorithm.\n
 
 	The user must make sure that the internal type is large enough to contain the
 	accumulated sum of the convolution operation\n
@@ -180,43 +236,130 @@ namespace dsptl
 		// There should be M times more samples at the input than the output
 		assert(filteredSignal.size() * M == input.size());
 
+		step(input.data(), input.size(), filteredSignal.data());
+	}
+
+	/*-----------------------------------------------------------------------------
+	Downsampling FIR Filter
+
+	Version of step() which filters a range of samples without any copy, for example
+	part of a larger capture buffer.\n
+	The same constraints apply: inputSize must be a multiple of M and the output
+	must have room for inputSize / M samples.
+
+	@param input First sample of the input of the filter
+	@param inputSize Number of input samples
+	@param filteredSignal Output of the filter
+
+	------------------------------------------------------------------------------*/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
+	void FilterDnsamplingFir<InType, OutType, InternalType, CoefType, M>::step
+	(
+		const InType *input,
+		size_t inputSize,
+		OutType *filteredSignal
+	)
+	{
+		assert(inputSize % M == 0);
+		size_t numOut = stepStream(input, inputSize, filteredSignal);
+		// Only true if the previous calls were made with multiples of M samples
+		assert(numOut * M == inputSize);
+		(void)numOut;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Streaming Downsampling FIR Filter
+
+	Filters a block of any size. The decimation phase is maintained from one call
+	to the other so that the sequence of outputs is the same as if the whole stream
+	was filtered at once, whatever the way it is split into blocks. An output is
+	computed for each input sample whose position in the stream (counted from the
+	last reset) is a multiple of M.\n
+
+	Each input sample is written twice in the history buffer, at top and at top + N,
+	so that the last N samples are always contiguous from top, the most recent sample
+	first. The convolution sum is then a plain inner product with the coefficients,
+	whatever the number of samples of the current block.\n
+
+	@param input First sample of the input of the filter
+	@param inputSize Number of input samples. Can be any value including 0
+	@param filteredSignal Output of the filter. Must have room for
+	(inputSize + M - 1) / M samples. It can be the same location as the input.
+
+	@return Number of samples written to filteredSignal
+
+	------------------------------------------------------------------------------*/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
+	size_t FilterDnsamplingFir<InType, OutType, InternalType, CoefType, M>::stepStream
+	(
+		const InType *input,
+		size_t inputSize,
+		OutType *filteredSignal
+	)
+	{
+		assert(!coeff->empty());
+
 		InternalType y;  				// Output result
-		int N = coeff.size();	// Number of taps in the filter
-		int inputSize = input.size();	// Number of input samples
-		int outIndex;
-		
-		for(int j = 0; j < inputSize ; j+= M)
+		size_t N = coeff->size();		// Number of taps in the filter
+		size_t outIndex = 0;
+		const CoefType *c = coeff->data();
+
+		for (size_t j = 0; j < inputSize; ++j)
 		{
-			// This loop is executed for each M of the input samples
-			y = InternalType{};
-			outIndex = j / M;
-			// Two scenarios must be considered
-			// A: need for history data
-			// B: no need for history data
-		
-			// The sample location is within the N-1 first samples
-			if( j < N-1)
+			history[top] = input[j];
+			history[top + N] = input[j];
+			const InType *window = &history[top];
+			bool compute = (phase == 0);
+
+			// The sample is consumed before the output is written since the
+			// filtering can be made in place
+			top = (top == 0) ? N - 1 : top - 1;
+			phase = (phase + 1 == M) ? 0 : phase + 1;
+			if (!compute)
+				continue;
+
+			if (symmetry != dsptl_private::CoeffSymmetry::none)
 			{
-				// History is needed
-				for(int k = 0; k <= j; ++k)
-					y += coeff[k] * input[j - k];
-				for(int k = j+1 , p = 0; k < N ; ++k, ++p)
-					y += coeff[k] * history[N -2 -p];
+				// The samples multiplied by the same coefficient are added (or
+				// subtracted) first
+				y = dsptl_private::foldedInnerProduct<InternalType>(c, window, N, symmetry);
 			}
 			else
 			{
-				// History is not needed
-				for(int k = 0; k < N; ++k)
-					y += coeff[k] * input[j - k];
-			}		
+				dsptl_private::innerProduct(y, c, window, N);
+			}
 			// copy the result to its destination
 			// By default, the data is scaled to provide a gain of about 0 dB
 			// A non zero value of leftShift increases the gain by 2^leftShift
-			filteredSignal[outIndex++] = limitScale16(y, coeffScaling - leftShift);
+			// Floating point results are not scaled
+			filteredSignal[outIndex++] = dsptl_private::outputScale16<OutType>(y, coeffScaling - leftShift);
 		}
-		// We copy N-1 samples of historical data for the next iteration
-		for (int k = 0; k < N - 1; ++k)
-			history[k] = input[inputSize - N + 1 +k];
+		return outIndex;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Streaming Downsampling FIR Filter
+
+	Version of stepStream() with vectors. The output vector is resized to the number
+	of samples which are ready.
+
+	@param input Input to the filter. Any size
+	@param filteredSignal Output of the filter
+
+	@return Number of output samples
+
+	------------------------------------------------------------------------------*/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
+	size_t FilterDnsamplingFir<InType, OutType, InternalType, CoefType, M>::stepStream
+	(
+		const std::vector<InType> & input,
+		std::vector<OutType> & filteredSignal
+	)
+	{
+		filteredSignal.resize((input.size() + M - 1) / M);
+		size_t numOut = stepStream(input.data(), input.size(), filteredSignal.data());
+		filteredSignal.resize(numOut);
+		return numOut;
 	}
 
 
@@ -0,0 +1,94 @@
+#include "dsptl_dnsampling_filters.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+typedef std::complex<int16_t> Sample;
+
+std::vector<int32_t> decimationTaps(size_t numTaps, dsptl_private::CoeffSymmetry symmetry);
+template<unsigned M, class InType, class InternalType, class CoefType>
+bool testStepStream(const char *name, const std::vector<CoefType> &coeff, const std::vector<InType> &input);
+
+int main()
+{
+	srand(1);
+	using dsptl_private::CoeffSymmetry;
+
+	std::vector<Sample> input(2400);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = Sample(static_cast<int16_t>(rand() % 60001 - 30000), static_cast<int16_t>(rand() % 60001 - 30000));
+	std::vector<std::complex<float> > floatInput(input.size());
+	for (size_t n = 0; n < input.size(); ++n)
+		floatInput[n] = std::complex<float>(input[n].real(), input[n].imag()) / 32768.0f;
+	std::vector<float> floatCoeff(48);
+	for (size_t k = 0; k < floatCoeff.size(); ++k)
+		floatCoeff[k] = static_cast<float>(rand() % 2001 - 1000) / 24000;
+
+	bool passed = testStepStream<2, Sample, std::complex<int32_t> >("32 taps", decimationTaps(32, CoeffSymmetry::none), input);
+	passed = testStepStream<3, Sample, std::complex<int32_t> >("33 symmetric taps", decimationTaps(33, CoeffSymmetry::symmetric), input) && passed;
+	passed = testStepStream<4, Sample, std::complex<int32_t> >("64 antisymmetric taps", decimationTaps(64, CoeffSymmetry::antisymmetric), input) && passed;
+	passed = testStepStream<8, Sample, std::complex<int32_t> >("8 taps", decimationTaps(8, CoeffSymmetry::none), input) && passed;
+	passed = testStepStream<5, Sample, std::complex<int32_t> >("100 symmetric taps", decimationTaps(100, CoeffSymmetry::symmetric), input) && passed;
+	passed = testStepStream<3, std::complex<float>, std::complex<float> >("48 taps, float", floatCoeff, floatInput) && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Random coefficients with a sum of magnitudes below 2^16 and the requested
+symmetry. The middle coefficient of an odd length antisymmetric set is zero.
+------------------------------------------------------------------------------*/
+std::vector<int32_t> decimationTaps(size_t numTaps, dsptl_private::CoeffSymmetry symmetry)
+{
+	int32_t largest = static_cast<int32_t>(65000 / numTaps);
+	std::vector<int32_t> coeff(numTaps);
+	for (size_t n = 0; n < numTaps; ++n)
+		coeff[n] = rand() % (largest + largest / 2) - largest / 2;
+	for (size_t n = 0; n < numTaps / 2 && symmetry != dsptl_private::CoeffSymmetry::none; ++n)
+		coeff[numTaps - 1 - n] = (symmetry == dsptl_private::CoeffSymmetry::symmetric) ? coeff[n] : -coeff[n];
+	if (numTaps % 2 != 0 && symmetry == dsptl_private::CoeffSymmetry::antisymmetric)
+		coeff[numTaps / 2] = 0;
+	return coeff;
+}
+
+/*-----------------------------------------------------------------------------
+FilterDnsamplingFir::stepStream() must give the output of a single call to
+step() on the whole input, whatever the way the input is split: empty blocks,
+blocks shorter than M, blocks shorter than the filter and blocks longer than it.
+------------------------------------------------------------------------------*/
+template<unsigned M, class InType, class InternalType, class CoefType>
+bool testStepStream(const char *name, const std::vector<CoefType> &coeff, const std::vector<InType> &input)
+{
+	typedef dsptl::FilterDnsamplingFir<InType, InType, InternalType, CoefType, M> Filter;
+	assert(input.size() % M == 0);
+
+	Filter reference(coeff);
+	std::vector<InType> expected(input.size() / M);
+	reference.step(input, expected);
+
+	const size_t blockSizes[] = { 0, 1, M - 1, M + 1, coeff.size() - 1, 0, coeff.size() + 1, 2 * coeff.size() + 3 };
+	Filter filter(coeff);
+	std::vector<InType> output(expected.size());
+	size_t numOut = 0;
+	size_t b = 0;
+	for (size_t start = 0; start < input.size(); ++b)
+	{
+		size_t blockSize = (b < sizeof(blockSizes) / sizeof(blockSizes[0])) ? blockSizes[b] : rand() % (coeff.size() + 2);
+		blockSize = std::min(blockSize, input.size() - start);
+		numOut += filter.stepStream(&input[start], blockSize, output.data() + numOut);
+		start += blockSize;
+	}
+
+	size_t numErrors = (numOut == expected.size()) ? 0 : 1;
+	for (size_t m = 0; m < numOut && m < expected.size(); ++m)
+		numErrors += (output[m] != expected[m]) ? 1 : 0;
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FilterDnsamplingFir M " << M << ", " << name << ": " << numErrors
+		<< " differences with a single call to step(): " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
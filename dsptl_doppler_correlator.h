@@ -0,0 +1,328 @@
+/***********************************************************************//**
+@file
+
+Frequency by time correlation search for bursts received with a Doppler offset.\n
+
+A frequency offset rotates the phase of the received pattern along its duration:
+beyond about half a turn over the pattern, the coherent correlation of
+FixedPatternCorrelator collapses. The search splits the pattern into K segments
+whose partial correlations are computed once per sample on a single history. Each
+frequency hypothesis then only recombines the K partial correlations after
+removing the phase rotation expected at the centre of each segment.
+
+***************************************************************************/
+
+#ifndef DSPTL_DOPPLER_CORRELATOR_H
+#define DSPTL_DOPPLER_CORRELATOR_H
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <complex>
+#include <array>
+#include <vector>
+#include <type_traits>
+#include "correlators.h"
+#include "constants.h"
+
+namespace dsptl
+{
+
+	/// Result of a Doppler correlation search
+	struct DopplerPeak
+	{
+		int lag;			///< Index in the input of the last sample of the matching window
+		size_t bin;			///< Frequency bin of the best correlation
+		double frequency;	///< Frequency estimate, in cycles per input sample
+		double metric;		///< Normalized correlation |C|^2 / (pattern energy * window energy), between 0 and 1
+	};
+
+	/*-----------------------------------------------------------------------------
+	Search of a fixed pattern over a set of frequency hypotheses
+
+	The pattern of N points, taken every S input samples as in FixedPatternCorrelator,
+	is split into K segments of N / K points. For each input sample, the K partial
+	correlations are computed in integer arithmetic on the last N samples of the phase
+	of the sample (with the vectorized kernel for int16_t inputs and int32_t
+	computations). For the frequency bin f, of frequency v, the correlation is
+
+	C = sum over k of P_k exp(-j 2 pi v t_k)
+
+	where t_k is the time of the centre of segment k relative to the last sample. The F
+	bins are evenly spaced between -maxDoppler and +maxDoppler.\n
+
+	search() keeps the lag and the bin of largest normalized correlation over the whole
+	input. The frequency estimate refines the bin by a parabolic interpolation of |C|
+	over the neighbouring bins at this lag.\n
+
+	The history and the energy of the windows are kept from one call to the other, so
+	that a burst can straddle two calls. As in FixedPatternCorrelator, the inputs
+	should not exceed 14 bits and the pattern 13 bits.
+
+	@tparam InType Data type of the input signal
+	@tparam CompType Internal computation type of the partial correlations
+	@tparam N Number of points of the correlation pattern
+	@tparam S Stride used to scan the input vector
+	@tparam K Number of segments. Must divide N
+
+	------------------------------------------------------------------------------*/
+	template<class InType = int16_t, class CompType = int32_t, size_t N = 32, size_t S = 4, size_t K = 4 >
+	class DopplerCorrelator
+	{
+		static_assert(K > 0 && N % K == 0, "The number of segments must divide the length of the pattern");
+
+	public:
+		DopplerCorrelator(size_t numBins, double maxDoppler, double threshold = 0.5);
+		void setPattern(const std::array<std::complex<CompType>, N > &in);
+		bool search(const std::vector <std::complex<InType> > &in, DopplerPeak &peak);
+		bool search(const std::complex<InType> *in, size_t size, DopplerPeak &peak);
+		void reset();
+		/// Number of frequency bins F
+		size_t getNumBins() const { return numBins; }
+		/// Frequency of a bin, in cycles per input sample
+		double getBinFrequency(size_t bin) const { return binFrequency[bin]; }
+		/// Minimum normalized correlation reported by search()
+		void setThreshold(double threshold) { minMetric = threshold; }
+
+	private:
+		/// Number of points of each segment
+		static const size_t segmentLength = N / K;
+
+		/// Indicates if the vectorized inner products can be used with these types
+		typedef std::integral_constant<bool, std::is_same<InType, int16_t>::value
+			&& std::is_same<CompType, int32_t>::value> SimdEligible;
+
+		// Partial correlations of the K segments with the N samples of a phase
+		void partialCorrelations(const std::complex<InType> *window, std::true_type);
+		void partialCorrelations(const std::complex<InType> *window, std::false_type);
+
+		size_t numBins;
+		std::vector<double> binFrequency;				///< Frequency of each bin
+		std::vector<std::complex<double> > rotation;	///< exp(-j 2 pi v t_k) of bin f and segment k at f * K + k
+		double minMetric;								///< Threshold on the normalized correlation
+		double patternEnergy;							///< Energy of the pattern
+
+		/// Phase buffers of 2N samples. Phase p starts at p * 2N
+		std::array < std::complex<InType>, 2*N*S> history;
+		std::array < std::complex<CompType>, N > coeffs;
+		/// Coefficients as the pairs of 16 bits values used by dotComplexByComplex16()
+		std::array < int16_t, 2*N > coeffsRe;
+		std::array < int16_t, 2*N > coeffsIm;
+		bool useSimd;									///< True if the vectorized inner products are used
+		std::array < uint64_t, S > phaseEnergy;			///< Energy of the last N samples of each phase
+		size_t top;
+		std::array < std::complex<CompType>, K > partial;	///< Partial correlations of the current sample
+		std::vector<double> magnitude;					///< |C| of each bin for the current sample
+		std::vector<double> bestMagnitude;				///< |C| of each bin at the best lag
+	};
+
+
+	/*-----------------------------------------------------------------------------
+	Constructor
+
+	@param numBins Number of frequency bins F
+	@param maxDoppler Largest frequency offset searched, in cycles per input sample.
+	The spacing of the bins should not exceed about 1 / (2 N S)
+	@param threshold Minimum normalized correlation reported by search()
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t K >
+	DopplerCorrelator<InType, CompType, N, S, K >::DopplerCorrelator(size_t numBins, double maxDoppler, double threshold)
+		: numBins(numBins), binFrequency(numBins), rotation(numBins * K), minMetric(threshold), patternEnergy(0),
+		useSimd(false), top(0), magnitude(numBins), bestMagnitude(numBins)
+	{
+		assert(numBins > 0);
+		for (size_t f = 0; f < numBins; ++f)
+		{
+			binFrequency[f] = (numBins > 1) ? -maxDoppler + 2 * maxDoppler * f / (numBins - 1) : 0;
+			for (size_t k = 0; k < K; ++k)
+			{
+				// Centre of the segment, in input samples before the last one
+				double centre = (N - 1 - (k * segmentLength + (segmentLength - 1) / 2.0)) * S;
+				double angle = 2 * pi * binFrequency[f] * centre;
+				rotation[f * K + k] = std::complex<double>(cos(angle), sin(angle));
+			}
+		}
+		reset();
+	}
+
+	/*-----------------------------------------------------------------------------
+	Reset the history of the correlator
+
+	The pattern and the frequency bins are not modified
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t K >
+	void DopplerCorrelator<InType, CompType, N, S, K >::reset()
+	{
+		top = 0;
+		for (size_t k = 0; k < history.size(); ++k)
+			history[k] = {};
+		for (size_t k = 0; k < S; ++k)
+			phaseEnergy[k] = 0;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Copy locally the pattern. See FixedPatternCorrelator::setPattern()
+
+	@param[in] in Correlation pattern, as a replica of the desired signal
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t K >
+	void DopplerCorrelator<InType, CompType, N, S, K >::setPattern(const std::array<std::complex<CompType>, N > &in)
+	{
+		CorrelatorState state;
+		dsptl_private::setCorrelatorPattern(in, coeffs, state, 0);
+		patternEnergy = state.coeffsEnergy;
+
+		// Pairs used by the vectorized inner products. See dotComplexByComplex16()
+		useSimd = SimdEligible::value;
+		for (size_t index = 0; index < N; ++index)
+		{
+			CompType re = coeffs[index].real();
+			CompType im = coeffs[index].imag();
+			// -im must also fit in 16 bits
+			if (re > INT16_MAX || re < INT16_MIN || im > INT16_MAX || im <= INT16_MIN)
+				useSimd = false;
+			coeffsRe[2 * index] = static_cast<int16_t>(re);
+			coeffsRe[2 * index + 1] = static_cast<int16_t>(-im);
+			coeffsIm[2 * index] = static_cast<int16_t>(im);
+			coeffsIm[2 * index + 1] = static_cast<int16_t>(re);
+		}
+	}
+
+	/*-----------------------------------------------------------------------------
+	Search the pattern in a block of samples over all the frequency bins
+
+	@param[in] in Samples to search
+	@param[out] peak Best lag, bin and frequency. Only valid if the function returned true
+
+	@return true if the best normalized correlation exceeds the threshold
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t K >
+	bool DopplerCorrelator<InType, CompType, N, S, K >::search(const std::vector < std::complex<InType> > &in, DopplerPeak &peak)
+	{
+		return search(in.data(), in.size(), peak);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Version of search() working on a range of samples without any copy
+
+	@param[in] in First sample to search
+	@param[in] size Number of samples
+	@param[out] peak Best lag, bin and frequency. Only valid if the function returned true
+
+	@return true if the best normalized correlation exceeds the threshold
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S, size_t K >
+	bool DopplerCorrelator<InType, CompType, N, S, K >::search(const std::complex<InType> *in, size_t size, DopplerPeak &peak)
+	{
+		assert(patternEnergy > 0);
+		const size_t historySize = N * S;
+		double bestMetric = -1;
+
+		for (size_t index = 0; index < size; ++index)
+		{
+			// Each element is copied twice into the buffer of its phase. The energy
+			// of the phase is updated with the sample it replaces
+			size_t pos = top / S;
+			std::complex<InType> *buffer = &history[2 * N * (top % S)];
+			uint64_t &phaseSum = phaseEnergy[top % S];
+			std::complex<int64_t> leaving(buffer[pos].real(), buffer[pos].imag());
+			std::complex<int64_t> entering(in[index].real(), in[index].imag());
+			phaseSum -= static_cast<uint64_t>(leaving.real() * leaving.real() + leaving.imag() * leaving.imag());
+			phaseSum += static_cast<uint64_t>(entering.real() * entering.real() + entering.imag() * entering.imag());
+			buffer[pos] = in[index];
+			buffer[pos + N] = in[index];
+			top = (top + 1 == historySize) ? 0 : top + 1;
+			if (phaseSum == 0)
+				continue;
+
+			// The last N samples of the phase start after the new one
+			partialCorrelations(buffer + pos + 1, SimdEligible());
+
+			double scale = 1.0 / (patternEnergy * static_cast<double>(phaseSum));
+			bool improved = false;
+			for (size_t f = 0; f < numBins; ++f)
+			{
+				const std::complex<double> *r = &rotation[f * K];
+				std::complex<double> corr;
+				for (size_t k = 0; k < K; ++k)
+					corr += std::complex<double>(partial[k].real(), partial[k].imag()) * r[k];
+				double metric = std::norm(corr) * scale;
+				magnitude[f] = std::abs(corr);
+				if (metric > bestMetric)
+				{
+					bestMetric = metric;
+					peak.lag = static_cast<int>(index);
+					peak.bin = f;
+					peak.metric = metric;
+					improved = true;
+				}
+			}
+			if (improved)
+				bestMagnitude = magnitude;
+		}
+
+		if (bestMetric < minMetric)
+			return false;
+
+		// Parabolic interpolation of the magnitude over the neighbouring bins
+		size_t f = peak.bin;
+		peak.frequency = binFrequency[f];
+		if (f > 0 && f + 1 < numBins)
+		{
+			double left = bestMagnitude[f - 1];
+			double centre = bestMagnitude[f];
+			double right = bestMagnitude[f + 1];
+			double denominator = left - 2 * centre + right;
+			if (denominator < 0)
+			{
+				double delta = 0.5 * (left - right) / denominator;
+				peak.frequency += delta * (binFrequency[f + 1] - binFrequency[f]);
+			}
+		}
+		return true;
+	}
+
+	/**************************************************************************//**
+	Partial correlations of the K segments with the N samples of a phase, the
+	oldest first. Vectorized version for int16_t samples and int32_t computations.
+
+	******************************************************************************/
+	template<class InType, class CompType, size_t N, size_t S, size_t K >
+	void DopplerCorrelator<InType, CompType, N, S, K >::partialCorrelations(const std::complex<InType> *window, std::true_type)
+	{
+		if (!useSimd)
+		{
+			partialCorrelations(window, std::false_type());
+			return;
+		}
+		const int16_t *samples = reinterpret_cast<const int16_t *>(window);
+		for (size_t k = 0; k < K; ++k)
+		{
+			int32_t re, im;
+			size_t offset = 2 * k * segmentLength;
+			dsptl_private::dotComplexByComplex16(samples + offset, coeffsRe.data() + offset, coeffsIm.data() + offset,
+				segmentLength, re, im);
+			partial[k] = std::complex<CompType>(re, im);
+		}
+	}
+
+	/**************************************************************************//**
+	Partial correlations of the K segments with the N samples of a phase, the
+	oldest first. Generic version.
+
+	******************************************************************************/
+	template<class InType, class CompType, size_t N, size_t S, size_t K >
+	void DopplerCorrelator<InType, CompType, N, S, K >::partialCorrelations(const std::complex<InType> *window, std::false_type)
+	{
+		for (size_t k = 0; k < K; ++k)
+		{
+			std::complex<CompType> tmp{};
+			for (size_t n = k * segmentLength; n < (k + 1) * segmentLength; ++n)
+				tmp += std::complex<CompType>(window[n]) * coeffs[n];
+			partial[k] = tmp;
+		}
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,281 @@
+/***********************************************************************//**
+@file
+
+Arbitrary ratio resampler based on the Farrow structure.\n
+
+The resampling ratio can be changed at any time, for example to track a Doppler
+shift or the drift of a clock. The cost per output sample does not depend on
+the ratio.
+
+***************************************************************************/
+
+#ifndef DSPTL_FARROW_RESAMPLER_H
+#define DSPTL_FARROW_RESAMPLER_H
+
+#include <cassert>
+#include <cstdint>
+#include <complex>
+#include <vector>
+#include <cmath>
+
+namespace dsptl_private
+{
+	/// Type of the fractional delay used with samples of type T
+	template<class T>
+	struct FarrowScalar
+	{
+		typedef T type;
+	};
+
+	template<class T>
+	struct FarrowScalar<std::complex<T> >
+	{
+		typedef T type;
+	};
+}
+
+namespace dsptl
+{
+
+	// BASE CLASS
+
+	/*-----------------------------------------------------------------------------
+	Base class for the implementation of the Farrow resamplers
+
+	The position of the next output between two input samples is maintained as
+	a 32 bits fraction of the input sampling period. The resampling increment is
+	a 32.32 fixed point value: the number of input periods between two outputs.\n
+
+	Each input sample shifts the 4 samples window x[n-1], x[n], x[n+1], x[n+2].
+	All the outputs located between x[n] and x[n+1] are then computed, which is
+	when the position is smaller than one input period.
+
+	------------------------------------------------------------------------------*/
+	class _FarrowResampler
+	{
+	public:
+		_FarrowResampler() : position(0), increment(oneSample) {}
+		/// Set the resampling ratio (output rate / input rate). No allocation is
+		/// performed so the ratio can be changed between any two blocks
+		void setRatio(double ratio)
+		{
+			assert(ratio > 0);
+			increment = static_cast<uint64_t>(llround(static_cast<double>(oneSample) / ratio));
+			assert(increment > 0);
+		}
+		/// Return the resampling ratio (output rate / input rate)
+		double getRatio() const { return static_cast<double>(oneSample) / static_cast<double>(increment); }
+		/// Maximum number of outputs produced for inputSize input samples
+		size_t getMaxOutputSize(size_t inputSize) const
+		{
+			return static_cast<size_t>((inputSize * static_cast<double>(oneSample)) / static_cast<double>(increment)) + 1;
+		}
+	protected:
+		static const uint64_t oneSample = static_cast<uint64_t>(1) << 32;	///< One input sampling period
+		uint64_t position;	///< Position of the next output after x[n], in 1/2^32 of a period
+		uint64_t increment;	///< Distance between two outputs, in 1/2^32 of an input period
+	};
+
+
+	//  DERIVED CLASS AND SPECIALIZATION
+
+	/*-----------------------------------------------------------------------------
+	Farrow resampler with a cubic (Catmull-Rom) interpolation
+
+	@tparam T Type of the samples. float, double, std::complex<float> or
+	std::complex<double>. A specialization exists for std::complex<int16_t>
+
+	The output between x[n] and x[n+1] at the fractional position mu is the
+	polynomial ((c3 mu + c2) mu + c1) mu + c0 evaluated with the Horner scheme. The
+	coefficients of the polynomial are computed once per input sample, multiplied
+	by 2 so that they only involve integer factors:
+	@arg 2 c0 = 2 x[n]
+	@arg 2 c1 = x[n+1] - x[n-1]
+	@arg 2 c2 = 2 x[n-1] - 5 x[n] + 4 x[n+1] - x[n+2]
+	@arg 2 c3 = x[n+2] - x[n-1] + 3 (x[n] - x[n+1])
+
+	The outputs are delayed by 2 input samples.
+
+	------------------------------------------------------------------------------*/
+	template<class T>
+	class FarrowResampler : public _FarrowResampler
+	{
+	public:
+		FarrowResampler(double ratio = 1.0) { setRatio(ratio); reset(); }
+		// Resample a block of any size and return the number of outputs
+		size_t step(const T *input, size_t inputSize, T *output);
+		// Version of step with vectors. The output is resized
+		size_t step(const std::vector<T> & input, std::vector<T> & output);
+		/// Reset the history and the position of the next output
+		void reset()
+		{
+			position = 0;
+			for (size_t k = 0; k < 4; ++k)
+				window[k] = T();
+		}
+	private:
+		T window[4];	///< x[n-1], x[n], x[n+1], x[n+2]
+	};
+
+	/*-----------------------------------------------------------------------------
+	Resample a block of samples
+
+	@param input First input sample
+	@param inputSize Number of input samples. Can be any value
+	@param output Resampled signal. Must have room for getMaxOutputSize(inputSize)
+	samples and must not overlap the input
+
+	@return Number of samples written to output
+	------------------------------------------------------------------------------*/
+	template<class T>
+	size_t FarrowResampler<T>::step(const T *input, size_t inputSize, T *output)
+	{
+		typedef typename dsptl_private::FarrowScalar<T>::type Scalar;
+		const Scalar scale = static_cast<Scalar>(1.0 / static_cast<double>(oneSample));
+		size_t outIndex = 0;
+
+		for (size_t j = 0; j < inputSize; ++j)
+		{
+			window[0] = window[1];
+			window[1] = window[2];
+			window[2] = window[3];
+			window[3] = input[j];
+
+			T c0 = Scalar(2) * window[1];
+			T c1 = window[2] - window[0];
+			T c2 = Scalar(2) * window[0] - Scalar(5) * window[1] + Scalar(4) * window[2] - window[3];
+			T c3 = window[3] - window[0] + Scalar(3) * (window[1] - window[2]);
+
+			for (; position < oneSample; position += increment)
+			{
+				Scalar mu = static_cast<Scalar>(position) * scale;
+				output[outIndex++] = Scalar(0.5) * (((c3 * mu + c2) * mu + c1) * mu + c0);
+			}
+			position -= oneSample;
+		}
+		return outIndex;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Version of step() with vectors. The output vector is resized to the number of
+	samples produced.
+
+	------------------------------------------------------------------------------*/
+	template<class T>
+	size_t FarrowResampler<T>::step(const std::vector<T> & input, std::vector<T> & output)
+	{
+		output.resize(getMaxOutputSize(input.size()));
+		size_t numOut = step(input.data(), input.size(), output.data());
+		output.resize(numOut);
+		return numOut;
+	}
+
+
+	/*-----------------------------------------------------------------------------
+	Farrow resampler Specialization
+
+	Input and output are complex 16 bits. The fractional position is a Q31 value
+	and the Horner scheme is computed with 64 bits products. The intermediate
+	values keep 10 fractional bits, so that the only significant error is the final
+	rounding: the output is within 1 LSB of the floating point version. The output
+	is saturated since the cubic interpolation can overshoot full scale signals.
+
+	------------------------------------------------------------------------------*/
+	template<>
+	class FarrowResampler<std::complex<int16_t> > : public _FarrowResampler
+	{
+	public:
+		FarrowResampler(double ratio = 1.0) { setRatio(ratio); reset(); }
+		// Resample a block of any size and return the number of outputs
+		size_t step(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output);
+		// Version of step with vectors. The output is resized
+		size_t step(const std::vector<std::complex<int16_t> > & input, std::vector<std::complex<int16_t> > & output)
+		{
+			output.resize(getMaxOutputSize(input.size()));
+			size_t numOut = step(input.data(), input.size(), output.data());
+			output.resize(numOut);
+			return numOut;
+		}
+		/// Reset the history and the position of the next output
+		void reset()
+		{
+			position = 0;
+			for (size_t k = 0; k < 4; ++k)
+				re[k] = im[k] = 0;
+		}
+	private:
+		/// Horner evaluation of the polynomial multiplied by 2 at the Q31 position
+		/// mu, then saturation of the halved value to 16 bits. The coefficients are
+		/// below 2^19 and the intermediate values below 2^30 with their fractional
+		/// bits, so that the products fit in 64 bits
+		static int16_t evaluate(const int32_t *c, int64_t mu)
+		{
+			const int fractionBits = 10;
+			const int64_t one = static_cast<int64_t>(1) << fractionBits;
+			const int64_t half = static_cast<int64_t>(1) << 30;
+			int64_t acc = c[3] * one;
+			acc = ((acc * mu + half) >> 31) + c[2] * one;
+			acc = ((acc * mu + half) >> 31) + c[1] * one;
+			acc = ((acc * mu + half) >> 31) + c[0] * one;
+			acc = (acc + one) >> (fractionBits + 1);
+			if (acc > INT16_MAX)
+				acc = INT16_MAX;
+			else if (acc < INT16_MIN)
+				acc = INT16_MIN;
+			return static_cast<int16_t>(acc);
+		}
+		/// Coefficients of the polynomial multiplied by 2 for one component
+		static void coefficients(const int32_t *x, int32_t *c)
+		{
+			c[0] = 2 * x[1];
+			c[1] = x[2] - x[0];
+			c[2] = 2 * x[0] - 5 * x[1] + 4 * x[2] - x[3];
+			c[3] = x[3] - x[0] + 3 * (x[1] - x[2]);
+		}
+
+		int32_t re[4];	///< Real parts of x[n-1], x[n], x[n+1], x[n+2]
+		int32_t im[4];	///< Imaginary parts of x[n-1], x[n], x[n+1], x[n+2]
+	};
+
+	/*-----------------------------------------------------------------------------
+	Resample a block of complex 16 bits samples
+
+	@param input First input sample
+	@param inputSize Number of input samples. Can be any value
+	@param output Resampled signal. Must have room for getMaxOutputSize(inputSize)
+	samples and must not overlap the input
+
+	@return Number of samples written to output
+	------------------------------------------------------------------------------*/
+	inline size_t FarrowResampler<std::complex<int16_t> >::step(const std::complex<int16_t> *input, size_t inputSize, std::complex<int16_t> *output)
+	{
+		size_t outIndex = 0;
+		int32_t cRe[4];
+		int32_t cIm[4];
+
+		for (size_t j = 0; j < inputSize; ++j)
+		{
+			for (size_t k = 0; k < 3; ++k)
+			{
+				re[k] = re[k + 1];
+				im[k] = im[k + 1];
+			}
+			re[3] = input[j].real();
+			im[3] = input[j].imag();
+			coefficients(re, cRe);
+			coefficients(im, cIm);
+
+			for (; position < oneSample; position += increment)
+			{
+				// Q31 fractional position
+				int64_t mu = static_cast<int64_t>(position >> 1);
+				output[outIndex++] = std::complex<int16_t>(evaluate(cRe, mu), evaluate(cIm, mu));
+			}
+			position -= oneSample;
+		}
+		return outIndex;
+	}
+
+} // End of namespace
+
+#endif
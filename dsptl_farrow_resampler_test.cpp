@@ -0,0 +1,129 @@
+#include "dsptl_farrow_resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+typedef std::complex<int16_t> Sample;
+
+template<class T>
+bool testUnitRatio(const char *name);
+bool testInt16Accuracy(double ratio, bool fullScale);
+
+int main()
+{
+	srand(1);
+	bool passed = testUnitRatio<float>("float");
+	passed = testUnitRatio<double>("double") && passed;
+	passed = testUnitRatio<std::complex<float> >("complex float") && passed;
+	passed = testUnitRatio<std::complex<double> >("complex double") && passed;
+	passed = testUnitRatio<Sample>("complex int16_t") && passed;
+
+	const double ratios[] = { 0.37, 0.9, 1.1, 2.7 };
+	for (double ratio : ratios)
+	{
+		passed = testInt16Accuracy(ratio, false) && passed;
+		passed = testInt16Accuracy(ratio, true) && passed;
+	}
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Random sample of each type, exactly representable by all of them
+------------------------------------------------------------------------------*/
+template<class T>
+void randomSample(T &x)
+{
+	x = static_cast<T>(rand() % 60001 - 30000);
+}
+
+template<class T>
+void randomSample(std::complex<T> &x)
+{
+	x = std::complex<T>(static_cast<T>(rand() % 60001 - 30000), static_cast<T>(rand() % 60001 - 30000));
+}
+
+/*-----------------------------------------------------------------------------
+With a ratio of 1, every output is at the fractional position 0: the output is
+the input delayed by 2 samples, the first 2 outputs being zero. The input is
+split in blocks of arbitrary sizes.
+------------------------------------------------------------------------------*/
+template<class T>
+bool testUnitRatio(const char *name)
+{
+	std::vector<T> input(1000);
+	for (size_t n = 0; n < input.size(); ++n)
+		randomSample(input[n]);
+
+	dsptl::FarrowResampler<T> resampler(1.0);
+	std::vector<T> output(resampler.getMaxOutputSize(input.size()));
+	size_t numOut = 0;
+	for (size_t start = 0; start < input.size(); )
+	{
+		size_t blockSize = std::min<size_t>(rand() % 12, input.size() - start);
+		numOut += resampler.step(&input[start], blockSize, output.data() + numOut);
+		start += blockSize;
+	}
+
+	size_t numErrors = (numOut == input.size()) ? 0 : 1;
+	for (size_t n = 0; n < numOut && n < input.size(); ++n)
+		numErrors += (output[n] != (n < 2 ? T() : input[n - 2])) ? 1 : 0;
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FarrowResampler " << name << ", ratio 1: " << numErrors << " differences with the input delayed by 2 samples: "
+		<< (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+The complex 16 bits specialization must stay within 1 LSB of the double precision
+version, saturated to 16 bits, for ratios above and below 1. The input is either a
+pair of sines or full scale noise, for which the interpolation overshoots and the
+output saturates. The input of the fixed point resampler is split in blocks of
+arbitrary sizes.
+------------------------------------------------------------------------------*/
+bool testInt16Accuracy(double ratio, bool fullScale)
+{
+	std::vector<Sample> input(3000);
+	for (size_t n = 0; n < input.size(); ++n)
+	{
+		if (fullScale)
+			input[n] = Sample(static_cast<int16_t>(rand() % 65536 - 32768), static_cast<int16_t>(rand() % 65536 - 32768));
+		else
+			input[n] = Sample(static_cast<int16_t>(lround(20000 * cos(0.6 * n))), static_cast<int16_t>(lround(20000 * sin(0.13 * n))));
+	}
+	std::vector<std::complex<double> > reference(input.size());
+	for (size_t n = 0; n < input.size(); ++n)
+		reference[n] = std::complex<double>(input[n].real(), input[n].imag());
+
+	dsptl::FarrowResampler<std::complex<double> > referenceResampler(ratio);
+	std::vector<std::complex<double> > expected;
+	referenceResampler.step(reference, expected);
+
+	dsptl::FarrowResampler<Sample> resampler(ratio);
+	std::vector<Sample> output(resampler.getMaxOutputSize(input.size()));
+	size_t numOut = 0;
+	for (size_t start = 0; start < input.size(); )
+	{
+		size_t blockSize = std::min<size_t>(rand() % 12, input.size() - start);
+		numOut += resampler.step(&input[start], blockSize, output.data() + numOut);
+		start += blockSize;
+	}
+
+	double maxError = (numOut == expected.size()) ? 0 : 65536;
+	for (size_t n = 0; n < numOut && n < expected.size(); ++n)
+	{
+		double re = std::min(std::max(expected[n].real(), -32768.0), 32767.0);
+		double im = std::min(std::max(expected[n].imag(), -32768.0), 32767.0);
+		maxError = std::max(maxError, std::max(std::fabs(output[n].real() - re), std::fabs(output[n].imag() - im)));
+	}
+
+	bool passed = maxError <= 1;
+	std::cout << "+++++ FarrowResampler complex int16_t, ratio " << ratio << (fullScale ? ", full scale noise" : ", sines")
+		<< ": maximum error " << maxError << " LSB: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -0,0 +1,264 @@
+/***********************************************************************//**
+@file
+
+Fast Fourier Transform and FFT based fast convolution.
+
+***************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include "dsptl_fft.h"
+#include "constants.h"
+
+namespace
+{
+	/// Minimum number of taps for which the fast convolution is considered
+	const size_t minFftConvolutionTaps = 64;
+	/// Estimated cost of one point of one FFT stage relative to one multiply
+	/// accumulate of the direct form filter
+	const double fftCostFactor = 2.0;
+}
+
+namespace dsptl
+{
+
+	/**************************************************************************//**
+	Constructor
+
+	@param fftSize Number of points of the transform. Must be a power of 2. If zero,
+	setSize() must be called before the transform is used.
+	******************************************************************************/
+	Fft::Fft(size_t fftSize) : size(0), log2Size(0)
+	{
+		if (fftSize != 0)
+			setSize(fftSize);
+	}
+
+	/**************************************************************************//**
+	Change the size of the transform. The twiddle factors and the bit reversal
+	table are computed.
+
+	@param fftSize Number of points of the transform. Must be a power of 2.
+	******************************************************************************/
+	void Fft::setSize(size_t fftSize)
+	{
+		assert(fftSize > 0 && (fftSize & (fftSize - 1)) == 0);
+		if (fftSize == size)
+			return;
+		size = fftSize;
+		log2Size = 0;
+		while ((static_cast<size_t>(1) << log2Size) < size)
+			++log2Size;
+
+		twiddle.resize(size);
+		for (size_t k = 0; k < size; ++k)
+		{
+			double phase = -2 * pi * static_cast<double>(k) / static_cast<double>(size);
+			twiddle[k] = std::complex<double>(cos(phase), sin(phase));
+		}
+
+		bitReversed.resize(size);
+		for (size_t k = 0; k < size; ++k)
+		{
+			size_t r = 0;
+			for (unsigned b = 0; b < log2Size; ++b)
+				r |= ((k >> b) & 1) << (log2Size - 1 - b);
+			bitReversed[k] = r;
+		}
+	}
+
+	/**************************************************************************//**
+	Forward transform.
+
+	@param data getSize() complex values replaced by their transform
+	******************************************************************************/
+	void Fft::forward(std::complex<double> *data) const
+	{
+		transform(data, false);
+	}
+
+	/**************************************************************************//**
+	Inverse transform. The result is not divided by the size of the transform.
+
+	@param data getSize() complex values replaced by their transform
+	******************************************************************************/
+	void Fft::inverse(std::complex<double> *data) const
+	{
+		transform(data, true);
+	}
+
+	/**************************************************************************//**
+	Decimation in time transform.\n
+
+	The input is first reordered in bit reversed order. If the number of radix-2
+	stages is odd, a first radix-2 stage combines the samples in pairs. The
+	remaining stages are processed two at a time with radix-4 butterflies: each
+	butterfly combines 4 transforms of size h into one transform of size 4h.
+	******************************************************************************/
+	void Fft::transform(std::complex<double> *data, bool inverse) const
+	{
+		assert(size > 0);
+		for (size_t k = 0; k < size; ++k)
+		{
+			size_t r = bitReversed[k];
+			if (r > k)
+				std::swap(data[k], data[r]);
+		}
+
+		size_t h = 1;
+		if (log2Size % 2 != 0)
+		{
+			for (size_t k = 0; k < size; k += 2)
+			{
+				std::complex<double> a = data[k];
+				std::complex<double> b = data[k + 1];
+				data[k] = a + b;
+				data[k + 1] = a - b;
+			}
+			h = 2;
+		}
+
+		for (; 4 * h <= size; h *= 4)
+		{
+			size_t stride = size / (4 * h);
+			for (size_t base = 0; base < size; base += 4 * h)
+			{
+				for (size_t k = 0; k < h; ++k)
+				{
+					std::complex<double> w1 = twiddle[k * stride];
+					std::complex<double> w2 = twiddle[2 * k * stride];
+					std::complex<double> w3 = twiddle[3 * k * stride];
+					if (inverse)
+					{
+						w1 = std::conj(w1);
+						w2 = std::conj(w2);
+						w3 = std::conj(w3);
+					}
+					std::complex<double> *p = data + base + k;
+					std::complex<double> a = p[0];
+					std::complex<double> b = w2 * p[h];
+					std::complex<double> c = w1 * p[2 * h];
+					std::complex<double> d = w3 * p[3 * h];
+					std::complex<double> sumAb = a + b;
+					std::complex<double> difAb = a - b;
+					std::complex<double> sumCd = c + d;
+					// (c - d) multiplied by -j for the forward transform, +j for the inverse
+					std::complex<double> difCd = c - d;
+					std::complex<double> rotCd = inverse ? std::complex<double>(-difCd.imag(), difCd.real())
+						: std::complex<double>(difCd.imag(), -difCd.real());
+					p[0] = sumAb + sumCd;
+					p[h] = difAb + rotCd;
+					p[2 * h] = sumAb - sumCd;
+					p[3 * h] = difAb - rotCd;
+				}
+			}
+		}
+	}
+
+	/**************************************************************************//**
+	Set a real kernel. See setKernel(const std::vector<std::complex<double> > &)
+
+	******************************************************************************/
+	void OverlapSave::setKernel(const std::vector<double> &kernel)
+	{
+		setKernel(std::vector<std::complex<double> >(kernel.begin(), kernel.end()));
+	}
+
+	/**************************************************************************//**
+	Set the kernel of the convolution. The FFT size is selected and the spectrum
+	of the kernel is computed.
+
+	@param kernel Kernel of the convolution. kernel[0] applies to the most recent sample
+	******************************************************************************/
+	void OverlapSave::setKernel(const std::vector<std::complex<double> > &kernel)
+	{
+		assert(!kernel.empty());
+		numTaps = kernel.size();
+		size_t fftSize = fftConvolutionSize(numTaps);
+		fft.setSize(fftSize);
+		spectrum.assign(fftSize, std::complex<double>());
+		// The 1/fftSize normalization of the inverse transform is included in the spectrum
+		for (size_t k = 0; k < numTaps; ++k)
+			spectrum[k] = kernel[k] / static_cast<double>(fftSize);
+		fft.forward(spectrum.data());
+		segment.resize(fftSize);
+	}
+
+	/**************************************************************************//**
+	Compute the linear convolution of the input with the kernel.\n
+
+	Each segment of fftSize input samples provides fftSize - numTaps + 1 output
+	samples. The first numTaps - 1 samples of each segment are the samples
+	which precede the outputs.
+
+	@param input outputSize + numTaps - 1 samples, the oldest first. The first
+	numTaps - 1 samples are the history preceding the samples to filter
+	@param outputSize Number of samples to filter
+	@param output Filtered samples
+	******************************************************************************/
+	void OverlapSave::filter(const std::complex<double> *input, size_t outputSize, std::complex<double> *output)
+	{
+		assert(numTaps > 0);
+		size_t fftSize = fft.getSize();
+		size_t validSize = fftSize - numTaps + 1;
+		size_t inputSize = outputSize + numTaps - 1;
+
+		for (size_t start = 0; start < outputSize; start += validSize)
+		{
+			// Copy the segment, padding with zeros past the end of the input
+			for (size_t k = 0; k < fftSize; ++k)
+				segment[k] = (start + k < inputSize) ? input[start + k] : std::complex<double>();
+			fft.forward(segment.data());
+			for (size_t k = 0; k < fftSize; ++k)
+				segment[k] *= spectrum[k];
+			fft.inverse(segment.data());
+			// The first numTaps - 1 values are corrupted by the circular convolution
+			for (size_t k = 0; k < validSize && start + k < outputSize; ++k)
+				output[start + k] = segment[numTaps - 1 + k];
+		}
+	}
+
+	/**************************************************************************//**
+	Return the size of the FFT used for the fast convolution with a kernel of
+	numTaps coefficients. The size is the power of 2 larger or equal to 4 times
+	the number of taps, so that about 3/4 of each segment provides valid outputs.
+
+	******************************************************************************/
+	size_t fftConvolutionSize(size_t numTaps)
+	{
+		size_t fftSize = 4;
+		while (fftSize < 4 * numTaps)
+			fftSize *= 2;
+		return fftSize;
+	}
+
+	/**************************************************************************//**
+	Compare the estimated costs of the direct form and of the fast convolution
+	to filter blockSize samples with a numTaps filter.\n
+
+	The direct form costs numTaps multiply accumulate per sample, divided by the
+	speedup of its implementation when it is vectorized. The fast convolution costs
+	two FFTs plus the multiplication by the spectrum for each segment. Filters with
+	less than 64 taps always use the direct form.
+
+	@param numTaps Number of taps of the filter
+	@param blockSize Number of samples to filter
+	@param directSpeedup Speed of the multiply accumulates of the direct form
+	relative to the scalar ones. See dsptl_private::dotComplex16Speedup
+	@return true if the fast convolution should be used
+	******************************************************************************/
+	bool fftConvolutionIsFaster(size_t numTaps, size_t blockSize, double directSpeedup)
+	{
+		if (numTaps < minFftConvolutionTaps || blockSize == 0)
+			return false;
+		size_t fftSize = fftConvolutionSize(numTaps);
+		size_t validSize = fftSize - numTaps + 1;
+		size_t numSegments = (blockSize + validSize - 1) / validSize;
+		double log2Size = log2(static_cast<double>(fftSize));
+		double fftCost = fftCostFactor * numSegments * fftSize * (2 * log2Size + 2);
+		double directCost = static_cast<double>(numTaps) * blockSize / directSpeedup;
+		return fftCost < directCost;
+	}
+
+} // End of namespace
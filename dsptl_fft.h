@@ -0,0 +1,107 @@
+/***********************************************************************//**
+@file
+
+Fast Fourier Transform and FFT based fast convolution.\n
+
+The transform is a radix-4 decimation in time algorithm completed by a radix-2
+stage when the size is not a power of 4. Computations are done in double
+precision so that the fast convolution of fixed point signals can be rounded
+back to the exact integer result.
+
+***************************************************************************/
+
+#ifndef DSPTL_FFT_H
+#define DSPTL_FFT_H
+
+#include <complex>
+#include <vector>
+#include <cstddef>
+
+namespace dsptl_private
+{
+	/// Conversion of a real or complex sample to a complex double
+	template<class T>
+	std::complex<double> toComplexDouble(const std::complex<T> &v)
+	{
+		return std::complex<double>(static_cast<double>(v.real()), static_cast<double>(v.imag()));
+	}
+
+	template<class T>
+	std::complex<double> toComplexDouble(const T &v)
+	{
+		return std::complex<double>(static_cast<double>(v), 0.0);
+	}
+}
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Complex FFT of a size which is a power of 2
+
+	The transform is computed in place. The inverse transform is not normalized:
+	applying forward() then inverse() multiplies the data by the size of the FFT.
+
+	***************************************************************************/
+	class Fft
+	{
+	public:
+		Fft(size_t fftSize = 0);
+		// Change the size of the transform
+		void setSize(size_t fftSize);
+		/// Return the size of the transform
+		size_t getSize() const { return size; }
+		// Forward transform exp(-j...) of size getSize() values
+		void forward(std::complex<double> *data) const;
+		// Inverse transform exp(+j...) of size getSize() values
+		void inverse(std::complex<double> *data) const;
+
+	private:
+		void transform(std::complex<double> *data, bool inverse) const;
+
+		size_t size;								///< Number of points of the transform
+		unsigned log2Size;							///< Base 2 logarithm of the size
+		std::vector<std::complex<double> > twiddle;	///< exp(-j 2 pi k / size)
+		std::vector<size_t> bitReversed;			///< Bit reversed index of each position
+	};
+
+
+	/***********************************************************************//**
+	Fast convolution engine based on the overlap-save method
+
+	The kernel (the filter coefficients) is set once. The filter() function then
+	computes the linear convolution of an input sequence with the kernel. The
+	size of the FFT is selected from the length of the kernel.
+
+	***************************************************************************/
+	class OverlapSave
+	{
+	public:
+		OverlapSave() : numTaps(0) {}
+		// Set a real kernel
+		void setKernel(const std::vector<double> &kernel);
+		// Set a complex kernel
+		void setKernel(const std::vector<std::complex<double> > &kernel);
+		// Filter the input sequence
+		void filter(const std::complex<double> *input, size_t outputSize, std::complex<double> *output);
+		/// Number of taps of the kernel
+		size_t getNumTaps() const { return numTaps; }
+		/// Size of the FFT used by the engine
+		size_t getFftSize() const { return fft.getSize(); }
+
+	private:
+		Fft fft;
+		size_t numTaps;									///< Number of taps of the kernel
+		std::vector<std::complex<double> > spectrum;	///< Spectrum of the kernel scaled by 1/fftSize
+		std::vector<std::complex<double> > segment;		///< Working buffer
+	};
+
+	// Size of the FFT used for the fast convolution with a kernel of numTaps taps
+	size_t fftConvolutionSize(size_t numTaps);
+
+	// Indicates if the fast convolution is expected to be faster than the direct form
+	bool fftConvolutionIsFaster(size_t numTaps, size_t blockSize, double directSpeedup = 1.0);
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,222 @@
+/***********************************************************************//**
+@file
+
+FFT based fixed pattern correlator.\n
+
+The correlator detects the same peaks as FixedPatternCorrelator but computes the
+correlation values of a whole block of samples at once by fast convolution
+(overlap-save). The cost per sample grows as the logarithm of the length of the
+pattern instead of linearly, which pays off for long patterns searched in long
+captures: compared to the vectorized inner product of FixedPatternCorrelator,
+beyond a few hundred points.
+
+***************************************************************************/
+
+#ifndef DSPTL_FFT_CORRELATOR_H
+#define DSPTL_FFT_CORRELATOR_H
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <complex>
+#include <array>
+#include <vector>
+#include <type_traits>
+#include "correlators.h"
+#include "dsptl_fft.h"
+
+namespace dsptl
+{
+
+	/*-----------------------------------------------------------------------------
+	Fixed pattern complex correlator computed with FFTs
+
+	The interface, the peak detection and the threshold are the ones of
+	FixedPatternCorrelator: for the same pattern and the same input blocks, step()
+	returns the same results and corrIndex values, and getStatus() and
+	getRefBitSamples() the same values.\n
+
+	The correlation of the pattern, with a stride of S samples, is the convolution of
+	the input with a kernel of (N - 1) S + 1 taps holding the conjugate pattern in
+	reverse order every S taps. It is computed in double precision for the whole block
+	then rounded to the exact integer result, as long as the sum of the magnitudes of
+	the products stays well below 2^52. The energy is updated incrementally for each
+	phase modulo S as in FixedPatternCorrelator.\n
+
+	As in FixedPatternCorrelator, step() stops at the first detection and the sample
+	which revealed the peak, the last one processed, is replaced by the first sample
+	of the next call.
+
+	@tparam InType Data type of the input signal
+	@tparam CompType Internal computation type. Must be an integer type
+	@tparam N Number of points of the correlation pattern
+	@tparam S Stride used to scan the input vector
+
+	------------------------------------------------------------------------------*/
+	template<class InType = int16_t, class CompType = int32_t, size_t N = 256, size_t S = 4 >
+	class FftPatternCorrelator
+	{
+		static_assert(std::is_integral<CompType>::value, "The computation type must be an integer type");
+
+	public:
+		/// Internal status of the correlator
+		typedef CorrelatorState CorrState;
+
+		FftPatternCorrelator();
+		bool step(const std::vector <std::complex<InType> > &in, int & corrIndex);
+		bool step(const std::complex<InType> *in, size_t size, int & corrIndex);
+		void setPattern(const std::array<std::complex<CompType>, N > &in, double thresholdCoeff = 0.8 );
+		void reset();
+		std::vector<std::complex<InType>> getRefBitSamples() { return bitSamples; }
+		CorrState getStatus() { return state; }
+
+	private:
+		/// Number of samples of history: N samples of each phase
+		static const size_t historySize = N * S;
+
+		OverlapSave fastCorrelation;				///< Fast convolution with the reversed pattern
+		std::array < std::complex<CompType>, N > coeffs;
+		std::vector < std::complex<InType> > samples;	///< History followed by the current block
+		std::vector < std::complex<double> > fftInput;	///< Input of the fast convolution
+		std::vector < std::complex<double> > fftOutput;	///< Correlation values of the current block
+		std::vector < std::complex<InType> > bitSamples;
+		std::array < uint32_t, S > phaseEnergy;		///< Energy of the last N samples of each phase
+		size_t phase;								///< Phase of the next sample modulo S
+		CorrState state;
+	};
+
+
+	/*-----------------------------------------------------------------------------
+	Constructor
+
+	Internal variables are initialized. setPattern() must be called before step().
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S >
+	FftPatternCorrelator<InType, CompType, N, S >::FftPatternCorrelator()
+		: phase(0)
+	{
+		bitSamples.assign(N, {});
+		reset();
+	}
+
+	/*-----------------------------------------------------------------------------
+	Reset all internals of the correlator
+
+	Correlator coefficients and associated energy are not modified
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S >
+	void FftPatternCorrelator<InType, CompType, N, S >::reset()
+	{
+		phase = 0;
+		state.corrValue[0] = state.corrValue[1] = state.corrValue[2] = 0;
+		state.energyValue[0] = state.energyValue[1] = state.energyValue[2] = 0;
+		samples.assign(historySize, {});
+		for (size_t k = 0; k < bitSamples.size(); ++k)
+			bitSamples[k] = {};
+		for (size_t k = 0; k < S; ++k)
+			phaseEnergy[k] = 0;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Copy locally the array of correlation values and prepare the kernel of the
+	fast convolution
+
+	@param[in] in Correlation pattern, as a replica of the desired signal. See
+	FixedPatternCorrelator::setPattern()
+	@param[in] thresholdCoeff Threshold factor
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S >
+	void FftPatternCorrelator<InType, CompType, N, S >::setPattern(const std::array<std::complex<CompType>, N > &in, double thresholdCoeff)
+	{
+		dsptl_private::setCorrelatorPattern(in, coeffs, state, thresholdCoeff);
+
+		// Tap j S of the kernel multiplies the sample j S before the current one
+		std::vector<std::complex<double> > kernel((N - 1) * S + 1);
+		for (size_t j = 0; j < N; ++j)
+			kernel[j * S] = dsptl_private::toComplexDouble(coeffs[N - 1 - j]);
+		fastCorrelation.setKernel(kernel);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Correlate a block of samples. See FixedPatternCorrelator::step()
+
+	@param[in] in Samples to correlate
+	@param[out] corrIndex Index related to the input buffer at which the correlation occurred
+	The value only makes sense if the function returned true
+
+	@return true if correlation peak has been detected; false otherwise
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S >
+	bool FftPatternCorrelator<InType, CompType, N, S >::step(const std::vector < std::complex<InType> > &in, int & corrIndex)
+	{
+		return step(in.data(), in.size(), corrIndex);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Version of step() working on a range of samples
+
+	The correlation values of the whole block are computed first. The energy and
+	the peak detection are then updated sample by sample until a peak is found.
+
+	@param[in] in First sample to correlate
+	@param[in] size Number of samples to correlate
+	@param[out] corrIndex Index related to in at which the correlation occurred
+
+	@return true if correlation peak has been detected; false otherwise
+	------------------------------------------------------------------------------*/
+	template<class InType, class CompType, size_t N, size_t S >
+	bool FftPatternCorrelator<InType, CompType, N, S >::step(const std::complex<InType> *in, size_t size, int & corrIndex)
+	{
+		typedef typename std::make_unsigned<CompType>::type UnsignedType;
+		assert(fastCorrelation.getNumTaps() > 0);
+
+		samples.resize(historySize + size);
+		for (size_t k = 0; k < size; ++k)
+			samples[historySize + k] = in[k];
+
+		// The first S samples of the history are only used by the energy
+		size_t kernelHistory = historySize - S;
+		fftInput.resize(kernelHistory + size);
+		for (size_t k = 0; k < fftInput.size(); ++k)
+			fftInput[k] = dsptl_private::toComplexDouble(samples[S + k]);
+		fftOutput.resize(size);
+		if (size > 0)
+			fastCorrelation.filter(fftInput.data(), size, fftOutput.data());
+
+		for (size_t t = 0; t < size; ++t)
+		{
+			size_t current = historySize + t;
+			uint32_t &phaseSum = phaseEnergy[phase];
+			phaseSum -= dsptl_private::correlatorPower<CompType>(samples[current - historySize]);
+			phaseSum += dsptl_private::correlatorPower<CompType>(samples[current]);
+
+			// Same wrap around as the integer inner product of FixedPatternCorrelator
+			std::complex<CompType> corr(
+				static_cast<CompType>(static_cast<UnsignedType>(llround(fftOutput[t].real()))),
+				static_cast<CompType>(static_cast<UnsignedType>(llround(fftOutput[t].imag()))));
+
+			if (dsptl_private::correlatorPeak(state, corr, phaseSum))
+			{
+				// -1 to refer to the previous sample
+				corrIndex = static_cast<int>(t) - 1;
+				// The current sample stays in the history in place of the oldest one
+				// and is replaced by the next input sample, as in FixedPatternCorrelator
+				samples[current - historySize] = samples[current];
+				samples.erase(samples.begin() + current, samples.end());
+				samples.erase(samples.begin(), samples.end() - historySize);
+				// The bit samples are the last N samples of the phase of the peak
+				for (size_t k = 0; k < N; ++k)
+					bitSamples[k] = samples[S - 1 + k * S];
+				return true;
+			}
+
+			phase = (phase + 1 == S) ? 0 : phase + 1;
+		}
+
+		samples.erase(samples.begin(), samples.end() - historySize);
+		return false;
+	}
+
+} // End of namespace
+
+#endif
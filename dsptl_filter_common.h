@@ -0,0 +1,278 @@
+/***********************************************************************//**
+@file
+
+Utilities shared by the implementations of the FIR filters
+
+***************************************************************************/
+
+#ifndef DSPTL_FILTER_COMMON_H
+#define DSPTL_FILTER_COMMON_H
+
+#include <complex>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+#include <type_traits>
+#include "dsp_complex.h"
+#include "dsptl_simd.h"
+
+namespace dsptl_private
+{
+
+	/// Symmetry of a set of filter coefficients
+	enum class CoeffSymmetry
+	{
+		none,			///< No symmetry
+		symmetric,		///< coeff[n] == coeff[N-1-n]
+		antisymmetric	///< coeff[n] == -coeff[N-1-n]
+	};
+
+	/***********************************************************************//**
+	Determine the symmetry of a set of filter coefficients. Linear phase filters
+	have symmetric (or antisymmetric) coefficients. A set of zero coefficients
+	is reported as symmetric.
+
+	@param coeff Filter coefficients
+
+	***************************************************************************/
+	template<class CoefType>
+	CoeffSymmetry findSymmetry(const std::vector<CoefType> &coeff)
+	{
+		size_t numTaps = coeff.size();
+		if (numTaps == 0)
+			return CoeffSymmetry::none;
+		bool symmetric = true;
+		bool antisymmetric = true;
+		for (size_t n = 0; n <= (numTaps - 1) / 2; ++n)
+		{
+			symmetric = symmetric && coeff[n] == coeff[numTaps - 1 - n];
+			antisymmetric = antisymmetric && coeff[n] == -coeff[numTaps - 1 - n];
+		}
+		if (symmetric)
+			return CoeffSymmetry::symmetric;
+		if (antisymmetric)
+			return CoeffSymmetry::antisymmetric;
+		return CoeffSymmetry::none;
+	}
+
+	/***********************************************************************//**
+	Inner product of the coefficients with a window of samples, using the
+	symmetry of the coefficients. The samples mirrored around the middle of the
+	window are added (or subtracted) before the multiplication so that only half
+	of the multiplications are performed.\n
+
+	The samples are converted to the internal type before the addition so that
+	the result is identical to the direct inner product.
+
+	@param coeff numTaps coefficients
+	@param window numTaps samples
+	@param numTaps Number of coefficients
+	@param symmetry Symmetry of the coefficients. Must not be CoeffSymmetry::none
+
+	***************************************************************************/
+	template<class InternalType, class CoefType, class SampleType>
+	InternalType foldedInnerProduct(const CoefType *coeff, const SampleType *window, size_t numTaps, CoeffSymmetry symmetry)
+	{
+		InternalType y{};
+		size_t half = numTaps / 2;
+		if (symmetry == CoeffSymmetry::symmetric)
+		{
+			for (size_t n = 0; n < half; ++n)
+				y += coeff[n] * (InternalType(window[n]) + InternalType(window[numTaps - 1 - n]));
+			// The middle coefficient of an odd length filter is not paired
+			if (numTaps % 2 != 0)
+				y += coeff[half] * InternalType(window[half]);
+		}
+		else
+		{
+			// The middle coefficient of an odd length antisymmetric filter is zero
+			for (size_t n = 0; n < half; ++n)
+				y += coeff[n] * (InternalType(window[n]) - InternalType(window[numTaps - 1 - n]));
+		}
+		return y;
+	}
+
+	/// Exact division by 2 of a value known to be even
+	template<class T>
+	T halve(const T &v)
+	{
+		return v / 2;
+	}
+
+	template<class T>
+	std::complex<T> halve(const std::complex<T> &v)
+	{
+		return std::complex<T>(v.real() / 2, v.imag() / 2);
+	}
+
+	/// Indicates if a sample type is floating point: float, double or a complex of them
+	template<class T>
+	struct IsFloatingSample : std::is_floating_point<T>
+	{};
+
+	template<class T>
+	struct IsFloatingSample<std::complex<T> > : std::is_floating_point<T>
+	{};
+
+	/***********************************************************************//**
+	Indicates if an inner product can use the vectorized floating point kernels
+	dotReal() and dotComplex(). The samples must already be of the internal type,
+	float or double, real or complex, and the coefficients of the corresponding
+	real type.
+
+	***************************************************************************/
+	template<class InternalType, class CoefType, class SampleType>
+	struct FloatDotEligible : std::integral_constant<bool,
+		std::is_same<InternalType, SampleType>::value && (
+		std::is_same<SampleType, CoefType>::value ||
+		std::is_same<SampleType, std::complex<CoefType> >::value) &&
+		std::is_floating_point<CoefType>::value >
+	{};
+
+	/***********************************************************************//**
+	Inner product of the coefficients with a window of samples. The generic
+	version is a plain loop. The overloads for floating point samples use the
+	vectorized kernels of dsptl_simd.h.
+
+	@param y Result
+	@param coeff numTaps coefficients
+	@param window numTaps samples
+	@param numTaps Number of coefficients
+
+	***************************************************************************/
+	template<class InternalType, class CoefType, class SampleType>
+	void innerProduct(InternalType &y, const CoefType *coeff, const SampleType *window, size_t numTaps)
+	{
+		InternalType acc{};
+		for (size_t n = 0; n < numTaps; ++n)
+			acc += coeff[n] * InternalType(window[n]);
+		y = acc;
+	}
+
+	inline void innerProduct(float &y, const float *coeff, const float *window, size_t numTaps)
+	{
+		y = dotReal(window, coeff, numTaps);
+	}
+
+	inline void innerProduct(double &y, const double *coeff, const double *window, size_t numTaps)
+	{
+		y = dotReal(window, coeff, numTaps);
+	}
+
+	template<class T>
+	void innerProduct(std::complex<T> &y, const T *coeff, const std::complex<T> *window, size_t numTaps,
+		typename std::enable_if<std::is_floating_point<T>::value>::type * = nullptr)
+	{
+		T re, im;
+		dotComplex(reinterpret_cast<const T *>(window), coeff, numTaps, re, im);
+		y = std::complex<T>(re, im);
+	}
+
+	/***********************************************************************//**
+	Symmetry of the coefficients as used by the filters. When the vectorized
+	floating point inner product is available, the filters compute all the taps
+	with it rather than folding the mirrored samples: the scalar folded loop is
+	slower than the FMA kernel on twice as many taps.
+
+	@tparam InternalType Type used internally by the filter
+	@tparam SampleType Type of the samples of the history
+
+	***************************************************************************/
+	template<class InternalType, class SampleType, class CoefType>
+	CoeffSymmetry selectSymmetry(const std::vector<CoefType> &coeff)
+	{
+		if (FloatDotEligible<InternalType, CoefType, SampleType>::value && cpuHasAvx2Fma())
+			return CoeffSymmetry::none;
+		return findSymmetry(coeff);
+	}
+
+	/***********************************************************************//**
+	Conversion of the result of a filter to its output type. Floating point
+	results are only converted: the gain is the one of the coefficients. Fixed
+	point results are scaled by a right shift then saturated, by limitScale16()
+	or limitScale() respectively.
+
+	@param y Result of the filter
+	@param shift Right shift of the fixed point result
+
+	***************************************************************************/
+	template<class OutType, class InternalType>
+	OutType outputScale16(const InternalType &y, int, std::true_type)
+	{
+		return static_cast<OutType>(y);
+	}
+
+	template<class OutType, class InternalType>
+	OutType outputScale16(const InternalType &y, int shift, std::false_type)
+	{
+		return limitScale16(y, shift);
+	}
+
+	template<class OutType, class InternalType>
+	OutType outputScale16(const InternalType &y, int shift)
+	{
+		return outputScale16<OutType>(y, shift, typename IsFloatingSample<InternalType>::type());
+	}
+
+	template<class OutType, class InternalType>
+	OutType outputScale(const InternalType &y, int, std::true_type)
+	{
+		return static_cast<OutType>(y);
+	}
+
+	template<class OutType, class InternalType>
+	OutType outputScale(const InternalType &y, int shift, std::false_type)
+	{
+		return limitScale<OutType>(y, shift);
+	}
+
+	template<class OutType, class InternalType>
+	OutType outputScale(const InternalType &y, int shift)
+	{
+		return outputScale<OutType>(y, shift, typename IsFloatingSample<InternalType>::type());
+	}
+
+	/***********************************************************************//**
+	Tables derived from coefficients shared by several filters, for example the
+	polyphase sub-filters of FilterUpsamplingFir. The filters built from the same
+	shared coefficients (see the cache of dsptl_filter_design.h) then also share
+	the derived tables, which are only computed once.
+
+
+	Tables must be constructible from the shared coefficients and keep them: the
+	address of the coefficients identifies the tables as long as they exist. The
+	cache only holds weak references, so that the tables are released with the
+	last filter using them. It is protected by a mutex.
+
+	@tparam Tables Type of the derived tables, specific to the type of the filter
+	@param coeff Shared coefficients. Must not be null
+
+	***************************************************************************/
+	template<class Tables, class CoefType>
+	std::shared_ptr<const Tables> sharedTables(const std::shared_ptr<const std::vector<CoefType> > &coeff)
+	{
+		static std::mutex cacheMutex;
+		static std::map<const std::vector<CoefType> *, std::weak_ptr<const Tables> > cache;
+
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		std::shared_ptr<const Tables> tables = cache[coeff.get()].lock();
+		if (tables)
+			return tables;
+		// The entries of the released tables are removed
+		for (typename std::map<const std::vector<CoefType> *, std::weak_ptr<const Tables> >::iterator it = cache.begin(); it != cache.end();)
+		{
+			if (it->second.expired())
+				it = cache.erase(it);
+			else
+				++it;
+		}
+		tables.reset(new Tables(coeff));
+		cache[coeff.get()] = tables;
+		return tables;
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,240 @@
+/***********************************************************************//**
+@file
+
+Design of FIR filter coefficients.
+
+***************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "dsptl_filter_design.h"
+#include "constants.h"
+
+namespace
+{
+	/// Sum of the quantized coefficients: 0 dB with a scaling of 15 bits
+	const int32_t quantizedSum = 32768;
+
+	/// Modified Bessel function of the first kind of order 0
+	double besselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		double halfX = x / 2.0;
+		for (int k = 1; k < 50; ++k)
+		{
+			term *= (halfX / k) * (halfX / k);
+			sum += term;
+			if (term < 1e-12 * sum)
+				break;
+		}
+		return sum;
+	}
+
+	/// Normalized sinc function sin(pi x) / (pi x)
+	double sinc(double x)
+	{
+		if (x == 0)
+			return 1.0;
+		return sin(dsptl::pi * x) / (dsptl::pi * x);
+	}
+}
+
+namespace dsptl
+{
+
+	/**************************************************************************//**
+	Shape parameter of the Kaiser window giving the requested stopband attenuation
+	(Kaiser's empirical formula).
+
+	@param attenuationDb Stopband attenuation in dB
+	******************************************************************************/
+	double kaiserBeta(double attenuationDb)
+	{
+		if (attenuationDb > 50)
+			return 0.1102 * (attenuationDb - 8.7);
+		if (attenuationDb > 21)
+			return 0.5842 * pow(attenuationDb - 21, 0.4) + 0.07886 * (attenuationDb - 21);
+		return 0;
+	}
+
+	/**************************************************************************//**
+	Estimate of the number of taps of a lowpass filter designed with a Kaiser window
+	(Kaiser's formula): N = (attenuation - 7.95) / (14.36 * transition width) + 1.
+
+	@param attenuationDb Stopband attenuation in dB
+	@param transitionWidth Width of the transition band, relative to the sampling
+	rate of the filter
+	******************************************************************************/
+	size_t estimateNumTaps(double attenuationDb, double transitionWidth)
+	{
+		assert(transitionWidth > 0);
+		return static_cast<size_t>(ceil(std::max(0.0, attenuationDb - 7.95) / (14.36 * transitionWidth))) + 1;
+	}
+
+	/**************************************************************************//**
+	Lowpass filter designed by windowing the ideal impulse response with a Kaiser
+	window. The gain at DC is 1.
+
+	@param numTaps Number of coefficients
+	@param cutoff Cutoff frequency (middle of the transition band), relative to the
+	sampling rate. Must be between 0 and 0.5
+	@param attenuationDb Stopband attenuation in dB used to select the window
+	******************************************************************************/
+	std::vector<double> designLowpassKaiser(size_t numTaps, double cutoff, double attenuationDb)
+	{
+		assert(numTaps > 0);
+		assert(cutoff > 0 && cutoff < 0.5);
+		double beta = kaiserBeta(attenuationDb);
+		double centre = (numTaps - 1) / 2.0;
+		double i0Beta = besselI0(beta);
+
+		std::vector<double> coeff(numTaps);
+		double sum = 0;
+		for (size_t n = 0; n < numTaps; ++n)
+		{
+			double t = n - centre;
+			double r = (numTaps > 1) ? t / centre : 0;
+			double window = besselI0(beta * sqrt(std::max(0.0, 1 - r * r))) / i0Beta;
+			coeff[n] = 2 * cutoff * sinc(2 * cutoff * t) * window;
+			sum += coeff[n];
+		}
+		for (size_t n = 0; n < numTaps; ++n)
+			coeff[n] /= sum;
+		return coeff;
+	}
+
+	/**************************************************************************//**
+	Halfband lowpass filter designed with a Kaiser window. The cutoff frequency is
+	1/4 of the sampling rate and the coefficients at an even distance of the centre
+	are exactly zero, as expected by the halfband filters of the library. The centre
+	coefficient is 1/2.
+
+	@param numTaps Number of coefficients. Must be of the form 4K-1
+	@param attenuationDb Stopband attenuation in dB used to select the window
+	******************************************************************************/
+	std::vector<double> designHalfbandKaiser(size_t numTaps, double attenuationDb)
+	{
+		assert((numTaps + 1) % 4 == 0);
+		std::vector<double> coeff = designLowpassKaiser(numTaps, 0.25, attenuationDb);
+		size_t centre = (numTaps - 1) / 2;
+		// The nonzero coefficients are normalized so that the gain at DC is 1
+		double sum = 0;
+		for (size_t n = 0; n < numTaps; ++n)
+		{
+			size_t distance = n > centre ? n - centre : centre - n;
+			if (distance != 0 && distance % 2 == 0)
+				coeff[n] = 0;
+			else if (distance != 0)
+				sum += coeff[n];
+		}
+		for (size_t n = 0; n < numTaps; ++n)
+			coeff[n] *= 0.5 / sum;
+		coeff[centre] = 0.5;
+		return coeff;
+	}
+
+	/**************************************************************************//**
+	Root raised cosine pulse shaping filter. The convolution of the filter with
+	itself is a raised cosine filter, which has no intersymbol interference. The
+	gain at DC is 1.
+
+	@param numTaps Number of coefficients. An odd number keeps a coefficient at the
+	centre of the pulse
+	@param samplesPerSymbol Oversampling ratio of the filter. Must be greater than 1
+	@param rolloff Excess bandwidth, between 0 and 1
+	******************************************************************************/
+	std::vector<double> designRootRaisedCosine(size_t numTaps, double samplesPerSymbol, double rolloff)
+	{
+		assert(numTaps > 0);
+		assert(samplesPerSymbol > 1);
+		assert(rolloff > 0 && rolloff <= 1);
+		double centre = (numTaps - 1) / 2.0;
+
+		std::vector<double> coeff(numTaps);
+		double sum = 0;
+		for (size_t n = 0; n < numTaps; ++n)
+		{
+			// Time in symbols
+			double t = (n - centre) / samplesPerSymbol;
+			double x = 4 * rolloff * t;
+			if (t == 0)
+				coeff[n] = 1 - rolloff + 4 * rolloff / pi;
+			else if (fabs(fabs(x) - 1) < 1e-9)
+			{
+				// Limit of the general expression where its denominator is zero
+				double angle = pi / (4 * rolloff);
+				coeff[n] = rolloff / sqrt(2.0) * ((1 + 2 / pi) * sin(angle) + (1 - 2 / pi) * cos(angle));
+			}
+			else
+				coeff[n] = (sin(pi * t * (1 - rolloff)) + x * cos(pi * t * (1 + rolloff))) / (pi * t * (1 - x * x));
+			sum += coeff[n];
+		}
+		for (size_t n = 0; n < numTaps; ++n)
+			coeff[n] /= sum;
+		return coeff;
+	}
+
+	/**************************************************************************//**
+	Quantize coefficients for the fixed point filters.\n
+
+	The coefficients are scaled so that their sum is 2^15. The rounding changes the
+	sum by up to 1/2 per coefficient and preserves the symmetry and the zero
+	coefficients. The filters of the library scale their output by
+	floor(log2(sum of the magnitudes)), which is then 15 as long as the sum of the
+	magnitudes stays below 2^16: the gain at DC is 0 dB and the filtering of 16 bits
+	samples cannot overflow 32 bits. The coefficients fit in 16 bits, except the one
+	of a filter made of a single coefficient (2^15).
+
+	@param coeff Coefficients designed in double precision. Their sum must be
+	positive and the sum of their magnitudes less than twice their sum
+	******************************************************************************/
+	std::vector<int32_t> quantizeCoeffs(const std::vector<double> &coeff)
+	{
+		double sum = 0;
+		for (size_t n = 0; n < coeff.size(); ++n)
+			sum += coeff[n];
+		assert(sum > 0);
+
+		std::vector<int32_t> quantized(coeff.size());
+		double scale = quantizedSum / sum;
+		for (size_t n = 0; n < coeff.size(); ++n)
+			quantized[n] = static_cast<int32_t>(lround(coeff[n] * scale));
+
+		// The scaling of the filters must be 15
+		int32_t sumMagnitude = 0;
+		for (size_t n = 0; n < coeff.size(); ++n)
+			sumMagnitude += std::abs(quantized[n]);
+		assert(sumMagnitude < 2 * quantizedSum);
+		(void)sumMagnitude;
+		return quantized;
+	}
+
+} // End of namespace
+
+namespace dsptl_private
+{
+
+	/**************************************************************************//**
+	Design in double precision the coefficients described by a key of the cache
+
+	@param key Kind and parameters of the design
+	******************************************************************************/
+	std::vector<double> designFromKey(const DesignKey &key)
+	{
+		switch (key.kind)
+		{
+		case DesignKind::lowpass:
+			return dsptl::designLowpassKaiser(key.numTaps, key.param1, key.param2);
+		case DesignKind::halfband:
+			return dsptl::designHalfbandKaiser(key.numTaps, key.param2);
+		case DesignKind::rootRaisedCosine:
+			return dsptl::designRootRaisedCosine(key.numTaps, key.param1, key.param2);
+		}
+		assert(false);
+		return std::vector<double>();
+	}
+
+} // End of namespace
@@ -0,0 +1,218 @@
+/***********************************************************************//**
+@file
+
+Design of FIR filter coefficients.\n
+
+The filters are designed in double precision by the window method, then
+quantized to the integer coefficients used by the fixed point filters of the
+library.\n
+
+The designs can also be obtained from a process-wide cache, keyed by the design
+parameters and the type of the coefficients. The filters created with the same
+parameters then share one immutable table of coefficients (see
+FilterFir::setCoeffs()) instead of holding a copy each.
+
+***************************************************************************/
+
+#ifndef DSPTL_FILTER_DESIGN_H
+#define DSPTL_FILTER_DESIGN_H
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace dsptl
+{
+
+	// Shape parameter of the Kaiser window for a stopband attenuation in dB
+	double kaiserBeta(double attenuationDb);
+
+	// Estimate of the number of taps of a lowpass filter
+	size_t estimateNumTaps(double attenuationDb, double transitionWidth);
+
+	// Lowpass filter designed with a Kaiser window
+	std::vector<double> designLowpassKaiser(size_t numTaps, double cutoff, double attenuationDb);
+
+	// Halfband lowpass filter designed with a Kaiser window
+	std::vector<double> designHalfbandKaiser(size_t numTaps, double attenuationDb);
+
+	// Root raised cosine pulse shaping filter
+	std::vector<double> designRootRaisedCosine(size_t numTaps, double samplesPerSymbol, double rolloff);
+
+	// Quantize coefficients for the fixed point filters of the library
+	std::vector<int32_t> quantizeCoeffs(const std::vector<double> &coeff);
+
+	/// Value of fractionalBits selecting the scaling of quantizeCoeffs()
+	const int defaultScaling = -1;
+
+} // End of namespace
+
+namespace dsptl_private
+{
+
+	/// Kinds of designs held by the cache
+	enum class DesignKind
+	{
+		lowpass,			///< designLowpassKaiser()
+		halfband,			///< designHalfbandKaiser()
+		rootRaisedCosine	///< designRootRaisedCosine()
+	};
+
+	/// Parameters of a design. Key of the cache
+	struct DesignKey
+	{
+		DesignKind kind;
+		size_t numTaps;
+		double param1;		///< Cutoff frequency or samples per symbol
+		double param2;		///< Attenuation in dB or rolloff
+		int fractionalBits;	///< Scaling of the quantized coefficients
+
+		bool operator<(const DesignKey &other) const
+		{
+			if (kind != other.kind)
+				return kind < other.kind;
+			if (numTaps != other.numTaps)
+				return numTaps < other.numTaps;
+			if (param1 != other.param1)
+				return param1 < other.param1;
+			if (param2 != other.param2)
+				return param2 < other.param2;
+			return fractionalBits < other.fractionalBits;
+		}
+	};
+
+	// Design in double precision the coefficients described by a key
+	std::vector<double> designFromKey(const DesignKey &key);
+
+	/// Conversion of the coefficients for floating point and integer types. See
+	/// dsptl::quantizeTaps()
+	template<class T>
+	std::vector<T> quantizeTaps(const std::vector<double> &coeff, int, std::true_type)
+	{
+		return std::vector<T>(coeff.begin(), coeff.end());
+	}
+
+	template<class T>
+	std::vector<T> quantizeTaps(const std::vector<double> &coeff, int fractionalBits, std::false_type)
+	{
+		std::vector<T> quantized(coeff.size());
+		if (fractionalBits == dsptl::defaultScaling)
+		{
+			std::vector<int32_t> scaled = dsptl::quantizeCoeffs(coeff);
+			for (size_t n = 0; n < coeff.size(); ++n)
+			{
+				// Only the coefficient of a filter made of a single one reaches 2^15
+				assert(scaled[n] <= std::numeric_limits<T>::max() && scaled[n] >= std::numeric_limits<T>::lowest());
+				quantized[n] = static_cast<T>(scaled[n]);
+			}
+			return quantized;
+		}
+		assert(fractionalBits >= 0);
+		double scale = ldexp(1.0, fractionalBits);
+		for (size_t n = 0; n < coeff.size(); ++n)
+		{
+			double value = round(coeff[n] * scale);
+			// The scaling must leave room for the largest coefficient
+			assert(value <= std::numeric_limits<T>::max() && value >= std::numeric_limits<T>::lowest());
+			quantized[n] = static_cast<T>(value);
+		}
+		return quantized;
+	}
+
+	/***********************************************************************//**
+	Design of the coefficients described by a key, returned from the cache if
+	the same design was already requested. The cache is protected by a mutex and
+	its entries are never released.
+
+	***************************************************************************/
+	template<class T>
+	std::shared_ptr<const std::vector<T> > cachedDesign(const DesignKey &key)
+	{
+		static std::mutex cacheMutex;
+		static std::map<DesignKey, std::shared_ptr<const std::vector<T> > > cache;
+
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		typename std::map<DesignKey, std::shared_ptr<const std::vector<T> > >::const_iterator found = cache.find(key);
+		if (found != cache.end())
+			return found->second;
+		std::shared_ptr<const std::vector<T> > taps(new std::vector<T>(quantizeTaps<T>(designFromKey(key), key.fractionalBits,
+			typename std::is_floating_point<T>::type())));
+		cache[key] = taps;
+		return taps;
+	}
+
+} // End of namespace
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Conversion of coefficients designed in double precision to the type of the
+	coefficients of a filter.\n
+
+	Integer coefficients are rounded to fractionalBits fractional bits: 1.0 is
+	2^fractionalBits. With defaultScaling, they are scaled by quantizeCoeffs(): their
+	sum is 2^15, which gives a gain of 0 dB at DC through the scaling of the filters
+	of the library. The quantized values must fit in T. Floating point coefficients
+	are only converted: fractionalBits is ignored.
+
+	@tparam T Type of the coefficients: int16_t, int32_t, float or double
+	@param coeff Coefficients designed in double precision
+	@param fractionalBits Number of fractional bits or defaultScaling
+
+	***************************************************************************/
+	template<class T>
+	std::vector<T> quantizeTaps(const std::vector<double> &coeff, int fractionalBits = defaultScaling)
+	{
+		return dsptl_private::quantizeTaps<T>(coeff, fractionalBits, typename std::is_floating_point<T>::type());
+	}
+
+	/***********************************************************************//**
+	Lowpass filter designed with a Kaiser window, shared through the cache. See
+	designLowpassKaiser() and quantizeTaps() for the parameters.
+
+	***************************************************************************/
+	template<class T>
+	std::shared_ptr<const std::vector<T> > lowpassTaps(size_t numTaps, double cutoff, double attenuationDb,
+		int fractionalBits = defaultScaling)
+	{
+		dsptl_private::DesignKey key = { dsptl_private::DesignKind::lowpass, numTaps, cutoff, attenuationDb, fractionalBits };
+		return dsptl_private::cachedDesign<T>(key);
+	}
+
+	/***********************************************************************//**
+	Halfband filter designed with a Kaiser window, shared through the cache. See
+	designHalfbandKaiser() and quantizeTaps() for the parameters.
+
+	***************************************************************************/
+	template<class T>
+	std::shared_ptr<const std::vector<T> > halfbandTaps(size_t numTaps, double attenuationDb,
+		int fractionalBits = defaultScaling)
+	{
+		dsptl_private::DesignKey key = { dsptl_private::DesignKind::halfband, numTaps, 0, attenuationDb, fractionalBits };
+		return dsptl_private::cachedDesign<T>(key);
+	}
+
+	/***********************************************************************//**
+	Root raised cosine filter, shared through the cache. See
+	designRootRaisedCosine() and quantizeTaps() for the parameters.
+
+	***************************************************************************/
+	template<class T>
+	std::shared_ptr<const std::vector<T> > rootRaisedCosineTaps(size_t numTaps, double samplesPerSymbol, double rolloff,
+		int fractionalBits = defaultScaling)
+	{
+		dsptl_private::DesignKey key = { dsptl_private::DesignKind::rootRaisedCosine, numTaps, samplesPerSymbol, rolloff, fractionalBits };
+		return dsptl_private::cachedDesign<T>(key);
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,102 @@
+#include "dsptl_filter_design.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <iostream>
+
+namespace
+{
+	/// Tolerance on the gain at DC
+	const double dcGainToleranceDb = 0.05;
+}
+
+bool testEstimateNumTaps();
+bool testQuantizeCoeffs(const char *name, const std::vector<double> &coeff);
+bool testCachedTaps();
+
+int main()
+{
+	using namespace dsptl;
+
+	bool passed = testEstimateNumTaps();
+	passed = testQuantizeCoeffs("Lowpass 63 taps", designLowpassKaiser(63, 0.1, 60)) && passed;
+	passed = testQuantizeCoeffs("Lowpass 16 taps", designLowpassKaiser(16, 0.2, 50)) && passed;
+	passed = testQuantizeCoeffs("Halfband 39 taps", designHalfbandKaiser(39, 60)) && passed;
+	passed = testQuantizeCoeffs("Halfband 55 taps", designHalfbandKaiser(55, 83)) && passed;
+	passed = testQuantizeCoeffs("Root raised cosine", designRootRaisedCosine(65, 4, 0.35)) && passed;
+	passed = testQuantizeCoeffs("Single coefficient", std::vector<double>(1, 1.0)) && passed;
+	passed = testCachedTaps() && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Kaiser's estimate of the number of taps
+------------------------------------------------------------------------------*/
+bool testEstimateNumTaps()
+{
+	using namespace dsptl;
+
+	bool passed = estimateNumTaps(60, 0.1) == 38 && estimateNumTaps(80, 0.05) == 102;
+	std::cout << "+++++ estimateNumTaps: " << estimateNumTaps(60, 0.1) << " and " << estimateNumTaps(80, 0.05)
+		<< " taps: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+The quantized coefficients must keep the symmetry and the zeros of the design,
+and give a gain of 0 dB at DC with the scaling of the filters of the library,
+floor(log2(sum of the magnitudes)) = 15
+------------------------------------------------------------------------------*/
+bool testQuantizeCoeffs(const char *name, const std::vector<double> &coeff)
+{
+	using namespace dsptl;
+
+	std::vector<int32_t> quantized = quantizeCoeffs(coeff);
+	bool passed = quantized.size() == coeff.size();
+	int32_t sum = 0;
+	int32_t sumMagnitude = 0;
+	for (size_t n = 0; n < quantized.size(); ++n)
+	{
+		sum += quantized[n];
+		sumMagnitude += std::abs(quantized[n]);
+		passed = passed && (coeff[n] != 0 || quantized[n] == 0);
+		passed = passed && (coeff[n] != coeff[coeff.size() - 1 - n] || quantized[n] == quantized[quantized.size() - 1 - n]);
+	}
+	int scaling = static_cast<int>(floor(log2(static_cast<double>(sumMagnitude))));
+	double dcGainDb = 20 * log10(sum / ldexp(1.0, scaling));
+	passed = passed && scaling == 15 && fabs(dcGainDb) < dcGainToleranceDb;
+
+	std::cout << "+++++ quantizeCoeffs " << name << ": sum " << sum << ", sum of magnitudes " << sumMagnitude
+		<< ", gain at DC " << dcGainDb << " dB: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+The cached 16 bits taps must be the ones of quantizeCoeffs(), with a gain of
+0 dB at DC, and be shared by the identical requests
+------------------------------------------------------------------------------*/
+bool testCachedTaps()
+{
+	using namespace dsptl;
+
+	std::shared_ptr<const std::vector<int16_t> > taps = lowpassTaps<int16_t>(63, 0.1, 60);
+	std::vector<int32_t> reference = quantizeCoeffs(designLowpassKaiser(63, 0.1, 60));
+	bool passed = taps == lowpassTaps<int16_t>(63, 0.1, 60) && taps->size() == reference.size();
+	int32_t sum = 0;
+	for (size_t n = 0; n < taps->size() && passed; ++n)
+	{
+		passed = (*taps)[n] == reference[n];
+		sum += (*taps)[n];
+	}
+	double dcGainDb = 20 * log10(sum / 32768.0);
+	passed = passed && fabs(dcGainDb) < dcGainToleranceDb;
+
+	// Explicit scaling
+	std::vector<int16_t> scaled = quantizeTaps<int16_t>(std::vector<double>(1, 0.5), 15);
+	passed = passed && scaled[0] == 16384;
+
+	std::cout << "+++++ lowpassTaps<int16_t>: gain at DC " << dcGainDb << " dB: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -0,0 +1,465 @@
+/***********************************************************************//**
+@file
+
+Definition of the decimation and interpolation by 2 filters specialized for
+halfband coefficients.\n
+
+In a halfband filter of 4K-1 coefficients, every other coefficient is zero
+except the centre one. Combined with the symmetry of the coefficients, each
+output only needs K multiplications plus the one of the centre coefficient.
+
+***************************************************************************/
+
+#ifndef DSPTL_HALFBAND_FILTERS_H
+#define DSPTL_HALFBAND_FILTERS_H
+
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include "dsp_complex.h"
+#include "dsptl_filter_common.h"
+
+namespace dsptl_private
+{
+
+	/***********************************************************************//**
+	Extract the nonzero coefficients of a halfband filter.\n
+
+	The filter must have 4K-1 coefficients, optionally followed by one zero
+	coefficient so that its length is a multiple of 2 as required by
+	FilterDnsamplingFir and FilterUpsamplingFir. The centre coefficient is c = 2K-1.
+	The coefficients h[c - 2k] and h[c + 2k] must be zero for k > 0 and the
+	coefficients must be symmetric.
+
+	@param firCoeff Coefficients of the halfband filter
+	@param sideCoeff K coefficients h[c - 1], h[c - 3]..., h[0]
+	@param centreCoeff Value of the centre coefficient h[c]
+
+	***************************************************************************/
+	template<class CoefType>
+	void halfbandCoeffs(const std::vector<CoefType> &firCoeff, std::vector<CoefType> &sideCoeff, CoefType &centreCoeff)
+	{
+		size_t numTaps = firCoeff.size();
+		// A trailing zero coefficient is ignored
+		if (numTaps % 2 == 0)
+		{
+			assert(numTaps > 0 && firCoeff[numTaps - 1] == 0);
+			--numTaps;
+		}
+		assert((numTaps + 1) % 4 == 0);
+		size_t centre = (numTaps - 1) / 2;
+		size_t K = (numTaps + 1) / 4;
+
+		centreCoeff = firCoeff[centre];
+		sideCoeff.resize(K);
+		for (size_t k = 0; k < K; ++k)
+		{
+			sideCoeff[k] = firCoeff[centre - 2 * k - 1];
+			// Symmetry of the coefficients
+			assert(firCoeff[centre + 2 * k + 1] == sideCoeff[k]);
+			// Zero coefficients
+			assert(k == 0 || firCoeff[centre - 2 * k] == 0);
+			assert(k == 0 || firCoeff[centre + 2 * k] == 0);
+		}
+	}
+
+	/***********************************************************************//**
+	Tables derived from the coefficients of a halfband filter, shared by the
+	halfband filters using the same shared coefficients. See sharedTables()
+
+	***************************************************************************/
+	template<class CoefType>
+	struct HalfbandTables
+	{
+		HalfbandTables(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+			: coeff(firCoeff), centreCoeff()
+		{
+			halfbandCoeffs(*coeff, sideCoeff, centreCoeff);
+			// bit growth due to coefficient  and number of taps
+			double sumMagnitude = 0;
+			for (size_t index = 0; index < coeff->size(); ++index)
+				sumMagnitude += std::abs((*coeff)[index]);
+			coeffScaling = static_cast<int>(floor(log2(sumMagnitude)));
+		}
+
+		std::shared_ptr<const std::vector<CoefType> > coeff;	///< Coefficients of the halfband filter
+		std::vector<CoefType> sideCoeff;	///< Nonzero coefficients from the centre to the first one
+		CoefType centreCoeff;				///< Centre coefficient
+		int coeffScaling;					///< Right shift applied to the outputs of the decimator for a gain of 0 dB
+	};
+
+} // End of namespace
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Halfband decimation by 2 FIR filter
+
+	@tparam InType Type of the input signal. Can be float, double, complex, int...
+	@tparam OutType Type of the output signal
+	@tparam InternalType Type used internally for the computation
+	@tparam CoefType Type of the coefficients
+
+	The filter computes the same output as FilterDnsamplingFir<InType, OutType,
+	InternalType, CoefType, 2> with the same coefficients, including the scaling of
+	the output, but only the nonzero coefficients are used and the symmetric
+	samples are added before the multiplication.\n
+
+	Like FilterDnsamplingFir::stepStream(), the decimation phase is kept from one
+	call to the other and stepStream() accepts blocks of any size.\n
+
+	The nonzero coefficients are extracted once and shared by the halfband filters
+	built from the same shared coefficients.
+
+	It is the responsibility of the caller to make sure that the different types
+	work smoothly. Overflow and underflow conditions must not occur
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	class FilterDnsamplingHalfband
+	{
+	public:
+		/// Constructor. The coefficients can be setup later by calling setCoeffs()
+		FilterDnsamplingHalfband() : top(0), phase(0), leftShift(0) {}
+		FilterDnsamplingHalfband(const std::vector<CoefType> &firCoeff);
+		FilterDnsamplingHalfband(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+		// Change the coefficients of the filter
+		void setCoeffs(const std::vector<CoefType> &firCoeff);
+		// Version of setCoeffs() sharing the coefficients with other filters
+		void setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+		// The input size must be a multiple of 2. The output is half the size of the input
+		void step(const std::vector<InType> & input, std::vector<OutType> & filteredSignal);
+		// Version of step() working on a range of samples without any copy
+		void step(const InType *input, size_t inputSize, OutType *filteredSignal);
+		// Filter any number of samples and return the number of outputs
+		size_t stepStream(const InType *input, size_t inputSize, OutType *filteredSignal);
+		/// Reset the internal counters and buffers
+		void reset()
+		{
+			top = 0;
+			phase = 0;
+			for (size_t index = 0; index < history.size(); ++index)
+				history[index] = InType();
+		}
+		/// Set the gain of the decimator in terms of left shift. The default gain is
+		/// about 0 dB
+		void setLeftShiftBy2(int leftShiftBy2) { leftShift = leftShiftBy2; }
+
+	private:
+		std::shared_ptr<const dsptl_private::HalfbandTables<CoefType> > tables;	///< Nonzero coefficients, possibly shared with other filters
+		std::vector<InType> history;		///< History buffer. Each sample is stored twice
+		size_t top;							///< Current insertion point in the history buffer
+		unsigned phase;						///< Position in the stream modulo 2. An output is computed when 0
+		int leftShift;						///< Amount of left shift to perform on the decimated output related to the 0 dB
+	};
+
+
+	/***********************************************************************//**
+	Constructor
+
+	@param firCoeff Coefficients of the halfband filter. See dsptl_private::halfbandCoeffs()
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	FilterDnsamplingHalfband<InType, OutType, InternalType, CoefType>::FilterDnsamplingHalfband(const std::vector<CoefType> &firCoeff)
+		: top(0), phase(0), leftShift(0)
+	{
+		setCoeffs(firCoeff);
+	}
+
+	/***********************************************************************//**
+	Constructor with coefficients shared with other filters, for example obtained
+	from the cache of dsptl_filter_design.h
+
+	@param firCoeff Coefficients of the halfband filter. Must not be null. See
+	dsptl_private::halfbandCoeffs()
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	FilterDnsamplingHalfband<InType, OutType, InternalType, CoefType>::FilterDnsamplingHalfband(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+		: top(0), phase(0), leftShift(0)
+	{
+		setCoeffs(firCoeff);
+	}
+
+	/***********************************************************************//**
+	Sets the coefficients of the filter. The history is cleared.
+
+	@param firCoeff Coefficients of the halfband filter. See dsptl_private::halfbandCoeffs()
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterDnsamplingHalfband<InType, OutType, InternalType, CoefType>::setCoeffs(const std::vector<CoefType> &firCoeff)
+	{
+		setCoeffs(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+	}
+
+	/***********************************************************************//**
+	Sets the coefficients of the filter without copying them. The filters using
+	the same table share it, as well as the nonzero coefficients extracted from it.
+	The table must not be modified afterwards. The history is cleared.
+
+	@param firCoeff Coefficients of the halfband filter. Must not be null
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterDnsamplingHalfband<InType, OutType, InternalType, CoefType>::setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+	{
+		assert(firCoeff);
+		tables = dsptl_private::sharedTables<dsptl_private::HalfbandTables<CoefType> >(firCoeff);
+		// The history holds the 4K-1 samples covered by the filter
+		history.resize(2 * (4 * tables->sideCoeff.size() - 1));
+		leftShift = 0;
+		reset();
+	}
+
+	/***********************************************************************//**
+	Halfband decimation filter
+
+	@param input Input to the filter. The size must be a multiple of 2
+	@param filteredSignal Output of the filter. Must be half the size of the input
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterDnsamplingHalfband<InType, OutType, InternalType, CoefType>::step(const std::vector<InType> & input, std::vector<OutType> & filteredSignal)
+	{
+		assert(filteredSignal.size() * 2 == input.size());
+		step(input.data(), input.size(), filteredSignal.data());
+	}
+
+	/***********************************************************************//**
+	Version of step() which filters a range of samples without any copy
+
+	@param input First sample of the input of the filter
+	@param inputSize Number of input samples. Must be a multiple of 2
+	@param filteredSignal Output of the filter. Room for inputSize / 2 samples
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterDnsamplingHalfband<InType, OutType, InternalType, CoefType>::step(const InType *input, size_t inputSize, OutType *filteredSignal)
+	{
+		assert(inputSize % 2 == 0);
+		size_t numOut = stepStream(input, inputSize, filteredSignal);
+		// Only true if the previous calls were made with multiples of 2 samples
+		assert(numOut * 2 == inputSize);
+		(void)numOut;
+	}
+
+	/***********************************************************************//**
+	Streaming halfband decimation filter
+
+	Each input sample is written twice in the history buffer so that the last 4K-1
+	samples are always contiguous from top, the most recent sample first. For each
+	output, the samples located at the same distance from the centre sample are
+	added, then multiplied by their common coefficient.
+
+	@param input First sample of the input of the filter
+	@param inputSize Number of input samples. Can be any value including 0
+	@param filteredSignal Output of the filter. Must have room for
+	(inputSize + 1) / 2 samples. It can be the same location as the input.
+
+	@return Number of samples written to filteredSignal
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	size_t FilterDnsamplingHalfband<InType, OutType, InternalType, CoefType>::stepStream(const InType *input, size_t inputSize, OutType *filteredSignal)
+	{
+		assert(tables);
+		size_t N = history.size() / 2;			// Number of samples covered by the filter
+		size_t K = tables->sideCoeff.size();	// Number of nonzero coefficients on each side
+		size_t centre = N / 2;
+		const CoefType *h = tables->sideCoeff.data();
+		const CoefType centreCoeff = tables->centreCoeff;
+		size_t outIndex = 0;
+
+		for (size_t j = 0; j < inputSize; ++j)
+		{
+			history[top] = input[j];
+			history[top + N] = input[j];
+			const InType *w = &history[top];
+			bool compute = (phase == 0);
+
+			// The sample is consumed before the output is written since the
+			// filtering can be made in place
+			top = (top == 0) ? N - 1 : top - 1;
+			phase ^= 1;
+			if (!compute)
+				continue;
+
+			InternalType y = centreCoeff * InternalType(w[centre]);
+			for (size_t k = 0; k < K; ++k)
+				y += h[k] * (InternalType(w[centre - 2 * k - 1]) + InternalType(w[centre + 2 * k + 1]));
+			// By default, the data is scaled to provide a gain of about 0 dB
+			// A non zero value of leftShift increases the gain by 2^leftShift
+			filteredSignal[outIndex++] = limitScale16(y, tables->coeffScaling - leftShift);
+		}
+		return outIndex;
+	}
+
+
+	/***********************************************************************//**
+	Halfband interpolation by 2 FIR filter
+
+	@tparam InType Type of the input signal. Can be float, double, complex, int...
+	@tparam OutType Type of the output signal
+	@tparam InternalType Type used internally for the computation
+	@tparam CoefType Type of the coefficients
+
+	The filter computes the same output as FilterUpsamplingFir<InType, OutType,
+	InternalType, CoefType, 2> with the same coefficients, including the scaling of
+	the output.\n
+
+	With 4K-1 coefficients, the history holds 2K samples. The first phase is the
+	symmetric sub-filter of the nonzero side coefficients, computed with K
+	multiplications. The second phase only involves the centre coefficient: it is
+	the delayed input multiplied by a constant. The nonzero coefficients are shared
+	like for FilterDnsamplingHalfband.
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	class FilterUpsamplingHalfband
+	{
+	public:
+		/// Constructor. The coefficients can be setup later by calling setCoeffs()
+		FilterUpsamplingHalfband() : top(0) {}
+		FilterUpsamplingHalfband(const std::vector<CoefType> &firCoeff);
+		FilterUpsamplingHalfband(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+		// Change the coefficients of the filter
+		void setCoeffs(const std::vector<CoefType> &firCoeff);
+		// Version of setCoeffs() sharing the coefficients with other filters
+		void setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+		// The output is twice the size of the input
+		void step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal);
+		// Version of step() working on a range of samples without any copy
+		void step(const InType *signal, size_t size, OutType *filteredSignal);
+		/// Reset the internal counters and buffers
+		void reset()
+		{
+			top = 0;
+			for (size_t index = 0; index < buffer.size(); ++index)
+				buffer[index] = InType();
+		}
+
+	private:
+		std::shared_ptr<const dsptl_private::HalfbandTables<CoefType> > tables;	///< Nonzero coefficients, possibly shared with other filters
+		std::vector<InType> buffer;			///< History buffer. Each sample is stored twice
+		size_t top;							///< Current insertion point in the history buffer
+	};
+
+
+	/***********************************************************************//**
+	Constructor
+
+	@param firCoeff Coefficients of the halfband filter. See dsptl_private::halfbandCoeffs()
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	FilterUpsamplingHalfband<InType, OutType, InternalType, CoefType>::FilterUpsamplingHalfband(const std::vector<CoefType> &firCoeff)
+		: top(0)
+	{
+		setCoeffs(firCoeff);
+	}
+
+	/***********************************************************************//**
+	Constructor with coefficients shared with other filters, for example obtained
+	from the cache of dsptl_filter_design.h
+
+	@param firCoeff Coefficients of the halfband filter. Must not be null. See
+	dsptl_private::halfbandCoeffs()
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	FilterUpsamplingHalfband<InType, OutType, InternalType, CoefType>::FilterUpsamplingHalfband(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+		: top(0)
+	{
+		setCoeffs(firCoeff);
+	}
+
+	/***********************************************************************//**
+	Sets the coefficients of the filter. The history is cleared.
+
+	@param firCoeff Coefficients of the halfband filter. See dsptl_private::halfbandCoeffs()
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterUpsamplingHalfband<InType, OutType, InternalType, CoefType>::setCoeffs(const std::vector<CoefType> &firCoeff)
+	{
+		setCoeffs(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+	}
+
+	/***********************************************************************//**
+	Sets the coefficients of the filter without copying them. See
+	FilterDnsamplingHalfband::setCoeffs(). The history is cleared.
+
+	@param firCoeff Coefficients of the halfband filter. Must not be null
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterUpsamplingHalfband<InType, OutType, InternalType, CoefType>::setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+	{
+		assert(firCoeff);
+		tables = dsptl_private::sharedTables<dsptl_private::HalfbandTables<CoefType> >(firCoeff);
+		buffer.resize(2 * 2 * tables->sideCoeff.size());
+		reset();
+	}
+
+	/***********************************************************************//**
+	Halfband interpolation filter
+
+	@param signal Input to the filter
+	@param filteredSignal Output of the filter. Must be twice the size of the input
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterUpsamplingHalfband<InType, OutType, InternalType, CoefType>::step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal)
+	{
+		assert(signal.size() * 2 == filteredSignal.size());
+		step(signal.data(), signal.size(), filteredSignal.data());
+	}
+
+	/***********************************************************************//**
+	Version of step() which filters a range of samples without any copy.\n
+
+	With w the history, the most recent sample first, the outputs are:
+	@arg y0 = sum h[c - 2k - 1] (w[K - 1 - k] + w[K + k]) for k = 0...K-1
+	@arg y1 = h[c] w[K - 1]
+
+	@param signal First sample of the input of the filter
+	@param size Number of input samples
+	@param filteredSignal Output of the filter. Room for 2 * size samples. The output
+	must not overlap the input.
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	void FilterUpsamplingHalfband<InType, OutType, InternalType, CoefType>::step(const InType *signal, size_t size, OutType *filteredSignal)
+	{
+		assert(tables);
+		size_t histSize = buffer.size() / 2;	// 2K
+		size_t K = tables->sideCoeff.size();
+		const CoefType *h = tables->sideCoeff.data();
+		const CoefType centreCoeff = tables->centreCoeff;
+		// Same scaling as FilterUpsamplingFir with an upsampling ratio of 2
+		const unsigned shift = 15 - 1;
+
+		for (size_t j = 0; j < size; ++j)
+		{
+			buffer[top] = signal[j];
+			buffer[top + histSize] = signal[j];
+			const InType *w = &buffer[top];
+
+			InternalType y0{};
+			for (size_t k = 0; k < K; ++k)
+				y0 += h[k] * (InternalType(w[K - 1 - k]) + InternalType(w[K + k]));
+			InternalType y1 = centreCoeff * InternalType(w[K - 1]);
+			filteredSignal[2 * j] = limitScale<OutType>(y0, shift);
+			filteredSignal[2 * j + 1] = limitScale<OutType>(y1, shift);
+
+			top = (top == 0) ? histSize - 1 : top - 1;
+		}
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,126 @@
+#include "dsptl_halfband_filters.h"
+#include "dsptl_dnsampling_filters.h"
+#include "upsampling_filters.h"
+#include <algorithm>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+typedef std::complex<int16_t> Sample;
+
+std::vector<int32_t> halfbandTaps(size_t K);
+bool testDnsamplingHalfband(size_t K, bool trailingZero);
+bool testUpsamplingHalfband(size_t K, bool trailingZero);
+
+int main()
+{
+	srand(1);
+	const size_t sizes[] = { 1, 2, 5, 8 };
+
+	bool passed = true;
+	for (size_t K : sizes)
+	{
+		passed = testDnsamplingHalfband(K, false) && passed;
+		passed = testDnsamplingHalfband(K, true) && passed;
+		passed = testUpsamplingHalfband(K, false) && passed;
+		passed = testUpsamplingHalfband(K, true) && passed;
+	}
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Random halfband coefficients: 4K-1 symmetric coefficients where every other
+coefficient is zero except the centre one. The sum of the magnitudes is below
+2^16 so that the sums of 16 bits samples fit in 32 bits.
+------------------------------------------------------------------------------*/
+std::vector<int32_t> halfbandTaps(size_t K)
+{
+	std::vector<int32_t> coeff(4 * K - 1, 0);
+	size_t centre = 2 * K - 1;
+	int32_t largest = static_cast<int32_t>(20000 / K);
+	coeff[centre] = 16384;
+	for (size_t k = 0; k < K; ++k)
+		coeff[centre - 2 * k - 1] = coeff[centre + 2 * k + 1] = rand() % (largest + largest / 2) - largest / 2;
+	return coeff;
+}
+
+/*-----------------------------------------------------------------------------
+FilterDnsamplingHalfband must give the output of FilterDnsamplingFir with M = 2,
+for the 4K-1 coefficients and for the 4K form with a trailing zero. The reference
+always uses the 4K form, whose length is a multiple of 2. The input of the
+halfband filter is split in blocks of arbitrary sizes, including 0 and odd sizes.
+------------------------------------------------------------------------------*/
+bool testDnsamplingHalfband(size_t K, bool trailingZero)
+{
+	std::vector<int32_t> coeff = halfbandTaps(K);
+	std::vector<int32_t> paddedCoeff(coeff);
+	paddedCoeff.push_back(0);
+
+	std::vector<Sample> input(1001);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = Sample(static_cast<int16_t>(rand() % 60001 - 30000), static_cast<int16_t>(rand() % 60001 - 30000));
+
+	dsptl::FilterDnsamplingFir<Sample, Sample, std::complex<int32_t>, int32_t, 2> reference(paddedCoeff);
+	std::vector<Sample> expected;
+	reference.stepStream(input, expected);
+
+	dsptl::FilterDnsamplingHalfband<Sample, Sample, std::complex<int32_t>, int32_t> filter(trailingZero ? paddedCoeff : coeff);
+	std::vector<Sample> output((input.size() + 1) / 2);
+	size_t numOut = 0;
+	for (size_t start = 0; start < input.size(); )
+	{
+		size_t blockSize = std::min<size_t>(rand() % 12, input.size() - start);
+		numOut += filter.stepStream(&input[start], blockSize, output.data() + numOut);
+		start += blockSize;
+	}
+
+	size_t numErrors = (numOut == expected.size()) ? 0 : 1;
+	for (size_t m = 0; m < numOut && m < expected.size(); ++m)
+		numErrors += (output[m] != expected[m]) ? 1 : 0;
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FilterDnsamplingHalfband K " << K << ", " << (trailingZero ? "4K" : "4K-1") << " taps: " << numErrors
+		<< " differences with FilterDnsamplingFir: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+FilterUpsamplingHalfband must give the output of FilterUpsamplingFir with L = 2,
+for the 4K-1 coefficients and for the 4K form with a trailing zero. The input of
+the halfband filter is split in blocks of arbitrary sizes.
+------------------------------------------------------------------------------*/
+bool testUpsamplingHalfband(size_t K, bool trailingZero)
+{
+	std::vector<int32_t> coeff = halfbandTaps(K);
+	std::vector<int32_t> paddedCoeff(coeff);
+	paddedCoeff.push_back(0);
+
+	std::vector<Sample> input(1001);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = Sample(static_cast<int16_t>(rand() % 60001 - 30000), static_cast<int16_t>(rand() % 60001 - 30000));
+
+	dsptl::FilterUpsamplingFir<Sample, Sample, std::complex<int32_t>, int32_t, 2> reference(paddedCoeff);
+	std::vector<Sample> expected(2 * input.size());
+	reference.step(input, expected);
+
+	dsptl::FilterUpsamplingHalfband<Sample, Sample, std::complex<int32_t>, int32_t> filter(trailingZero ? paddedCoeff : coeff);
+	std::vector<Sample> output(2 * input.size());
+	for (size_t start = 0; start < input.size(); )
+	{
+		size_t blockSize = std::min<size_t>(rand() % 12, input.size() - start);
+		filter.step(&input[start], blockSize, &output[2 * start]);
+		start += blockSize;
+	}
+
+	size_t numErrors = 0;
+	for (size_t n = 0; n < output.size(); ++n)
+		numErrors += (output[n] != expected[n]) ? 1 : 0;
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FilterUpsamplingHalfband K " << K << ", " << (trailingZero ? "4K" : "4K-1") << " taps: " << numErrors
+		<< " differences with FilterUpsamplingFir: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
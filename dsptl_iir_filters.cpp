@@ -0,0 +1,85 @@
+/***********************************************************************//**
+@file
+
+Infinite impulse response (IIR) filters: design of biquad sections.
+
+***************************************************************************/
+
+#include <cassert>
+#include <cmath>
+#include "dsptl_iir_filters.h"
+#include "constants.h"
+
+namespace
+{
+	/// Value of 1.0 in the Q14 format of the fixed point coefficients
+	const double q14One = 16384.0;
+
+	/// Quantization of one coefficient to Q14
+	int16_t toQ14(double value)
+	{
+		long q = lround(value * q14One);
+		assert(q >= INT16_MIN && q <= INT16_MAX);
+		return static_cast<int16_t>(q);
+	}
+}
+
+namespace dsptl
+{
+
+	/**************************************************************************//**
+	DC blocker H(z) = g (1 - z^-1) / (1 - p z^-1). The gain g is selected so that
+	the gain at half the sampling rate is 1.
+
+	@param pole Position of the pole on the real axis, between 0 and 1. The closer
+	to 1, the narrower the rejected band around DC
+	******************************************************************************/
+	Biquad<double> designDcBlocker(double pole)
+	{
+		assert(pole >= 0 && pole < 1);
+		double gain = (1 + pole) / 2;
+		Biquad<double> section = { gain, -gain, 0, -pole, 0 };
+		return section;
+	}
+
+	/**************************************************************************//**
+	Notch filter with zeros on the unit circle at the notch frequency and poles at
+	the same angle with a radius slightly smaller than 1. The coefficients are
+	scaled for a gain of 1 at DC or at half the sampling rate, whichever is further
+	from the notch.
+
+	@param frequency Notch frequency relative to the sampling rate, between 0 and 0.5
+	@param pole Radius of the poles, between 0 and 1. The closer to 1, the narrower
+	the notch
+	******************************************************************************/
+	Biquad<double> designNotch(double frequency, double pole)
+	{
+		assert(frequency >= 0 && frequency <= 0.5);
+		assert(pole >= 0 && pole < 1);
+		double c = cos(2 * pi * frequency);
+		Biquad<double> section = { 1, -2 * c, 1, -2 * pole * c, pole * pole };
+		double gain;
+		if (frequency < 0.25)
+			gain = (1 - section.a1 + section.a2) / (1 - section.b1 + section.b2);
+		else
+			gain = (1 + section.a1 + section.a2) / (1 + section.b1 + section.b2);
+		section.b0 *= gain;
+		section.b1 *= gain;
+		section.b2 *= gain;
+		return section;
+	}
+
+	/**************************************************************************//**
+	Quantization of the coefficients of a biquad to Q14 for the fixed point
+	filters. All the coefficients must be between -2 and 2 (exclusive for 2).
+
+	******************************************************************************/
+	template<>
+	Biquad<int16_t> convertBiquad<int16_t>(const Biquad<double> &section)
+	{
+		Biquad<int16_t> converted = { toQ14(section.b0), toQ14(section.b1), toQ14(section.b2),
+			toQ14(section.a1), toQ14(section.a2) };
+		return converted;
+	}
+
+} // End of namespace
@@ -0,0 +1,271 @@
+/***********************************************************************//**
+@file
+
+Infinite impulse response (IIR) filters made of a cascade of second order
+sections (biquads).\n
+
+A few biquads replace the long FIR filters otherwise needed for DC blocking or
+narrow notches. The recursion of an IIR filter cannot be vectorized over time,
+so the filters process several channels at once and the vectorized kernels
+work across the channels.
+
+***************************************************************************/
+
+#ifndef DSPTL_IIR_FILTERS_H
+#define DSPTL_IIR_FILTERS_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include "dsptl_simd.h"
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Coefficients of a biquad section
+
+	H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+
+	@tparam T Type of the coefficients. For the fixed point filters, int16_t
+	values in Q14 format (1.0 is 16384)
+
+	***************************************************************************/
+	template<class T>
+	struct Biquad
+	{
+		T b0, b1, b2;
+		T a1, a2;
+	};
+
+	// DC blocker: zero at DC and a real pole
+	Biquad<double> designDcBlocker(double pole);
+
+	// Notch filter: zeros on the unit circle at the notch frequency
+	Biquad<double> designNotch(double frequency, double pole);
+
+	/***********************************************************************//**
+	Conversion of the coefficients of a biquad designed in double precision to
+	the type of coefficients of a filter.
+
+	***************************************************************************/
+	template<class T>
+	Biquad<T> convertBiquad(const Biquad<double> &section)
+	{
+		Biquad<T> converted = { static_cast<T>(section.b0), static_cast<T>(section.b1), static_cast<T>(section.b2),
+			static_cast<T>(section.a1), static_cast<T>(section.a2) };
+		return converted;
+	}
+
+	// Quantization to Q14 for the fixed point filters
+	template<>
+	Biquad<int16_t> convertBiquad<int16_t>(const Biquad<double> &section);
+
+}
+
+namespace dsptl_private
+{
+
+	/***********************************************************************//**
+	Processing of a cascade of biquads for several channels. Floating point
+	version in transposed direct form II, which only needs two state variables
+	per section.\n
+
+	See biquadChannelsScalar() for the layout of the samples and of the state.
+
+	***************************************************************************/
+	template<class T>
+	struct BiquadKernel
+	{
+		static_assert(std::is_floating_point<T>::value, "Only float, double and int16_t samples are supported");
+		/// Number of state variables per section and per channel
+		static const size_t numStates = 2;
+
+		static void process(const T *coeff, size_t numSections, T *state, size_t numChannels,
+			const T *in, T *out, size_t numSamples)
+		{
+			biquadChannelsScalar(coeff, numSections, state, numChannels, numChannels, in, out, numSamples);
+		}
+	};
+
+	template<>
+	struct BiquadKernel<float>
+	{
+		static const size_t numStates = 2;
+
+		static void process(const float *coeff, size_t numSections, float *state, size_t numChannels,
+			const float *in, float *out, size_t numSamples)
+		{
+			biquadChannels(coeff, numSections, state, numChannels, numChannels, in, out, numSamples);
+		}
+	};
+
+	/***********************************************************************//**
+	Fixed point version for 16 bits samples and Q14 coefficients, in direct form
+	I. The state holds the last two inputs and outputs of each section, so that it
+	remains 16 bits: the transposed form would need 32 bits state variables.\n
+
+	The products are accumulated in 64 bits, rounded to Q0 and saturated to 16
+	bits at the output of each section.
+
+	***************************************************************************/
+	template<>
+	struct BiquadKernel<int16_t>
+	{
+		static const size_t numStates = 4;
+
+		static void process(const int16_t *coeff, size_t numSections, int16_t *state, size_t numChannels,
+			const int16_t *in, int16_t *out, size_t numSamples)
+		{
+			const int64_t rounding = 1 << 13;
+			for (size_t t = 0; t < numSamples; ++t)
+			{
+				for (size_t ch = 0; ch < numChannels; ++ch)
+					out[t * numChannels + ch] = in[t * numChannels + ch];
+				for (size_t s = 0; s < numSections; ++s)
+				{
+					const int16_t *c = coeff + 5 * s;
+					int16_t *x1 = state + 4 * s * numChannels;
+					int16_t *x2 = x1 + numChannels;
+					int16_t *y1 = x2 + numChannels;
+					int16_t *y2 = y1 + numChannels;
+					int16_t *x = out + t * numChannels;
+					for (size_t ch = 0; ch < numChannels; ++ch)
+					{
+						int64_t acc = static_cast<int64_t>(c[0]) * x[ch] + static_cast<int64_t>(c[1]) * x1[ch]
+							+ static_cast<int64_t>(c[2]) * x2[ch] - static_cast<int64_t>(c[3]) * y1[ch]
+							- static_cast<int64_t>(c[4]) * y2[ch];
+						acc = (acc + rounding) >> 14;
+						if (acc > std::numeric_limits<int16_t>::max())
+							acc = std::numeric_limits<int16_t>::max();
+						else if (acc < std::numeric_limits<int16_t>::lowest())
+							acc = std::numeric_limits<int16_t>::lowest();
+						x2[ch] = x1[ch];
+						x1[ch] = x[ch];
+						y2[ch] = y1[ch];
+						y1[ch] = static_cast<int16_t>(acc);
+						x[ch] = y1[ch];
+					}
+				}
+			}
+		}
+	};
+
+}
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Cascade of biquad sections
+
+	@tparam T Type of the samples: float, double or int16_t
+	@tparam K Number of channels filtered at once
+
+	The K channels are filtered independently by the same cascade. The signals
+	are channel interleaved: sample t of channel ch is located at t * K + ch.
+	Complex signals can be filtered as two channels, real and imaginary parts.\n
+
+	float and double samples are filtered in transposed direct form II with
+	coefficients of the same type. The float version processes 8 channels at a time
+	with AVX2 and FMA when the host supports them.\n
+
+	int16_t samples are filtered in direct form I with Q14 coefficients (see
+	convertBiquad()). The output of each section is rounded and saturated.\n
+
+	The state variables are stored as [section][state variable][channel] so that the
+	computations of the K channels apply to contiguous values.
+
+	***************************************************************************/
+	template<class T, size_t K = 1>
+	class FilterBiquadCascade
+	{
+		static_assert(K > 0, "The filter must have at least one channel");
+	public:
+		FilterBiquadCascade() {}
+		FilterBiquadCascade(const std::vector<Biquad<T> > &sections) { setSections(sections); }
+		// Change the sections of the cascade
+		void setSections(const std::vector<Biquad<T> > &sections);
+		// Filter size samples of each channel
+		void step(const T *signal, size_t size, T *filteredSignal);
+		// Version of step() with vectors. The size must be a multiple of K
+		void step(const std::vector<T> &signal, std::vector<T> &filteredSignal);
+		// Clear the state of all the channels
+		void reset();
+		/// Number of sections of the cascade
+		size_t getNumSections() const { return coeff.size() / 5; }
+
+	private:
+		std::vector<T> coeff;	///< b0, b1, b2, a1, a2 of each section
+		std::vector<T> state;	///< State variables [section][state variable][channel]
+	};
+
+
+	/***********************************************************************//**
+	Change the sections of the cascade. The state is cleared.
+
+	@param sections Coefficients of the sections, the first one is applied first
+
+	***************************************************************************/
+	template<class T, size_t K>
+	void FilterBiquadCascade<T, K>::setSections(const std::vector<Biquad<T> > &sections)
+	{
+		coeff.clear();
+		for (size_t s = 0; s < sections.size(); ++s)
+		{
+			coeff.push_back(sections[s].b0);
+			coeff.push_back(sections[s].b1);
+			coeff.push_back(sections[s].b2);
+			coeff.push_back(sections[s].a1);
+			coeff.push_back(sections[s].a2);
+		}
+		state.resize(sections.size() * dsptl_private::BiquadKernel<T>::numStates * K);
+		reset();
+	}
+
+	/***********************************************************************//**
+	Clear the state of all the channels
+
+	***************************************************************************/
+	template<class T, size_t K>
+	void FilterBiquadCascade<T, K>::reset()
+	{
+		for (size_t index = 0; index < state.size(); ++index)
+			state[index] = T();
+	}
+
+	/***********************************************************************//**
+	Filter size samples of each channel
+
+	@param signal Channel interleaved input. size * K samples
+	@param size Number of samples of each channel
+	@param filteredSignal Channel interleaved output. Room for size * K samples.
+	Can be the same location as the input
+
+	***************************************************************************/
+	template<class T, size_t K>
+	void FilterBiquadCascade<T, K>::step(const T *signal, size_t size, T *filteredSignal)
+	{
+		dsptl_private::BiquadKernel<T>::process(coeff.data(), getNumSections(), state.data(), K, signal, filteredSignal, size);
+	}
+
+	/***********************************************************************//**
+	Version of step() with vectors
+
+	@param signal Channel interleaved input. The size must be a multiple of K
+	@param filteredSignal Channel interleaved output. Must be the same size as signal
+
+	***************************************************************************/
+	template<class T, size_t K>
+	void FilterBiquadCascade<T, K>::step(const std::vector<T> &signal, std::vector<T> &filteredSignal)
+	{
+		assert(signal.size() == filteredSignal.size());
+		assert(signal.size() % K == 0);
+		step(signal.data(), signal.size() / K, filteredSignal.data());
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,176 @@
+#include "dsptl_iir_filters.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <iostream>
+
+namespace
+{
+	/// Tolerance of the float filters relative to the double reference, for inputs between -1 and 1
+	const double floatTolerance = 1e-5;
+	/// Tolerance of the double filters
+	const double doubleTolerance = 1e-12;
+}
+
+std::vector<double> referenceCascade(const std::vector<dsptl::Biquad<double> > &sections, const std::vector<double> &input);
+template<class T, size_t K>
+bool testFloatCascade(const std::vector<dsptl::Biquad<double> > &design, double tolerance);
+template<size_t K>
+bool testFixedPointCascade(const std::vector<dsptl::Biquad<double> > &design, double amplitude);
+
+int main()
+{
+	srand(1);
+	std::vector<dsptl::Biquad<double> > design;
+	design.push_back(dsptl::designDcBlocker(0.95));
+	design.push_back(dsptl::designNotch(0.1, 0.9));
+	design.push_back(dsptl::designNotch(0.35, 0.8));
+
+	bool passed = testFloatCascade<float, 1>(design, floatTolerance);
+	passed = testFloatCascade<float, 8>(design, floatTolerance) && passed;
+	passed = testFloatCascade<float, 11>(design, floatTolerance) && passed;
+	passed = testFloatCascade<float, 19>(design, floatTolerance) && passed;
+	passed = testFloatCascade<double, 5>(design, doubleTolerance) && passed;
+	passed = testFixedPointCascade<1>(design, 8000) && passed;
+	passed = testFixedPointCascade<6>(design, 8000) && passed;
+	passed = testFixedPointCascade<9>(design, 300) && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Cascade of biquads in transposed direct form II for a single channel, computed
+in double precision
+------------------------------------------------------------------------------*/
+std::vector<double> referenceCascade(const std::vector<dsptl::Biquad<double> > &sections, const std::vector<double> &input)
+{
+	std::vector<double> output(input);
+	for (const dsptl::Biquad<double> &s : sections)
+	{
+		double s1 = 0;
+		double s2 = 0;
+		for (size_t t = 0; t < output.size(); ++t)
+		{
+			double x = output[t];
+			double y = s.b0 * x + s1;
+			s1 = s.b1 * x - s.a1 * y + s2;
+			s2 = s.b2 * x - s.a2 * y;
+			output[t] = y;
+		}
+	}
+	return output;
+}
+
+/*-----------------------------------------------------------------------------
+Each channel of a float or double cascade must match the reference computed
+with the same coefficients, within the precision of the type. The number of
+channels is not always a multiple of 8, so that the vectorized kernel also
+processes an incomplete group of channels, and the input is split into two calls
+to check the state kept from one call to the other.
+------------------------------------------------------------------------------*/
+template<class T, size_t K>
+bool testFloatCascade(const std::vector<dsptl::Biquad<double> > &design, double tolerance)
+{
+	std::vector<dsptl::Biquad<T> > sections;
+	std::vector<dsptl::Biquad<double> > reference;
+	for (const dsptl::Biquad<double> &s : design)
+	{
+		sections.push_back(dsptl::convertBiquad<T>(s));
+		const dsptl::Biquad<T> &c = sections.back();
+		dsptl::Biquad<double> r = { c.b0, c.b1, c.b2, c.a1, c.a2 };
+		reference.push_back(r);
+	}
+
+	const size_t numSamples = 1000;
+	const size_t split = 377;
+	std::vector<T> input(numSamples * K);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = static_cast<T>(rand() % 20001 - 10000) / 10000;
+
+	dsptl::FilterBiquadCascade<T, K> filter(sections);
+	std::vector<T> output(input.size());
+	filter.step(input.data(), split, output.data());
+	filter.step(input.data() + split * K, numSamples - split, output.data() + split * K);
+
+	double maxError = 0;
+	for (size_t ch = 0; ch < K; ++ch)
+	{
+		std::vector<double> channel(numSamples);
+		for (size_t t = 0; t < numSamples; ++t)
+			channel[t] = input[t * K + ch];
+		std::vector<double> expected = referenceCascade(reference, channel);
+		for (size_t t = 0; t < numSamples; ++t)
+			maxError = std::max(maxError, std::fabs(output[t * K + ch] - expected[t]));
+	}
+
+	bool passed = maxError < tolerance;
+	std::cout << "+++++ FilterBiquadCascade " << (sizeof(T) == sizeof(float) ? "float" : "double") << " K " << K
+		<< ": maximum error " << maxError << ": " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+The int16_t cascade must match the reference computed in double precision with
+the Q14 coefficients, apart from the rounding of the output of each section.
+The rounding error of section s, at most 0.5, goes through the poles of s and
+through the following sections: the bound on the error is the sum of 0.5 times
+the sum of the magnitudes of the impulse response of this path. The amplitude
+of the input keeps the outputs away from saturation.
+------------------------------------------------------------------------------*/
+template<size_t K>
+bool testFixedPointCascade(const std::vector<dsptl::Biquad<double> > &design, double amplitude)
+{
+	std::vector<dsptl::Biquad<int16_t> > sections;
+	std::vector<dsptl::Biquad<double> > reference;
+	for (const dsptl::Biquad<double> &s : design)
+	{
+		sections.push_back(dsptl::convertBiquad<int16_t>(s));
+		const dsptl::Biquad<int16_t> &c = sections.back();
+		dsptl::Biquad<double> r = { c.b0 / 16384.0, c.b1 / 16384.0, c.b2 / 16384.0, c.a1 / 16384.0, c.a2 / 16384.0 };
+		reference.push_back(r);
+	}
+
+	double bound = 0;
+	std::vector<double> impulse(2000, 0.0);
+	impulse[0] = 1;
+	for (size_t s = 0; s < reference.size(); ++s)
+	{
+		std::vector<dsptl::Biquad<double> > path(reference.begin() + s, reference.end());
+		path[0].b0 = 1;
+		path[0].b1 = 0;
+		path[0].b2 = 0;
+		std::vector<double> response = referenceCascade(path, impulse);
+		for (size_t t = 0; t < response.size(); ++t)
+			bound += 0.5 * std::fabs(response[t]);
+	}
+
+	const size_t numSamples = 1000;
+	const size_t split = 501;
+	int range = static_cast<int>(amplitude);
+	std::vector<int16_t> input(numSamples * K);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = static_cast<int16_t>(rand() % (2 * range + 1) - range);
+
+	dsptl::FilterBiquadCascade<int16_t, K> filter(sections);
+	std::vector<int16_t> output(input.size());
+	filter.step(input.data(), split, output.data());
+	filter.step(input.data() + split * K, numSamples - split, output.data() + split * K);
+
+	double maxError = 0;
+	for (size_t ch = 0; ch < K; ++ch)
+	{
+		std::vector<double> channel(numSamples);
+		for (size_t t = 0; t < numSamples; ++t)
+			channel[t] = input[t * K + ch];
+		std::vector<double> expected = referenceCascade(reference, channel);
+		for (size_t t = 0; t < numSamples; ++t)
+			maxError = std::max(maxError, std::fabs(output[t * K + ch] - expected[t]));
+	}
+
+	bool passed = maxError <= bound;
+	std::cout << "+++++ FilterBiquadCascade int16_t K " << K << ", amplitude " << amplitude << ": maximum error "
+		<< maxError << ", bound " << bound << ": " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -0,0 +1,264 @@
+/***********************************************************************//**
+@file
+
+Definition of the DSP routines related to multirate filters performing a
+rational change of the sampling rate.
+
+***************************************************************************/
+
+#ifndef DSPTL_RESAMPLING_FILTER_FIR_H
+#define DSPTL_RESAMPLING_FILTER_FIR_H
+
+#include <cassert>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include "dsp_complex.h"
+#include "dsptl_filter_common.h"
+
+namespace dsptl
+{
+
+	/***********************************************************************//**
+	Rational L/M polyphase resampling FIR filter
+
+	@tparam InType Type of the input signal. Can be float, double, complex, int...
+	@tparam OutType Type of the output signal
+	@tparam InternalType Type used internally for the computation
+	@tparam CoefType Type of the coefficients
+	@tparam L Upsampling ratio
+	@tparam M Downsampling ratio
+
+	The filter produces the same samples as an upsampling by L (insertion of L-1
+	zeros), followed by the FIR filter and a decimation by M. Only the outputs which
+	survive the decimation are computed: for each of them a single polyphase
+	sub-filter of length N/L is evaluated. The cost per output is therefore N/L
+	multiplications instead of the N*M/L of FilterUpsamplingFir followed by
+	FilterDnsamplingFir.
+
+	The output is scaled by 2^(coeffScaling - round(log2(L))), where coeffScaling
+	is floor(log2(sum(|h|))) like for FilterDnsamplingFir, so that the gain of
+	each polyphase branch is about 0 dB.
+
+	The polyphase sub-filters are derived from the coefficients once and shared by
+	the resamplers built from the same shared coefficients.
+
+	It is the responsibility of the caller to make sure that the different types
+	work smoothly. Overflow and underflow conditions must not occur
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	class FilterResamplerFir
+	{
+		static_assert(L > 0 && M > 0, "The resampling ratios must be positive");
+	public:
+		/// Constructor. The coefficients can be setup later by calling setCoeffs()
+		FilterResamplerFir() : top(0), nextPhase(0), leftShift(0) {}
+		FilterResamplerFir(const std::vector<CoefType> &firCoeff);
+		FilterResamplerFir(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+		// Change the coefficients of the filter
+		void setCoeffs(const std::vector<CoefType> &firCoeff);
+		// Version of setCoeffs() sharing the coefficients and the sub-filters with other filters
+		void setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+		// Filter any number of samples and return the number of outputs
+		size_t step(const InType *input, size_t inputSize, OutType *filteredSignal);
+		// Version of step with vectors. The output is resized
+		size_t step(const std::vector<InType> & input, std::vector<OutType> & filteredSignal);
+		/// Maximum number of outputs produced by step() for inputSize input samples
+		static size_t getMaxOutputSize(size_t inputSize) { return (inputSize * L + M - 1) / M; }
+		/// Reset the internal counters and buffers
+		void reset()
+		{
+			top = 0;
+			nextPhase = 0;
+			for (size_t index = 0; index < buffer.size(); ++index)
+				buffer[index] = InType();
+		}
+		/// Set the gain of the resampler in terms of left shift. The default gain is
+		/// about 0 dB
+		void setLeftShiftBy2(int leftShiftBy2) { leftShift = leftShiftBy2; }
+
+	private:
+		/// Tables derived from the coefficients, shared by the filters using the same coefficients
+		struct PolyphaseTables
+		{
+			PolyphaseTables(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+			std::shared_ptr<const std::vector<CoefType> > coeff;	///< Coefficients
+			std::vector<CoefType> phaseCoeff;	///< Coefficients of the L sub-filters, one after the other
+			int coeffScaling;					///< Right shift applied to the outputs for a gain of 0 dB
+		};
+
+		std::shared_ptr<const PolyphaseTables> tables;	///< Sub-filters, possibly shared with other filters
+		std::vector<InType> buffer;		///< History buffer. Each sample is stored twice
+		size_t top;						///< Current insertion point in the history buffer
+		unsigned nextPhase;				///< Phase of the next output relative to the next input sample
+		int leftShift;					///< Amount of left shift to perform on the output related to the 0 dB
+	};
+
+
+	/***********************************************************************//**
+	Constructor
+
+	@param firCoeff Filter Coefficients. The number of coefficients must be a
+	multiple of L
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	FilterResamplerFir<InType, OutType, InternalType, CoefType, L, M>::FilterResamplerFir(const std::vector<CoefType> &firCoeff)
+		: top(0), nextPhase(0), leftShift(0)
+	{
+		setCoeffs(firCoeff);
+	}
+
+	/***********************************************************************//**
+	Constructor with coefficients shared with other filters, for example obtained
+	from the cache of dsptl_filter_design.h
+
+	@param firCoeff Filter Coefficients. Must not be null. The number of
+	coefficients must be a multiple of L
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	FilterResamplerFir<InType, OutType, InternalType, CoefType, L, M>::FilterResamplerFir(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+		: top(0), nextPhase(0), leftShift(0)
+	{
+		setCoeffs(firCoeff);
+	}
+
+	/***********************************************************************//**
+	Sets the coefficients of the filter. The history is cleared.
+
+	@param firCoeff Filter Coefficients. The number of coefficients must be a
+	multiple of L
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	void FilterResamplerFir<InType, OutType, InternalType, CoefType, L, M>::setCoeffs(const std::vector<CoefType> &firCoeff)
+	{
+		setCoeffs(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+	}
+
+	/***********************************************************************//**
+	Sets the coefficients of the filter without copying them. The filters using
+	the same table share it, as well as the sub-filters derived from it. The table
+	must not be modified afterwards. The history is cleared.
+
+	@param firCoeff Filter Coefficients. Must not be null. The number of
+	coefficients must be a multiple of L
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	void FilterResamplerFir<InType, OutType, InternalType, CoefType, L, M>::setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+	{
+		assert(firCoeff && !firCoeff->empty());
+		assert(firCoeff->size() % L == 0);
+
+		tables = dsptl_private::sharedTables<PolyphaseTables>(firCoeff);
+		buffer.resize(2 * (firCoeff->size() / L));
+		reset();
+	}
+
+	/***********************************************************************//**
+	Sub-filters of a set of coefficients.\n
+
+	The coefficients are stored as L contiguous sub-filters: the sub-filter of
+	phase p holds h[p], h[p + L], h[p + 2L]...
+
+	@param firCoeff Filter Coefficients. The number of coefficients is a multiple of L
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	FilterResamplerFir<InType, OutType, InternalType, CoefType, L, M>::PolyphaseTables::PolyphaseTables(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+		: coeff(firCoeff)
+	{
+		const std::vector<CoefType> &h = *coeff;
+		size_t histSize = h.size() / L;
+		phaseCoeff.resize(h.size());
+		for (size_t p = 0; p < L; ++p)
+			for (size_t i = 0; i < histSize; ++i)
+				phaseCoeff[p * histSize + i] = h[p + L * i];
+
+		// bit growth due to coefficient and number of taps, reduced by the
+		// number of polyphase branches
+		double sumMagnitude = 0;
+		for (size_t index = 0; index < h.size(); ++index)
+			sumMagnitude += std::abs(h[index]);
+		coeffScaling = static_cast<int>(floor(log2(sumMagnitude))) - static_cast<int>(round(log2(L)));
+	}
+
+	/***********************************************************************//**
+	Rational resampling FIR Filter
+
+	Each input sample is written twice in the history buffer, at top and at top plus
+	the size of the history, so that the history is always contiguous from top, the
+	most recent sample first.\n
+	In the upsampled stream, input sample j covers the positions L*j to L*j + L - 1.
+	The outputs are the positions which are multiples of M. nextPhase is the offset
+	of the next output relative to L*j: all the outputs with an offset smaller than L
+	are computed with the sub-filter of that phase, then the offset is moved to the
+	next input sample.\n
+
+	The decimation phase is kept from one call to the other so that the blocks can
+	have any size.
+
+	@param input First sample of the input of the filter
+	@param inputSize Number of input samples
+	@param filteredSignal Output of the filter. Must have room for
+	getMaxOutputSize(inputSize) samples. The output must not overlap the input.
+
+	@return Number of samples written to filteredSignal
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	size_t FilterResamplerFir<InType, OutType, InternalType, CoefType, L, M>::step(const InType *input, size_t inputSize, OutType *filteredSignal)
+	{
+		assert(tables);
+		size_t histSize = buffer.size() / 2;	// Number of taps of each phase
+		const std::vector<CoefType> &phaseCoeff = tables->phaseCoeff;
+		int shift = tables->coeffScaling - leftShift;
+		unsigned rightShift = shift > 0 ? static_cast<unsigned>(shift) : 0;
+		size_t outIndex = 0;
+
+		for (size_t j = 0; j < inputSize; ++j)
+		{
+			buffer[top] = input[j];
+			buffer[top + histSize] = input[j];
+			const InType *w = &buffer[top];
+
+			for (; nextPhase < L; nextPhase += M)
+			{
+				const CoefType *h = &phaseCoeff[nextPhase * histSize];
+				InternalType y{};
+				for (size_t i = 0; i < histSize; ++i)
+					y += h[i] * w[i];
+				filteredSignal[outIndex++] = limitScale<OutType>(y, rightShift);
+			}
+			nextPhase -= L;
+
+			top = (top == 0) ? histSize - 1 : top - 1;
+		}
+		return outIndex;
+	}
+
+	/***********************************************************************//**
+	Version of step() with vectors. The output vector is resized to the number of
+	samples which are ready.
+
+	@param input Input to the filter. Any size
+	@param filteredSignal Output of the filter
+
+	@return Number of output samples
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L, unsigned M>
+	size_t FilterResamplerFir<InType, OutType, InternalType, CoefType, L, M>::step(const std::vector<InType> & input, std::vector<OutType> & filteredSignal)
+	{
+		filteredSignal.resize(getMaxOutputSize(input.size()));
+		size_t numOut = step(input.data(), input.size(), filteredSignal.data());
+		filteredSignal.resize(numOut);
+		return numOut;
+	}
+
+} // End of namespace
+
+#endif
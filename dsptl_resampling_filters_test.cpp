@@ -0,0 +1,90 @@
+#include "dsptl_resampling_filters.h"
+#include "upsampling_filters.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+typedef std::complex<int16_t> Sample;
+
+std::vector<int32_t> resamplingTaps(size_t numTaps);
+template<unsigned L, unsigned M>
+bool testResamplerFir(size_t numTaps);
+
+int main()
+{
+	srand(1);
+	bool passed = testResamplerFir<3, 2>(36);
+	passed = testResamplerFir<2, 3>(36) && passed;
+	passed = testResamplerFir<5, 3>(55) && passed;
+	passed = testResamplerFir<3, 5>(33) && passed;
+	passed = testResamplerFir<4, 7>(64) && passed;
+	passed = testResamplerFir<7, 4>(77) && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Random coefficients whose sum of magnitudes is between 2^15 and 2^16. The right
+shift of FilterResamplerFir, floor(log2(sum |h|)) - round(log2(L)), is then the
+one of FilterUpsamplingFir, 15 - round(log2(L)).
+------------------------------------------------------------------------------*/
+std::vector<int32_t> resamplingTaps(size_t numTaps)
+{
+	std::vector<double> taps(numTaps);
+	double sumMagnitude = 0;
+	for (size_t n = 0; n < numTaps; ++n)
+	{
+		taps[n] = rand() % 2001 - 500;
+		sumMagnitude += std::fabs(taps[n]);
+	}
+	std::vector<int32_t> coeff(numTaps);
+	for (size_t n = 0; n < numTaps; ++n)
+		coeff[n] = static_cast<int32_t>(round(taps[n] * 45000 / sumMagnitude));
+	return coeff;
+}
+
+/*-----------------------------------------------------------------------------
+FilterResamplerFir must give the output of FilterUpsamplingFir decimated by M,
+for L and M coprime, larger and smaller than each other. The input of the
+resampler is split in blocks of arbitrary sizes, so that the decimation phase is
+carried from one block to the other.
+------------------------------------------------------------------------------*/
+template<unsigned L, unsigned M>
+bool testResamplerFir(size_t numTaps)
+{
+	std::vector<int32_t> coeff = resamplingTaps(numTaps);
+	std::vector<Sample> input(1201);
+	for (size_t n = 0; n < input.size(); ++n)
+		input[n] = Sample(static_cast<int16_t>(rand() % 60001 - 30000), static_cast<int16_t>(rand() % 60001 - 30000));
+
+	dsptl::FilterUpsamplingFir<Sample, Sample, std::complex<int32_t>, int32_t, L> upsampler(coeff);
+	std::vector<Sample> upsampled(input.size() * L);
+	upsampler.step(input, upsampled);
+	std::vector<Sample> expected;
+	for (size_t n = 0; n < upsampled.size(); n += M)
+		expected.push_back(upsampled[n]);
+
+	typedef dsptl::FilterResamplerFir<Sample, Sample, std::complex<int32_t>, int32_t, L, M> Resampler;
+	Resampler resampler(coeff);
+	std::vector<Sample> output(Resampler::getMaxOutputSize(input.size()));
+	size_t numOut = 0;
+	for (size_t start = 0; start < input.size(); )
+	{
+		size_t blockSize = std::min<size_t>(rand() % 20, input.size() - start);
+		numOut += resampler.step(&input[start], blockSize, output.data() + numOut);
+		start += blockSize;
+	}
+
+	size_t numErrors = (numOut == expected.size()) ? 0 : 1;
+	for (size_t m = 0; m < numOut && m < expected.size(); ++m)
+		numErrors += (output[m] != expected[m]) ? 1 : 0;
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FilterResamplerFir L " << L << ", M " << M << ", " << numTaps << " taps: " << numErrors
+		<< " differences with the decimated FilterUpsamplingFir: " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -0,0 +1,919 @@
+/***********************************************************************//**
+@file
+
+Vectorized kernels used by the processing blocks of the library, together
+with the run time detection of the instruction sets supported by the host.\n
+
+Every kernel has a portable scalar version. The SIMD versions are only compiled
+for x86 targets with gcc or clang and are selected at run time, so that a single
+binary can run on hosts which do not support AVX2.\n
+
+Defining the macro DSPTL_NO_SIMD before including this file forces the use of
+the scalar versions.
+
+***************************************************************************/
+
+#ifndef DSPTL_SIMD_H
+#define DSPTL_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(DSPTL_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DSPTL_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define DSPTL_X86_SIMD 0
+#endif
+
+namespace dsptl_private
+{
+
+	/***********************************************************************//**
+	Return true if the host supports the AVX2 instruction set. The detection is
+	only performed once.
+
+	***************************************************************************/
+	inline bool cpuHasAvx2()
+	{
+#if DSPTL_X86_SIMD
+		static const bool hasAvx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+		return hasAvx2;
+#else
+		return false;
+#endif
+	}
+
+	/***********************************************************************//**
+	Return true if the host supports both the AVX2 and the FMA instruction sets.
+	The detection is only performed once.
+
+	***************************************************************************/
+	inline bool cpuHasAvx2Fma()
+	{
+#if DSPTL_X86_SIMD
+		static const bool hasAvx2Fma = (__builtin_cpu_init(),
+			__builtin_cpu_supports("avx2") != 0 && __builtin_cpu_supports("fma") != 0);
+		return hasAvx2Fma;
+#else
+		return false;
+#endif
+	}
+
+	/***********************************************************************//**
+	Inner product between a vector of complex 16 bits samples and a vector of
+	real coefficients. Scalar version.
+
+	@param x Complex samples stored as interleaved real and imaginary parts
+	@param c Coefficients. Each value must fit in 16 bits
+	@param n Number of complex samples (and of coefficients)
+	@param re Real part of the result
+	@param im Imaginary part of the result
+
+	***************************************************************************/
+	inline void dotComplex16Scalar(const int16_t *x, const int32_t *c, size_t n, int32_t &re, int32_t &im)
+	{
+		int32_t accRe = 0;
+		int32_t accIm = 0;
+		for (size_t k = 0; k < n; ++k)
+		{
+			accRe += c[k] * x[2 * k];
+			accIm += c[k] * x[2 * k + 1];
+		}
+		re = accRe;
+		im = accIm;
+	}
+
+#if DSPTL_X86_SIMD
+
+#ifdef __SSE2__
+	/***********************************************************************//**
+	SSE2 version of dotComplex16Scalar(). 4 complex samples are processed at a time.\n
+
+	Each 32 bits lane of the coefficient register holds one coefficient. Masking
+	the upper half of the lane gives the pairs (c, 0) while a left shift gives
+	the pairs (0, c), so that _mm_madd_epi16 produces the exact products of the
+	coefficient with the real or the imaginary part of the sample.
+
+	***************************************************************************/
+	inline void dotComplex16Sse2(const int16_t *x, const int32_t *c, size_t n, int32_t &re, int32_t &im)
+	{
+		__m128i accRe = _mm_setzero_si128();
+		__m128i accIm = _mm_setzero_si128();
+		const __m128i lowMask = _mm_set1_epi32(0xFFFF);
+		size_t k = 0;
+		for (; k + 4 <= n; k += 4)
+		{
+			__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + 2 * k));
+			__m128i coeffs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c + k));
+			accRe = _mm_add_epi32(accRe, _mm_madd_epi16(samples, _mm_and_si128(coeffs, lowMask)));
+			accIm = _mm_add_epi32(accIm, _mm_madd_epi16(samples, _mm_slli_epi32(coeffs, 16)));
+		}
+		// Horizontal sums
+		accRe = _mm_add_epi32(accRe, _mm_shuffle_epi32(accRe, 0x4E));
+		accRe = _mm_add_epi32(accRe, _mm_shuffle_epi32(accRe, 0xB1));
+		accIm = _mm_add_epi32(accIm, _mm_shuffle_epi32(accIm, 0x4E));
+		accIm = _mm_add_epi32(accIm, _mm_shuffle_epi32(accIm, 0xB1));
+		int32_t tailRe, tailIm;
+		dotComplex16Scalar(x + 2 * k, c + k, n - k, tailRe, tailIm);
+		re = _mm_cvtsi128_si32(accRe) + tailRe;
+		im = _mm_cvtsi128_si32(accIm) + tailIm;
+	}
+#endif
+
+	/***********************************************************************//**
+	AVX2 version of dotComplex16Scalar(). 8 complex samples are processed at a time.
+
+	***************************************************************************/
+	__attribute__((target("avx2")))
+	inline void dotComplex16Avx2(const int16_t *x, const int32_t *c, size_t n, int32_t &re, int32_t &im)
+	{
+		__m256i accRe = _mm256_setzero_si256();
+		__m256i accIm = _mm256_setzero_si256();
+		const __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+		size_t k = 0;
+		for (; k + 8 <= n; k += 8)
+		{
+			__m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + 2 * k));
+			__m256i coeffs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c + k));
+			accRe = _mm256_add_epi32(accRe, _mm256_madd_epi16(samples, _mm256_and_si256(coeffs, lowMask)));
+			accIm = _mm256_add_epi32(accIm, _mm256_madd_epi16(samples, _mm256_slli_epi32(coeffs, 16)));
+		}
+		// Horizontal sums
+		__m128i sumRe = _mm_add_epi32(_mm256_castsi256_si128(accRe), _mm256_extracti128_si256(accRe, 1));
+		__m128i sumIm = _mm_add_epi32(_mm256_castsi256_si128(accIm), _mm256_extracti128_si256(accIm, 1));
+		sumRe = _mm_add_epi32(sumRe, _mm_shuffle_epi32(sumRe, 0x4E));
+		sumRe = _mm_add_epi32(sumRe, _mm_shuffle_epi32(sumRe, 0xB1));
+		sumIm = _mm_add_epi32(sumIm, _mm_shuffle_epi32(sumIm, 0x4E));
+		sumIm = _mm_add_epi32(sumIm, _mm_shuffle_epi32(sumIm, 0xB1));
+		int32_t tailRe, tailIm;
+		dotComplex16Scalar(x + 2 * k, c + k, n - k, tailRe, tailIm);
+		re = _mm_cvtsi128_si32(sumRe) + tailRe;
+		im = _mm_cvtsi128_si32(sumIm) + tailIm;
+	}
+
+#endif
+
+	/***********************************************************************//**
+	Inner product between complex 16 bits samples and real coefficients. The
+	fastest version supported by the host is used.\n
+
+	All versions return exactly the same result as long as the coefficients fit
+	in 16 bits.
+
+	***************************************************************************/
+	inline void dotComplex16(const int16_t *x, const int32_t *c, size_t n, int32_t &re, int32_t &im)
+	{
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2())
+		{
+			dotComplex16Avx2(x, c, n, re, im);
+			return;
+		}
+#ifdef __SSE2__
+		dotComplex16Sse2(x, c, n, re, im);
+		return;
+#endif
+#endif
+		dotComplex16Scalar(x, c, n, re, im);
+	}
+
+	/***********************************************************************//**
+	Estimate of the speed of dotComplex16() relative to the scalar direct form of
+	the FIR filters, used to choose between the direct form and the fast
+	convolution. The AVX2 and SSE2 versions are both estimated to be about 4 times
+	faster, the loads of the samples being the limit. Without the vectorized
+	versions, dotComplex16() is the scalar direct form.
+
+	***************************************************************************/
+	const double dotComplex16Speedup = DSPTL_X86_SIMD ? 4.0 : 1.0;
+
+	/***********************************************************************//**
+	Inner product between a vector of complex 16 bits samples and a vector of
+	complex 16 bits coefficients. Scalar version.\n
+
+	Each coefficient c is given as two pairs of 16 bits values: (c.real, -c.imag)
+	in cRe and (c.imag, c.real) in cIm. The real and imaginary parts of the product
+	of a sample with c are then the inner products of the sample with each pair.
+	The products are accumulated modulo 2^32.
+
+	@param x Complex samples stored as interleaved real and imaginary parts
+	@param cRe Pairs (c.real, -c.imag) of the n coefficients
+	@param cIm Pairs (c.imag, c.real) of the n coefficients
+	@param n Number of complex samples (and of coefficients)
+	@param re Real part of the result
+	@param im Imaginary part of the result
+
+	***************************************************************************/
+	inline void dotComplexByComplex16Scalar(const int16_t *x, const int16_t *cRe, const int16_t *cIm, size_t n,
+		int32_t &re, int32_t &im)
+	{
+		uint32_t accRe = 0;
+		uint32_t accIm = 0;
+		for (size_t k = 0; k < 2 * n; k += 2)
+		{
+			accRe += static_cast<uint32_t>(x[k] * cRe[k]) + static_cast<uint32_t>(x[k + 1] * cRe[k + 1]);
+			accIm += static_cast<uint32_t>(x[k] * cIm[k]) + static_cast<uint32_t>(x[k + 1] * cIm[k + 1]);
+		}
+		re = static_cast<int32_t>(accRe);
+		im = static_cast<int32_t>(accIm);
+	}
+
+#if DSPTL_X86_SIMD
+
+#ifdef __SSE2__
+	/***********************************************************************//**
+	SSE2 version of dotComplexByComplex16Scalar(). 4 complex samples are
+	processed at a time: _mm_madd_epi16 computes the inner product of each sample
+	with its pair of coefficients.
+
+	***************************************************************************/
+	inline void dotComplexByComplex16Sse2(const int16_t *x, const int16_t *cRe, const int16_t *cIm, size_t n,
+		int32_t &re, int32_t &im)
+	{
+		__m128i accRe = _mm_setzero_si128();
+		__m128i accIm = _mm_setzero_si128();
+		size_t k = 0;
+		for (; k + 4 <= n; k += 4)
+		{
+			__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + 2 * k));
+			__m128i pairsRe = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cRe + 2 * k));
+			__m128i pairsIm = _mm_loadu_si128(reinterpret_cast<const __m128i *>(cIm + 2 * k));
+			accRe = _mm_add_epi32(accRe, _mm_madd_epi16(samples, pairsRe));
+			accIm = _mm_add_epi32(accIm, _mm_madd_epi16(samples, pairsIm));
+		}
+		// Horizontal sums
+		accRe = _mm_add_epi32(accRe, _mm_shuffle_epi32(accRe, 0x4E));
+		accRe = _mm_add_epi32(accRe, _mm_shuffle_epi32(accRe, 0xB1));
+		accIm = _mm_add_epi32(accIm, _mm_shuffle_epi32(accIm, 0x4E));
+		accIm = _mm_add_epi32(accIm, _mm_shuffle_epi32(accIm, 0xB1));
+		int32_t tailRe, tailIm;
+		dotComplexByComplex16Scalar(x + 2 * k, cRe + 2 * k, cIm + 2 * k, n - k, tailRe, tailIm);
+		re = static_cast<int32_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(accRe)) + static_cast<uint32_t>(tailRe));
+		im = static_cast<int32_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(accIm)) + static_cast<uint32_t>(tailIm));
+	}
+#endif
+
+	/***********************************************************************//**
+	AVX2 version of dotComplexByComplex16Scalar(). 8 complex samples are
+	processed at a time.
+
+	***************************************************************************/
+	__attribute__((target("avx2")))
+	inline void dotComplexByComplex16Avx2(const int16_t *x, const int16_t *cRe, const int16_t *cIm, size_t n,
+		int32_t &re, int32_t &im)
+	{
+		__m256i accRe = _mm256_setzero_si256();
+		__m256i accIm = _mm256_setzero_si256();
+		size_t k = 0;
+		for (; k + 8 <= n; k += 8)
+		{
+			__m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + 2 * k));
+			__m256i pairsRe = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cRe + 2 * k));
+			__m256i pairsIm = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(cIm + 2 * k));
+			accRe = _mm256_add_epi32(accRe, _mm256_madd_epi16(samples, pairsRe));
+			accIm = _mm256_add_epi32(accIm, _mm256_madd_epi16(samples, pairsIm));
+		}
+		// Horizontal sums
+		__m128i sumRe = _mm_add_epi32(_mm256_castsi256_si128(accRe), _mm256_extracti128_si256(accRe, 1));
+		__m128i sumIm = _mm_add_epi32(_mm256_castsi256_si128(accIm), _mm256_extracti128_si256(accIm, 1));
+		sumRe = _mm_add_epi32(sumRe, _mm_shuffle_epi32(sumRe, 0x4E));
+		sumRe = _mm_add_epi32(sumRe, _mm_shuffle_epi32(sumRe, 0xB1));
+		sumIm = _mm_add_epi32(sumIm, _mm_shuffle_epi32(sumIm, 0x4E));
+		sumIm = _mm_add_epi32(sumIm, _mm_shuffle_epi32(sumIm, 0xB1));
+		int32_t tailRe, tailIm;
+		dotComplexByComplex16Scalar(x + 2 * k, cRe + 2 * k, cIm + 2 * k, n - k, tailRe, tailIm);
+		re = static_cast<int32_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(sumRe)) + static_cast<uint32_t>(tailRe));
+		im = static_cast<int32_t>(static_cast<uint32_t>(_mm_cvtsi128_si32(sumIm)) + static_cast<uint32_t>(tailIm));
+	}
+
+#endif
+
+	/***********************************************************************//**
+	Inner product between complex 16 bits samples and complex 16 bits
+	coefficients. The fastest version supported by the host is used. All versions
+	return the same result.
+
+	***************************************************************************/
+	inline void dotComplexByComplex16(const int16_t *x, const int16_t *cRe, const int16_t *cIm, size_t n,
+		int32_t &re, int32_t &im)
+	{
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2())
+		{
+			dotComplexByComplex16Avx2(x, cRe, cIm, n, re, im);
+			return;
+		}
+#ifdef __SSE2__
+		dotComplexByComplex16Sse2(x, cRe, cIm, n, re, im);
+		return;
+#endif
+#endif
+		dotComplexByComplex16Scalar(x, cRe, cIm, n, re, im);
+	}
+
+	/***********************************************************************//**
+	Inner products of the same complex 16 bits samples with several sets of
+	complex 16 bits coefficients. Scalar version.\n
+
+	The pairs of set q start at cRe + 2 n q and cIm + 2 n q. See
+	dotComplexByComplex16Scalar() for the format of the pairs.
+
+	@param x Complex samples stored as interleaved real and imaginary parts
+	@param cRe Pairs (c.real, -c.imag) of the numSets sets of n coefficients
+	@param cIm Pairs (c.imag, c.real) of the numSets sets of n coefficients
+	@param n Number of complex samples (and of coefficients of each set)
+	@param numSets Number of sets of coefficients
+	@param re Real parts of the numSets results
+	@param im Imaginary parts of the numSets results
+
+	***************************************************************************/
+	inline void dotComplexByComplex16SetsScalar(const int16_t *x, const int16_t *cRe, const int16_t *cIm, size_t n,
+		size_t numSets, int32_t *re, int32_t *im)
+	{
+		for (size_t q = 0; q < numSets; ++q)
+			dotComplexByComplex16Scalar(x, cRe + 2 * n * q, cIm + 2 * n * q, n, re[q], im[q]);
+	}
+
+#if DSPTL_X86_SIMD
+
+	/// Sum of the 8 lanes of a register of 32 bits values, modulo 2^32
+	__attribute__((target("avx2")))
+	inline int32_t horizontalSum32Avx2(__m256i acc)
+	{
+		__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+		sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+		return _mm_cvtsi128_si32(sum);
+	}
+
+	/***********************************************************************//**
+	AVX2 version of dotComplexByComplex16SetsScalar(). The sets are processed 4 at
+	a time: each register of 8 samples is loaded once and multiplied by the pairs
+	of the 4 sets, with 8 accumulators kept in registers. The remaining sets use
+	dotComplexByComplex16Avx2().
+
+	***************************************************************************/
+	__attribute__((target("avx2")))
+	inline void dotComplexByComplex16SetsAvx2(const int16_t *x, const int16_t *cRe, const int16_t *cIm, size_t n,
+		size_t numSets, int32_t *re, int32_t *im)
+	{
+		size_t q = 0;
+		for (; q + 4 <= numSets; q += 4)
+		{
+			const int16_t *r0 = cRe + 2 * n * q;
+			const int16_t *i0 = cIm + 2 * n * q;
+			__m256i accRe0 = _mm256_setzero_si256(), accIm0 = _mm256_setzero_si256();
+			__m256i accRe1 = _mm256_setzero_si256(), accIm1 = _mm256_setzero_si256();
+			__m256i accRe2 = _mm256_setzero_si256(), accIm2 = _mm256_setzero_si256();
+			__m256i accRe3 = _mm256_setzero_si256(), accIm3 = _mm256_setzero_si256();
+			size_t k = 0;
+			for (; k + 8 <= n; k += 8)
+			{
+				__m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + 2 * k));
+				const int16_t *r = r0 + 2 * k;
+				const int16_t *i = i0 + 2 * k;
+				accRe0 = _mm256_add_epi32(accRe0, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r))));
+				accIm0 = _mm256_add_epi32(accIm0, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(i))));
+				accRe1 = _mm256_add_epi32(accRe1, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r + 2 * n))));
+				accIm1 = _mm256_add_epi32(accIm1, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(i + 2 * n))));
+				accRe2 = _mm256_add_epi32(accRe2, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r + 4 * n))));
+				accIm2 = _mm256_add_epi32(accIm2, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(i + 4 * n))));
+				accRe3 = _mm256_add_epi32(accRe3, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r + 6 * n))));
+				accIm3 = _mm256_add_epi32(accIm3, _mm256_madd_epi16(samples, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(i + 6 * n))));
+			}
+			int32_t tailRe[4], tailIm[4];
+			for (size_t j = 0; j < 4; ++j)
+				dotComplexByComplex16Scalar(x + 2 * k, r0 + 2 * n * j + 2 * k, i0 + 2 * n * j + 2 * k, n - k, tailRe[j], tailIm[j]);
+			re[q] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accRe0)) + static_cast<uint32_t>(tailRe[0]));
+			im[q] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accIm0)) + static_cast<uint32_t>(tailIm[0]));
+			re[q + 1] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accRe1)) + static_cast<uint32_t>(tailRe[1]));
+			im[q + 1] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accIm1)) + static_cast<uint32_t>(tailIm[1]));
+			re[q + 2] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accRe2)) + static_cast<uint32_t>(tailRe[2]));
+			im[q + 2] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accIm2)) + static_cast<uint32_t>(tailIm[2]));
+			re[q + 3] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accRe3)) + static_cast<uint32_t>(tailRe[3]));
+			im[q + 3] = static_cast<int32_t>(static_cast<uint32_t>(horizontalSum32Avx2(accIm3)) + static_cast<uint32_t>(tailIm[3]));
+		}
+		for (; q < numSets; ++q)
+			dotComplexByComplex16Avx2(x, cRe + 2 * n * q, cIm + 2 * n * q, n, re[q], im[q]);
+	}
+
+#endif
+
+	/***********************************************************************//**
+	Inner products of the same complex 16 bits samples with several sets of
+	complex 16 bits coefficients. The fastest version supported by the host is
+	used. All versions return the same results.
+
+	***************************************************************************/
+	inline void dotComplexByComplex16Sets(const int16_t *x, const int16_t *cRe, const int16_t *cIm, size_t n,
+		size_t numSets, int32_t *re, int32_t *im)
+	{
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2())
+		{
+			dotComplexByComplex16SetsAvx2(x, cRe, cIm, n, numSets, re, im);
+			return;
+		}
+#endif
+		for (size_t q = 0; q < numSets; ++q)
+			dotComplexByComplex16(x, cRe + 2 * n * q, cIm + 2 * n * q, n, re[q], im[q]);
+	}
+
+	/***********************************************************************//**
+	Inner products of the same real coefficients with the samples of several
+	channels. Scalar version.\n
+
+	The samples are channel interleaved: tap n of channel ch is the complex sample
+	n * stride + ch.
+
+	@param x Complex samples stored as interleaved real and imaginary parts
+	@param stride Distance between two taps of a channel, in complex samples
+	@param c Coefficients. Each value must fit in 16 bits
+	@param n Number of coefficients
+	@param numChannels Number of channels. Must not be larger than stride
+	@param re Real parts of the results, one per channel
+	@param im Imaginary parts of the results, one per channel
+
+	***************************************************************************/
+	inline void dotComplex16ChannelsScalar(const int16_t *x, size_t stride, const int32_t *c, size_t n, size_t numChannels,
+		int32_t *re, int32_t *im)
+	{
+		for (size_t ch = 0; ch < numChannels; ++ch)
+		{
+			re[ch] = 0;
+			im[ch] = 0;
+		}
+		for (size_t k = 0; k < n; ++k)
+		{
+			const int16_t *tap = x + 2 * k * stride;
+			for (size_t ch = 0; ch < numChannels; ++ch)
+			{
+				re[ch] += c[k] * tap[2 * ch];
+				im[ch] += c[k] * tap[2 * ch + 1];
+			}
+		}
+	}
+
+#if DSPTL_X86_SIMD
+
+#ifdef __SSE2__
+	/***********************************************************************//**
+	SSE2 version of dotComplex16ChannelsScalar(). 4 channels are processed by each
+	instruction with the coefficient broadcast to all lanes, using the same
+	masking as dotComplex16Sse2().
+
+	***************************************************************************/
+	inline void dotComplex16ChannelsSse2(const int16_t *x, size_t stride, const int32_t *c, size_t n, size_t numChannels,
+		int32_t *re, int32_t *im)
+	{
+		size_t ch = 0;
+		for (; ch + 4 <= numChannels; ch += 4)
+		{
+			__m128i accRe = _mm_setzero_si128();
+			__m128i accIm = _mm_setzero_si128();
+			for (size_t k = 0; k < n; ++k)
+			{
+				__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(x + 2 * (k * stride + ch)));
+				accRe = _mm_add_epi32(accRe, _mm_madd_epi16(samples, _mm_set1_epi32(c[k] & 0xFFFF)));
+				accIm = _mm_add_epi32(accIm, _mm_madd_epi16(samples, _mm_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(c[k]) << 16))));
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(re + ch), accRe);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(im + ch), accIm);
+		}
+		if (ch < numChannels)
+			dotComplex16ChannelsScalar(x + 2 * ch, stride, c, n, numChannels - ch, re + ch, im + ch);
+	}
+#endif
+
+	/***********************************************************************//**
+	AVX2 version of dotComplex16ChannelsScalar(). 8 channels are processed by each
+	instruction.
+
+	***************************************************************************/
+	__attribute__((target("avx2")))
+	inline void dotComplex16ChannelsAvx2(const int16_t *x, size_t stride, const int32_t *c, size_t n, size_t numChannels,
+		int32_t *re, int32_t *im)
+	{
+		size_t ch = 0;
+		for (; ch + 8 <= numChannels; ch += 8)
+		{
+			__m256i accRe = _mm256_setzero_si256();
+			__m256i accIm = _mm256_setzero_si256();
+			for (size_t k = 0; k < n; ++k)
+			{
+				__m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + 2 * (k * stride + ch)));
+				accRe = _mm256_add_epi32(accRe, _mm256_madd_epi16(samples, _mm256_set1_epi32(c[k] & 0xFFFF)));
+				accIm = _mm256_add_epi32(accIm, _mm256_madd_epi16(samples, _mm256_set1_epi32(static_cast<int32_t>(static_cast<uint32_t>(c[k]) << 16))));
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(re + ch), accRe);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(im + ch), accIm);
+		}
+		if (ch < numChannels)
+			dotComplex16ChannelsScalar(x + 2 * ch, stride, c, n, numChannels - ch, re + ch, im + ch);
+	}
+
+#endif
+
+	/***********************************************************************//**
+	Inner products of the same real coefficients with the complex 16 bits samples
+	of several channels. The fastest version supported by the host is used.
+
+	***************************************************************************/
+	inline void dotComplex16Channels(const int16_t *x, size_t stride, const int32_t *c, size_t n, size_t numChannels,
+		int32_t *re, int32_t *im)
+	{
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2())
+		{
+			dotComplex16ChannelsAvx2(x, stride, c, n, numChannels, re, im);
+			return;
+		}
+#ifdef __SSE2__
+		dotComplex16ChannelsSse2(x, stride, c, n, numChannels, re, im);
+		return;
+#endif
+#endif
+		dotComplex16ChannelsScalar(x, stride, c, n, numChannels, re, im);
+	}
+
+	/***********************************************************************//**
+	Inner product between real floating point samples and coefficients. Scalar
+	version.
+
+	@param x Samples
+	@param c Coefficients
+	@param n Number of samples (and of coefficients)
+
+	***************************************************************************/
+	template<class T>
+	T dotRealScalar(const T *x, const T *c, size_t n)
+	{
+		T acc = 0;
+		for (size_t k = 0; k < n; ++k)
+			acc += c[k] * x[k];
+		return acc;
+	}
+
+	/***********************************************************************//**
+	Inner product between complex floating point samples and real coefficients.
+	Scalar version.
+
+	@param x Complex samples stored as interleaved real and imaginary parts
+	@param c Coefficients
+	@param n Number of complex samples (and of coefficients)
+	@param re Real part of the result
+	@param im Imaginary part of the result
+
+	***************************************************************************/
+	template<class T>
+	void dotComplexScalar(const T *x, const T *c, size_t n, T &re, T &im)
+	{
+		T accRe = 0;
+		T accIm = 0;
+		for (size_t k = 0; k < n; ++k)
+		{
+			accRe += c[k] * x[2 * k];
+			accIm += c[k] * x[2 * k + 1];
+		}
+		re = accRe;
+		im = accIm;
+	}
+
+#if DSPTL_X86_SIMD
+
+	/***********************************************************************//**
+	AVX2 and FMA version of dotRealScalar() for float. 16 samples are processed
+	at a time with two accumulators to hide the latency of the FMA instruction.
+
+	***************************************************************************/
+	__attribute__((target("avx2,fma")))
+	inline float dotRealFma(const float *x, const float *c, size_t n)
+	{
+		__m256 acc0 = _mm256_setzero_ps();
+		__m256 acc1 = _mm256_setzero_ps();
+		size_t k = 0;
+		for (; k + 16 <= n; k += 16)
+		{
+			acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(c + k), _mm256_loadu_ps(x + k), acc0);
+			acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(c + k + 8), _mm256_loadu_ps(x + k + 8), acc1);
+		}
+		for (; k + 8 <= n; k += 8)
+			acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(c + k), _mm256_loadu_ps(x + k), acc0);
+		// Horizontal sum
+		acc0 = _mm256_add_ps(acc0, acc1);
+		__m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+		return _mm_cvtss_f32(sum) + dotRealScalar(x + k, c + k, n - k);
+	}
+
+	/***********************************************************************//**
+	AVX2 and FMA version of dotRealScalar() for double. 8 samples are processed
+	at a time.
+
+	***************************************************************************/
+	__attribute__((target("avx2,fma")))
+	inline double dotRealFma(const double *x, const double *c, size_t n)
+	{
+		__m256d acc0 = _mm256_setzero_pd();
+		__m256d acc1 = _mm256_setzero_pd();
+		size_t k = 0;
+		for (; k + 8 <= n; k += 8)
+		{
+			acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(c + k), _mm256_loadu_pd(x + k), acc0);
+			acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(c + k + 4), _mm256_loadu_pd(x + k + 4), acc1);
+		}
+		for (; k + 4 <= n; k += 4)
+			acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(c + k), _mm256_loadu_pd(x + k), acc0);
+		// Horizontal sum
+		acc0 = _mm256_add_pd(acc0, acc1);
+		__m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+		sum = _mm_add_sd(sum, _mm_unpackhi_pd(sum, sum));
+		return _mm_cvtsd_f64(sum) + dotRealScalar(x + k, c + k, n - k);
+	}
+
+	/***********************************************************************//**
+	AVX2 and FMA version of dotComplexScalar() for float. 4 complex samples are
+	processed at a time. Each coefficient is duplicated in two adjacent lanes so
+	that it multiplies both the real and the imaginary part of its sample: the
+	even lanes of the accumulator hold the real parts and the odd lanes the
+	imaginary parts.
+
+	***************************************************************************/
+	__attribute__((target("avx2,fma")))
+	inline void dotComplexFma(const float *x, const float *c, size_t n, float &re, float &im)
+	{
+		__m256 acc = _mm256_setzero_ps();
+		const __m256i duplicate = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+		size_t k = 0;
+		for (; k + 4 <= n; k += 4)
+		{
+			__m256 coeffs = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(c + k)), duplicate);
+			acc = _mm256_fmadd_ps(coeffs, _mm256_loadu_ps(x + 2 * k), acc);
+		}
+		// Horizontal sums of the even and odd lanes
+		__m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		float tailRe, tailIm;
+		dotComplexScalar(x + 2 * k, c + k, n - k, tailRe, tailIm);
+		re = _mm_cvtss_f32(sum) + tailRe;
+		im = _mm_cvtss_f32(_mm_shuffle_ps(sum, sum, 0x55)) + tailIm;
+	}
+
+	/***********************************************************************//**
+	AVX2 and FMA version of dotComplexScalar() for double. 2 complex samples are
+	processed at a time.
+
+	***************************************************************************/
+	__attribute__((target("avx2,fma")))
+	inline void dotComplexFma(const double *x, const double *c, size_t n, double &re, double &im)
+	{
+		__m256d acc = _mm256_setzero_pd();
+		size_t k = 0;
+		for (; k + 2 <= n; k += 2)
+		{
+			__m256d coeffs = _mm256_permute4x64_pd(_mm256_castpd128_pd256(_mm_loadu_pd(c + k)), 0x50);
+			acc = _mm256_fmadd_pd(coeffs, _mm256_loadu_pd(x + 2 * k), acc);
+		}
+		__m128d sum = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+		double tailRe, tailIm;
+		dotComplexScalar(x + 2 * k, c + k, n - k, tailRe, tailIm);
+		re = _mm_cvtsd_f64(sum) + tailRe;
+		im = _mm_cvtsd_f64(_mm_unpackhi_pd(sum, sum)) + tailIm;
+	}
+
+#endif
+
+	/***********************************************************************//**
+	Inner product between real floating point samples and coefficients. The FMA
+	version is used when the host supports it. The result may differ from the
+	scalar version in the last bits since the order of the additions differs.
+
+	***************************************************************************/
+	template<class T>
+	T dotReal(const T *x, const T *c, size_t n)
+	{
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2Fma())
+			return dotRealFma(x, c, n);
+#endif
+		return dotRealScalar(x, c, n);
+	}
+
+	/***********************************************************************//**
+	Inner product between complex floating point samples and real coefficients.
+	The FMA version is used when the host supports it.
+
+	***************************************************************************/
+	template<class T>
+	void dotComplex(const T *x, const T *c, size_t n, T &re, T &im)
+	{
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2Fma())
+		{
+			dotComplexFma(x, c, n, re, im);
+			return;
+		}
+#endif
+		dotComplexScalar(x, c, n, re, im);
+	}
+
+	/***********************************************************************//**
+	Cascade of biquad sections in transposed direct form II applied to several
+	channels. Scalar version.\n
+
+	The channels are interleaved with a distance of stride values: sample t of
+	channel ch is in[t * stride + ch]. The two state variables of section s are
+	stored at state[2 * s * stride + ch] and state[(2 * s + 1) * stride + ch], so
+	that each operation applies to contiguous channels.
+
+	@param coeff 5 coefficients b0, b1, b2, a1, a2 per section
+	@param numSections Number of sections
+	@param state State variables, updated
+	@param stride Distance between two samples or two state variables of a channel
+	@param numChannels Number of channels processed, from the first one
+	@param in Input samples
+	@param out Output samples. Can be the same location as the input
+	@param numSamples Number of samples of each channel
+
+	***************************************************************************/
+	template<class T>
+	void biquadChannelsScalar(const T *coeff, size_t numSections, T *state, size_t stride, size_t numChannels,
+		const T *in, T *out, size_t numSamples)
+	{
+		for (size_t t = 0; t < numSamples; ++t)
+		{
+			for (size_t ch = 0; ch < numChannels; ++ch)
+				out[t * stride + ch] = in[t * stride + ch];
+			for (size_t s = 0; s < numSections; ++s)
+			{
+				const T *c = coeff + 5 * s;
+				T *s1 = state + 2 * s * stride;
+				T *s2 = s1 + stride;
+				T *x = out + t * stride;
+				for (size_t ch = 0; ch < numChannels; ++ch)
+				{
+					T y = c[0] * x[ch] + s1[ch];
+					s1[ch] = c[1] * x[ch] - c[3] * y + s2[ch];
+					s2[ch] = c[2] * x[ch] - c[4] * y;
+					x[ch] = y;
+				}
+			}
+		}
+	}
+
+#if DSPTL_X86_SIMD
+
+	/***********************************************************************//**
+	AVX2 and FMA version of biquadChannelsScalar() for float. 8 channels are
+	processed by each instruction. numChannels must be a multiple of 8.
+
+	***************************************************************************/
+	__attribute__((target("avx2,fma")))
+	inline void biquadChannelsFma(const float *coeff, size_t numSections, float *state, size_t stride, size_t numChannels,
+		const float *in, float *out, size_t numSamples)
+	{
+		for (size_t t = 0; t < numSamples; ++t)
+		{
+			for (size_t ch = 0; ch < numChannels; ch += 8)
+			{
+				__m256 x = _mm256_loadu_ps(in + t * stride + ch);
+				for (size_t s = 0; s < numSections; ++s)
+				{
+					const float *c = coeff + 5 * s;
+					float *s1 = state + 2 * s * stride + ch;
+					float *s2 = s1 + stride;
+					__m256 y = _mm256_fmadd_ps(_mm256_set1_ps(c[0]), x, _mm256_loadu_ps(s1));
+					__m256 next1 = _mm256_fmadd_ps(_mm256_set1_ps(c[1]), x, _mm256_loadu_ps(s2));
+					_mm256_storeu_ps(s1, _mm256_fnmadd_ps(_mm256_set1_ps(c[3]), y, next1));
+					__m256 next2 = _mm256_mul_ps(_mm256_set1_ps(c[2]), x);
+					_mm256_storeu_ps(s2, _mm256_fnmadd_ps(_mm256_set1_ps(c[4]), y, next2));
+					x = y;
+				}
+				_mm256_storeu_ps(out + t * stride + ch, x);
+			}
+		}
+	}
+
+#endif
+
+	/***********************************************************************//**
+	Cascade of biquad sections applied to several float channels. The FMA version
+	is used for the groups of 8 channels when the host supports it.
+
+	***************************************************************************/
+	inline void biquadChannels(const float *coeff, size_t numSections, float *state, size_t stride, size_t numChannels,
+		const float *in, float *out, size_t numSamples)
+	{
+		size_t ch = 0;
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2Fma() && numChannels >= 8)
+		{
+			ch = numChannels / 8 * 8;
+			biquadChannelsFma(coeff, numSections, state, stride, ch, in, out, numSamples);
+		}
+#endif
+		if (ch < numChannels)
+			biquadChannelsScalar(coeff, numSections, state + ch, stride, numChannels - ch, in + ch, out + ch, numSamples);
+	}
+
+	/***********************************************************************//**
+	Inclusive prefix sum of 32 bits values, in place. Scalar version.\n
+
+	The additions are performed modulo 2^32, so the result is exact for signed
+	and unsigned values as long as the final values fit in 32 bits.
+
+	@param data Values replaced by init plus the sum of the values up to and
+	including their position
+	@param n Number of values
+	@param init Value added to all the sums
+	@return Last sum, or init if n is 0
+
+	***************************************************************************/
+	inline uint32_t prefixSum32Scalar(uint32_t *data, size_t n, uint32_t init)
+	{
+		uint32_t acc = init;
+		for (size_t k = 0; k < n; ++k)
+		{
+			acc += data[k];
+			data[k] = acc;
+		}
+		return acc;
+	}
+
+#if DSPTL_X86_SIMD
+
+#ifdef __SSE2__
+	/***********************************************************************//**
+	SSE2 version of prefixSum32Scalar(). The sum of a register of 4 values is
+	computed in two steps by adding the register shifted by 1 then by 2 lanes.
+	The last sum is then broadcast and added to the next register.
+
+	***************************************************************************/
+	inline uint32_t prefixSum32Sse2(uint32_t *data, size_t n, uint32_t init)
+	{
+		__m128i carry = _mm_set1_epi32(static_cast<int32_t>(init));
+		size_t k = 0;
+		for (; k + 4 <= n; k += 4)
+		{
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + k));
+			x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+			x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+			x = _mm_add_epi32(x, carry);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(data + k), x);
+			carry = _mm_shuffle_epi32(x, 0xFF);
+		}
+		return prefixSum32Scalar(data + k, n - k, static_cast<uint32_t>(_mm_cvtsi128_si32(carry)));
+	}
+#endif
+
+	/***********************************************************************//**
+	AVX2 version of prefixSum32Scalar(). Each 128 bits half is summed like in the
+	SSE2 version, then the last sum of the lower half is added to the upper half.
+
+	***************************************************************************/
+	__attribute__((target("avx2")))
+	inline uint32_t prefixSum32Avx2(uint32_t *data, size_t n, uint32_t init)
+	{
+		__m256i carry = _mm256_set1_epi32(static_cast<int32_t>(init));
+		const __m256i lane3 = _mm256_set1_epi32(3);
+		const __m256i lane7 = _mm256_set1_epi32(7);
+		size_t k = 0;
+		for (; k + 8 <= n; k += 8)
+		{
+			__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + k));
+			x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+			x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+			// Sum of the lower half added to the upper half only
+			__m256i low = _mm256_permutevar8x32_epi32(x, lane3);
+			x = _mm256_add_epi32(x, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xF0));
+			x = _mm256_add_epi32(x, carry);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(data + k), x);
+			carry = _mm256_permutevar8x32_epi32(x, lane7);
+		}
+		return prefixSum32Scalar(data + k, n - k, static_cast<uint32_t>(_mm256_extract_epi32(carry, 0)));
+	}
+
+#endif
+
+	/***********************************************************************//**
+	Inclusive prefix sum of 32 bits values, in place. The fastest version
+	supported by the host is used. All versions return the same result.
+
+	***************************************************************************/
+	inline uint32_t prefixSum32(uint32_t *data, size_t n, uint32_t init)
+	{
+#if DSPTL_X86_SIMD
+		if (cpuHasAvx2())
+			return prefixSum32Avx2(data, n, init);
+#ifdef __SSE2__
+		return prefixSum32Sse2(data, n, init);
+#endif
+#endif
+		return prefixSum32Scalar(data, n, init);
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,365 @@
+/***********************************************************************//**
+@file
+
+Sums over a sliding window: moving sum, moving average, energy and power.\n
+
+The sum over the last L samples is updated in O(1) per sample by adding the
+new sample and subtracting the one which leaves the window. For a block of
+samples, the differences between the entering and leaving samples are computed
+first, then the sums are their prefix sum, which is vectorized for 32 bits
+accumulators (see dsptl_private::prefixSum32()).\n
+
+With integer accumulators the result is exact: it is the same as the sum
+recomputed over the whole window, as long as this sum fits in the accumulator.
+With floating point accumulators, the rounding errors of the updates accumulate
+over time.
+
+***************************************************************************/
+
+#ifndef DSPTL_SLIDING_WINDOW_H
+#define DSPTL_SLIDING_WINDOW_H
+
+#include <cassert>
+#include <cstdint>
+#include <complex>
+#include <vector>
+#include "dsptl_simd.h"
+
+namespace dsptl_private
+{
+
+	/***********************************************************************//**
+	Inclusive prefix sum in place. The 32 bits integer versions use the vectorized
+	kernels.
+
+	@return Last sum, or init if n is 0
+
+	***************************************************************************/
+	template<class T>
+	T prefixSum(T *data, size_t n, T init)
+	{
+		T acc = init;
+		for (size_t k = 0; k < n; ++k)
+		{
+			acc += data[k];
+			data[k] = acc;
+		}
+		return acc;
+	}
+
+	inline uint32_t prefixSum(uint32_t *data, size_t n, uint32_t init)
+	{
+		return prefixSum32(data, n, init);
+	}
+
+	inline int32_t prefixSum(int32_t *data, size_t n, int32_t init)
+	{
+		return static_cast<int32_t>(prefixSum32(reinterpret_cast<uint32_t *>(data), n, static_cast<uint32_t>(init)));
+	}
+
+	/// Squared magnitude of a sample computed with the type of the accumulator
+	template<class AccType, class T>
+	AccType squaredMagnitude(const T &x)
+	{
+		return static_cast<AccType>(x) * static_cast<AccType>(x);
+	}
+
+	template<class AccType, class T>
+	AccType squaredMagnitude(const std::complex<T> &x)
+	{
+		return static_cast<AccType>(x.real()) * static_cast<AccType>(x.real())
+			+ static_cast<AccType>(x.imag()) * static_cast<AccType>(x.imag());
+	}
+
+}
+
+namespace dsptl
+{
+
+	// BASE CLASS
+
+	/*-----------------------------------------------------------------------------
+	Base class of the sliding window blocks
+
+	@tparam AccType Type of the accumulator
+
+	The class keeps the last L values in a circular buffer together with their sum.
+	The derived classes convert the input samples to values (the sample itself or its
+	squared magnitude) and the sums to outputs.\n
+
+	Upon construction and reset, the window is filled with zeros: the first L - 1
+	outputs are the sums of the available samples.
+	------------------------------------------------------------------------------*/
+	template<class AccType>
+	class _SlidingWindow
+	{
+	public:
+		_SlidingWindow(size_t windowLength);
+		void reset();
+		/// Number of samples of the window
+		size_t getLength() const { return length; }
+		/// Sum of the values currently in the window
+		AccType getSum() const { return sum; }
+	protected:
+		void update(const AccType *values, size_t size, AccType *sums);
+
+		size_t length;				///< Number of samples of the window
+		std::vector<AccType> ring;	///< Last length values
+		size_t oldest;				///< Position of the oldest value in ring
+		AccType sum;				///< Sum of the values of ring
+		std::vector<AccType> values;	///< Values of the current block
+	};
+
+	/***********************************************************************//**
+	Constructor
+
+	@param windowLength Number of samples of the window. Must be at least 1
+
+	***************************************************************************/
+	template<class AccType>
+	_SlidingWindow<AccType>::_SlidingWindow(size_t windowLength)
+		: length(windowLength), ring(windowLength), oldest(0), sum()
+	{
+		assert(windowLength > 0);
+	}
+
+	/***********************************************************************//**
+	Fill the window with zeros
+
+	***************************************************************************/
+	template<class AccType>
+	void _SlidingWindow<AccType>::reset()
+	{
+		for (size_t k = 0; k < ring.size(); ++k)
+			ring[k] = AccType();
+		oldest = 0;
+		sum = AccType();
+	}
+
+	/***********************************************************************//**
+	Push a block of values in the window and compute the sum of the window after
+	each of them.\n
+
+	The difference between each value and the value which leaves the window is
+	written to sums, taken from the circular buffer for the first L values and
+	from the block itself for the following ones. The circular buffer is then
+	updated with the last values of the block and the sums are obtained by a prefix
+	sum of the differences.
+
+	@param values Values to push in the window. Must not overlap sums
+	@param size Number of values
+	@param sums Room for size sums
+
+	***************************************************************************/
+	template<class AccType>
+	void _SlidingWindow<AccType>::update(const AccType *values, size_t size, AccType *sums)
+	{
+		size_t head = size < length ? size : length;
+		size_t index = oldest;
+		for (size_t j = 0; j < head; ++j)
+		{
+			sums[j] = values[j] - ring[index];
+			index = (index + 1 == length) ? 0 : index + 1;
+		}
+		for (size_t j = length; j < size; ++j)
+			sums[j] = values[j] - values[j - length];
+
+		if (size >= length)
+		{
+			for (size_t k = 0; k < length; ++k)
+				ring[k] = values[size - length + k];
+			oldest = 0;
+		}
+		else
+		{
+			for (size_t j = 0; j < size; ++j)
+			{
+				ring[oldest] = values[j];
+				oldest = (oldest + 1 == length) ? 0 : oldest + 1;
+			}
+		}
+
+		sum = dsptl_private::prefixSum(sums, size, sum);
+	}
+
+
+	//  DERIVED CLASSES
+
+
+	/*-----------------------------------------------------------------------------
+	Moving sum of the last L samples
+
+	@tparam InType Type of the input samples
+	@tparam AccType Type of the accumulator and of the output. Must be able to hold
+	the sum of L samples
+	------------------------------------------------------------------------------*/
+	template<class InType = int16_t, class AccType = int32_t>
+	class SlidingWindowSum : public _SlidingWindow<AccType>
+	{
+	public:
+		SlidingWindowSum(size_t windowLength) : _SlidingWindow<AccType>(windowLength) {}
+		// Compute the sum of the window after each input sample
+		void step(const InType *in, size_t size, AccType *out);
+		void step(const std::vector<InType> &in, std::vector<AccType> &out);
+	};
+
+	/***********************************************************************//**
+	Compute the sum of the window after each input sample
+
+	@param in Input samples
+	@param size Number of input samples
+	@param out Room for size outputs
+
+	***************************************************************************/
+	template<class InType, class AccType>
+	void SlidingWindowSum<InType, AccType>::step(const InType *in, size_t size, AccType *out)
+	{
+		this->values.resize(size);
+		for (size_t j = 0; j < size; ++j)
+			this->values[j] = static_cast<AccType>(in[j]);
+		this->update(this->values.data(), size, out);
+	}
+
+	/// Version of step() with vectors. The output is resized to the size of the input
+	template<class InType, class AccType>
+	void SlidingWindowSum<InType, AccType>::step(const std::vector<InType> &in, std::vector<AccType> &out)
+	{
+		out.resize(in.size());
+		step(in.data(), in.size(), out.data());
+	}
+
+	/*-----------------------------------------------------------------------------
+	Moving average of the last L samples. The sum is divided by L, with the
+	rounding of the division of AccType.
+
+	@tparam InType Type of the input samples
+	@tparam AccType Type of the accumulator and of the output
+	------------------------------------------------------------------------------*/
+	template<class InType = int16_t, class AccType = int32_t>
+	class SlidingWindowMean : public _SlidingWindow<AccType>
+	{
+	public:
+		SlidingWindowMean(size_t windowLength) : _SlidingWindow<AccType>(windowLength) {}
+		// Compute the mean of the window after each input sample
+		void step(const InType *in, size_t size, AccType *out);
+		void step(const std::vector<InType> &in, std::vector<AccType> &out);
+	};
+
+	/***********************************************************************//**
+	Compute the mean of the window after each input sample
+
+	@param in Input samples
+	@param size Number of input samples
+	@param out Room for size outputs
+
+	***************************************************************************/
+	template<class InType, class AccType>
+	void SlidingWindowMean<InType, AccType>::step(const InType *in, size_t size, AccType *out)
+	{
+		this->values.resize(size);
+		for (size_t j = 0; j < size; ++j)
+			this->values[j] = static_cast<AccType>(in[j]);
+		this->update(this->values.data(), size, out);
+		AccType divisor = static_cast<AccType>(this->length);
+		for (size_t j = 0; j < size; ++j)
+			out[j] /= divisor;
+	}
+
+	/// Version of step() with vectors. The output is resized to the size of the input
+	template<class InType, class AccType>
+	void SlidingWindowMean<InType, AccType>::step(const std::vector<InType> &in, std::vector<AccType> &out)
+	{
+		out.resize(in.size());
+		step(in.data(), in.size(), out.data());
+	}
+
+	/*-----------------------------------------------------------------------------
+	Energy of the last L samples: sum of the squared magnitudes
+
+	@tparam InType Type of the input samples, real or complex
+	@tparam AccType Type of the accumulator and of the output. Must be able to hold
+	the energy of L samples: with uint32_t, for example, 32 complex samples of 14 bits
+	------------------------------------------------------------------------------*/
+	template<class InType = std::complex<int16_t>, class AccType = uint32_t>
+	class SlidingWindowEnergy : public _SlidingWindow<AccType>
+	{
+	public:
+		SlidingWindowEnergy(size_t windowLength) : _SlidingWindow<AccType>(windowLength) {}
+		// Compute the energy of the window after each input sample
+		void step(const InType *in, size_t size, AccType *out);
+		void step(const std::vector<InType> &in, std::vector<AccType> &out);
+	};
+
+	/***********************************************************************//**
+	Compute the energy of the window after each input sample
+
+	@param in Input samples
+	@param size Number of input samples
+	@param out Room for size outputs
+
+	***************************************************************************/
+	template<class InType, class AccType>
+	void SlidingWindowEnergy<InType, AccType>::step(const InType *in, size_t size, AccType *out)
+	{
+		this->values.resize(size);
+		for (size_t j = 0; j < size; ++j)
+			this->values[j] = dsptl_private::squaredMagnitude<AccType>(in[j]);
+		this->update(this->values.data(), size, out);
+	}
+
+	/// Version of step() with vectors. The output is resized to the size of the input
+	template<class InType, class AccType>
+	void SlidingWindowEnergy<InType, AccType>::step(const std::vector<InType> &in, std::vector<AccType> &out)
+	{
+		out.resize(in.size());
+		step(in.data(), in.size(), out.data());
+	}
+
+	/*-----------------------------------------------------------------------------
+	Power of the last L samples: mean of the squared magnitudes
+
+	@tparam InType Type of the input samples, real or complex
+	@tparam AccType Type of the accumulator and of the output. Must be able to hold
+	the energy of L samples
+	------------------------------------------------------------------------------*/
+	template<class InType = std::complex<int16_t>, class AccType = uint32_t>
+	class SlidingWindowPower : public _SlidingWindow<AccType>
+	{
+	public:
+		SlidingWindowPower(size_t windowLength) : _SlidingWindow<AccType>(windowLength) {}
+		// Compute the power of the window after each input sample
+		void step(const InType *in, size_t size, AccType *out);
+		void step(const std::vector<InType> &in, std::vector<AccType> &out);
+	};
+
+	/***********************************************************************//**
+	Compute the power of the window after each input sample
+
+	@param in Input samples
+	@param size Number of input samples
+	@param out Room for size outputs
+
+	***************************************************************************/
+	template<class InType, class AccType>
+	void SlidingWindowPower<InType, AccType>::step(const InType *in, size_t size, AccType *out)
+	{
+		this->values.resize(size);
+		for (size_t j = 0; j < size; ++j)
+			this->values[j] = dsptl_private::squaredMagnitude<AccType>(in[j]);
+		this->update(this->values.data(), size, out);
+		AccType divisor = static_cast<AccType>(this->length);
+		for (size_t j = 0; j < size; ++j)
+			out[j] /= divisor;
+	}
+
+	/// Version of step() with vectors. The output is resized to the size of the input
+	template<class InType, class AccType>
+	void SlidingWindowPower<InType, AccType>::step(const std::vector<InType> &in, std::vector<AccType> &out)
+	{
+		out.resize(in.size());
+		step(in.data(), in.size(), out.data());
+	}
+
+} // End of namespace
+
+#endif
@@ -0,0 +1,106 @@
+#include "dsptl_sliding_window.h"
+#include <cstdlib>
+#include <complex>
+#include <vector>
+#include <iostream>
+
+template<class AccType, class InType>
+std::vector<AccType> sampleValues(const std::vector<InType> &input);
+template<class AccType, class InType>
+std::vector<AccType> squaredMagnitudes(const std::vector<InType> &input);
+template<class Window, class InType, class AccType>
+bool testSlidingWindow(const char *name, size_t windowLength, const std::vector<InType> &input, const std::vector<AccType> &values);
+
+int main()
+{
+	srand(1);
+	const size_t windowLengths[] = { 1, 5, 16, 37 };
+
+	bool passed = true;
+	for (size_t L : windowLengths)
+	{
+		std::vector<int16_t> real(2000);
+		for (size_t n = 0; n < real.size(); ++n)
+			real[n] = static_cast<int16_t>(rand() % 65536 - 32768);
+		std::vector<std::complex<int16_t> > complex(2000);
+		for (size_t n = 0; n < complex.size(); ++n)
+			complex[n] = std::complex<int16_t>(rand() % 8001 - 4000, rand() % 8001 - 4000);
+
+		passed = testSlidingWindow<dsptl::SlidingWindowSum<int16_t, int32_t>, int16_t, int32_t>("SlidingWindowSum int32_t", L, real, sampleValues<int32_t>(real)) && passed;
+		passed = testSlidingWindow<dsptl::SlidingWindowSum<int16_t, int64_t>, int16_t, int64_t>("SlidingWindowSum int64_t", L, real, sampleValues<int64_t>(real)) && passed;
+		passed = testSlidingWindow<dsptl::SlidingWindowEnergy<int16_t, uint64_t>, int16_t, uint64_t>("SlidingWindowEnergy real", L, real, squaredMagnitudes<uint64_t>(real)) && passed;
+		passed = testSlidingWindow<dsptl::SlidingWindowEnergy<std::complex<int16_t>, uint32_t>, std::complex<int16_t>, uint32_t>("SlidingWindowEnergy complex", L, complex, squaredMagnitudes<uint32_t>(complex)) && passed;
+		passed = testSlidingWindow<dsptl::SlidingWindowEnergy<std::complex<int16_t>, uint64_t>, std::complex<int16_t>, uint64_t>("SlidingWindowEnergy complex uint64_t", L, complex, squaredMagnitudes<uint64_t>(complex)) && passed;
+	}
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Values summed by SlidingWindowSum: the samples converted to the accumulator
+------------------------------------------------------------------------------*/
+template<class AccType, class InType>
+std::vector<AccType> sampleValues(const std::vector<InType> &input)
+{
+	std::vector<AccType> values(input.size());
+	for (size_t n = 0; n < input.size(); ++n)
+		values[n] = static_cast<AccType>(input[n]);
+	return values;
+}
+
+/*-----------------------------------------------------------------------------
+Values summed by SlidingWindowEnergy: the squared magnitudes of the samples
+------------------------------------------------------------------------------*/
+template<class AccType, class InType>
+std::vector<AccType> squaredMagnitudes(const std::vector<InType> &input)
+{
+	std::vector<AccType> values(input.size());
+	for (size_t n = 0; n < input.size(); ++n)
+		values[n] = dsptl_private::squaredMagnitude<AccType>(input[n]);
+	return values;
+}
+
+/*-----------------------------------------------------------------------------
+The output after each sample must be the sum of the values of the last L
+samples, recomputed over the whole window, the samples before the start being
+zero. The input is split in blocks shorter than, equal to and longer than L,
+including empty blocks, so that the window is taken from the circular buffer,
+from the block, or from both. getSum() must give the last output of each block.
+------------------------------------------------------------------------------*/
+template<class Window, class InType, class AccType>
+bool testSlidingWindow(const char *name, size_t windowLength, const std::vector<InType> &input, const std::vector<AccType> &values)
+{
+	std::vector<AccType> expected(input.size());
+	for (size_t n = 0; n < input.size(); ++n)
+	{
+		AccType sum = AccType();
+		for (size_t k = 0; k < windowLength && k <= n; ++k)
+			sum += values[n - k];
+		expected[n] = sum;
+	}
+
+	const size_t blockSizes[] = { windowLength - 1, windowLength, windowLength + 1, 0, 1, 2 * windowLength + 3, 3 * windowLength };
+	Window window(windowLength);
+	std::vector<AccType> output(input.size());
+	size_t numErrors = 0;
+	size_t b = 0;
+	for (size_t start = 0; start < input.size(); ++b)
+	{
+		size_t blockSize = (b < sizeof(blockSizes) / sizeof(blockSizes[0])) ? blockSizes[b] : rand() % (3 * windowLength + 2);
+		if (blockSize > input.size() - start)
+			blockSize = input.size() - start;
+		window.step(&input[start], blockSize, &output[start]);
+		start += blockSize;
+		if (start > 0 && window.getSum() != expected[start - 1])
+			++numErrors;
+	}
+
+	for (size_t n = 0; n < input.size(); ++n)
+		numErrors += (output[n] != expected[n]) ? 1 : 0;
+
+	bool passed = numErrors == 0;
+	std::cout << "+++++ " << name << ", L " << windowLength << ": " << numErrors << " differences with the sum over the window: "
+		<< (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -16,12 +16,82 @@ Class member function: functionMember
 
 #include <cassert>
 #include <vector>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <type_traits>
 #include "dsp_complex.h"
+#include "dsptl_simd.h"
+#include "dsptl_fft.h"
+#include "dsptl_filter_common.h"
 
 
 // Uncomment the following line to include the C++ specific syntax
 //#define CPLUSPLUS11
 
+namespace dsptl_private
+{
+	/*-----------------------------------------------------------------------------
+	Indicates if a FIR filter instantiation can use the vectorized kernels.\n
+	This is the case for complex 16 bits input and output with 32 bits internal
+	computation and 32 bits coefficients.
+	------------------------------------------------------------------------------*/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	struct FirSimdEligible : std::integral_constant<bool,
+		std::is_same<InType, std::complex<int16_t> >::value &&
+		std::is_same<OutType, std::complex<int16_t> >::value &&
+		std::is_same<InternalType, std::complex<int32_t> >::value &&
+		std::is_same<CoefType, int32_t>::value >
+	{};
+
+	/*-----------------------------------------------------------------------------
+	Indicates if a FIR filter instantiation can use the FFT based fast convolution.\n
+	The internal type must be complex<int32_t> and the coefficients real integers.
+	The fast convolution is computed in double precision and rounded to the exact
+	value of the direct form.
+	------------------------------------------------------------------------------*/
+	template<class InType, class OutType, class InternalType, class CoefType>
+	struct FirFftEligible : std::integral_constant<bool,
+		std::is_same<InternalType, std::complex<int32_t> >::value &&
+		std::numeric_limits<CoefType>::is_integer >
+	{};
+
+	/*-----------------------------------------------------------------------------
+	Compile time unrolling of the inner product of the coefficients
+	Begin to Begin + Count - 1 with the samples at the same positions.\n
+	The range is split in two halves so that the recursion depth is only
+	log2(Count).
+	------------------------------------------------------------------------------*/
+	template<size_t Begin, size_t Count>
+	struct FirUnroll
+	{
+		template<class InternalType, class CoefType>
+		static void accumulate(InternalType &y, const CoefType *c, const InternalType *w)
+		{
+			FirUnroll<Begin, Count / 2>::accumulate(y, c, w);
+			FirUnroll<Begin + Count / 2, Count - Count / 2>::accumulate(y, c, w);
+		}
+	};
+
+	template<size_t Begin>
+	struct FirUnroll<Begin, 1>
+	{
+		template<class InternalType, class CoefType>
+		static void accumulate(InternalType &y, const CoefType *c, const InternalType *w)
+		{
+			y += c[Begin] * w[Begin];
+		}
+	};
+
+	template<size_t Begin>
+	struct FirUnroll<Begin, 0>
+	{
+		template<class InternalType, class CoefType>
+		static void accumulate(InternalType &, const CoefType *, const InternalType *)
+		{}
+	};
+}
+
 
 /*-----------------------------------------------------------------------------
 FIR Filter
@@ -38,6 +108,29 @@ work smoothly. Overflow and underflow conditions must not occur
 The filter has been verified not to saturate with a sine input of 32000 and a
 set of coefficients in coeffRrc
 
+When the input and output are complex<int16_t>, the internal type complex<int32_t>
+and the coefficients int32_t values which fit in 16 bits, the convolution is 
+computed with the vectorized kernels of dsptl_simd.h. The result is identical to
+the scalar computation.
+
+For long filters with a complex<int32_t> internal type, each call to step() selects
+the direct form or an FFT overlap-save fast convolution depending on the number of taps,
+the number of input samples and the speed of the vectorized kernel when it is used (see
+dsptl::fftConvolutionIsFaster()). The result of
+the fast convolution is rounded to the integer value of the direct form before being
+scaled, so that both methods return the same output.
+
+Symmetric and antisymmetric (linear phase) sets of coefficients are detected by
+setCoeffs(). The direct form then adds the samples mirrored around the middle of the
+history before the multiplication, which halves the number of multiplications.
+The vectorized version does not fold the samples because the sum of two 16 bits
+samples does not fit in the 16 bits operands of the kernel.
+
+Float and double samples, real or complex, are filtered with real coefficients of
+the same precision and the output is not scaled: the gain is the one of the
+coefficients. On hosts supporting AVX2 and FMA, the inner product is computed by
+the FMA kernels of dsptl_simd.h on all the taps, without folding.
+
 ------------------------------------------------------------------------------*/
 template<class InType, class OutType, class InternalType, class CoefType>
 class FilterFir
@@ -45,18 +138,45 @@ class FilterFir
 public:
 	/// Constructor. Coefficients are defined. Size for the internal
 	/// buffer is reserved based on the number of coefficients
-	FilterFir():top(0){};
+	FilterFir():coeff(new std::vector<CoefType>()), top(0), useSimd(false), useFft(false), symmetry(dsptl_private::CoeffSymmetry::none){};
 	FilterFir(const std::vector<CoefType> &firCoeff);
+	FilterFir(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
 	// This function is called for each iteration of the filtering process
 	void step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal);
+	// Version of step() working on a range of samples in place
+	void step(const InType *signal, size_t size, OutType *filteredSignal);
 	void reset();
 	void setCoeffs(const std::vector<CoefType> &firCoeff);
+	// Version of setCoeffs() sharing the coefficients with other filters
+	void setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
 	
 private:
-	std::vector<CoefType> coeff;		///< Coefficients
-	std::vector<InternalType> buffer;  	///< History buffer
+	// Vectorized version of step() for the eligible types
+	void stepSimd(const InType *signal, size_t size, OutType *filteredSignal, std::true_type);
+	void stepSimd(const InType *, size_t, OutType *, std::false_type) {}
+	// Prepare the tables used by stepSimd(). Return false if the coefficients do not allow it
+	bool setupSimd(std::true_type);
+	bool setupSimd(std::false_type) { return false; }
+	// FFT based version of step() for the eligible types
+	void stepFft(const InType *signal, size_t size, OutType *filteredSignal, std::true_type);
+	void stepFft(const InType *, size_t, OutType *, std::false_type) {}
+	// Prepare the fast convolution engine. Return false if it cannot be used
+	bool setupFft(std::true_type);
+	bool setupFft(std::false_type) { return false; }
+	/// Speed of the direct form relative to the scalar one, for the choice of the fast convolution
+	double directSpeedup() const { return useSimd ? dsptl_private::dotComplex16Speedup : 1.0; }
+
+	std::shared_ptr<const std::vector<CoefType> > coeff;	///< Coefficients, possibly shared with other filters
+	std::vector<InternalType> buffer;  	///< History buffer. Each sample is stored twice
 	unsigned top; 							///< Current insertion point in the history buffer 
 	int coeffScaling;
+	bool useSimd;							///< True if the vectorized version of step() is used
+	std::vector<std::complex<int16_t> > history16;	///< History buffer of the vectorized version
+	bool useFft;							///< True if the fast convolution can be selected by step()
+	dsptl::OverlapSave fastConvolution;	///< Fast convolution engine
+	std::vector<std::complex<double> > fftInput;	///< History and input samples of the fast convolution
+	std::vector<std::complex<double> > fftOutput;	///< Output of the fast convolution
+	dsptl_private::CoeffSymmetry symmetry;	///< Symmetry of the coefficients
 };
 
 
@@ -71,32 +191,103 @@ buffer for computations.
 ------------------------------------------------------------------------------*/
 template<class InType, class OutType, class InternalType, class CoefType>
 FilterFir<InType, OutType, InternalType, CoefType>::FilterFir(const std::vector<CoefType> &firCoeff)
-		: top(0)
+		: top(0), useSimd(false), useFft(false), symmetry(dsptl_private::CoeffSymmetry::none)
+{
+	setCoeffs(firCoeff);
+}
+
+/*-----------------------------------------------------------------------------
+FIR Filter Constructor with coefficients shared with other filters, for example
+obtained from the cache of dsptl_filter_design.h
+
+@param firCoeff Filter Coefficients. Must not be null
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+FilterFir<InType, OutType, InternalType, CoefType>::FilterFir(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+		: top(0), useSimd(false), useFft(false), symmetry(dsptl_private::CoeffSymmetry::none)
 {
 	setCoeffs(firCoeff);
 }
 
 
 /*-----------------------------------------------------------------------------
-Sets or replaces the filter tap coefficients.
+Sets or replaces the filter tap coefficients. The filter keeps its own copy of
+the coefficients.
 
 
 ------------------------------------------------------------------------------*/
 template<class InType, class OutType, class InternalType, class CoefType>
 void FilterFir<InType, OutType, InternalType, CoefType>::setCoeffs(const std::vector<CoefType> &firCoeff)
 {
+	setCoeffs(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+}
+
+/*-----------------------------------------------------------------------------
+Sets or replaces the filter tap coefficients. The coefficients are not copied:
+the filters using the same table share it, which saves memory when many
+instances use the same design. The table must not be modified afterwards.
+
+@param firCoeff Filter Coefficients. Must not be null
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+void FilterFir<InType, OutType, InternalType, CoefType>::setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+{
+	assert(firCoeff);
 	coeff = firCoeff;
-	buffer.resize(firCoeff.size());
 	// Compute the energy in the coefficients
 	// bit growth due to coefficient  and number of taps
 	double sumMagnitude = 0;
-	for (size_t index = 0; index < coeff.size(); ++index)
-		sumMagnitude += abs(coeff[index]);
+	for (size_t index = 0; index < coeff->size(); ++index)
+		sumMagnitude += abs((*coeff)[index]);
 	coeffScaling = static_cast<int>(floor(log2(sumMagnitude)));
+	symmetry = dsptl_private::selectSymmetry<InternalType, InternalType>(*coeff);
+	useSimd = setupSimd(typename dsptl_private::FirSimdEligible<InType, OutType, InternalType, CoefType>::type());
+	// The history buffer is twice the number of taps. See step()
+	if (useSimd)
+		buffer.clear();
+	else
+		buffer.resize(2 * coeff->size());
+	useFft = setupFft(typename dsptl_private::FirFftEligible<InType, OutType, InternalType, CoefType>::type());
 	reset();
 }
 
 
+/*-----------------------------------------------------------------------------
+Prepare the coefficient and history tables of the vectorized version of the filter.
+
+@return true if all coefficients fit in 16 bits and the vectorized version can
+be used
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+bool FilterFir<InType, OutType, InternalType, CoefType>::setupSimd(std::true_type)
+{
+	for (size_t index = 0; index < coeff->size(); ++index)
+		if ((*coeff)[index] > INT16_MAX || (*coeff)[index] < INT16_MIN)
+			return false;
+	history16.resize(2 * coeff->size());
+	return true;
+}
+
+
+/*-----------------------------------------------------------------------------
+Prepare the fast convolution engine. The engine is only setup for filters long
+enough for the fast convolution to be faster with some block sizes.
+
+@return true if the fast convolution can be selected by step()
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+bool FilterFir<InType, OutType, InternalType, CoefType>::setupFft(std::true_type)
+{
+	// Very large blocks are the most favorable case
+	if (!dsptl::fftConvolutionIsFaster(coeff->size(), static_cast<size_t>(-1) / 2, directSpeedup()))
+		return false;
+	fastConvolution.setKernel(std::vector<double>(coeff->begin(), coeff->end()));
+	return true;
+}
+
+
 
 /*-----------------------------------------------------------------------------
 Reset the internal state of the filter. All history is cleared.
@@ -106,19 +297,24 @@ Reset the internal state of the filter. All history is cleared.
 template<class InType, class OutType, class InternalType, class CoefType>
 void FilterFir<InType, OutType, InternalType, CoefType>::reset()
 {
+	top = 0;
 	for (size_t index = 0; index < buffer.size(); ++index)
 	{
 		buffer[index] = InternalType{};
 	}
+	for (size_t index = 0; index < history16.size(); ++index)
+		history16[index] = std::complex<int16_t>{};
 }
 
 
 /*-----------------------------------------------------------------------------
 FIR Filter
 
-The algortihm uses an internal buffer with a length equal to the number of coefficients.
-The current input value is inserted in the buffer at the correct location, then the convolution
-is computed. \n
+The algortihm uses an internal buffer with a length equal to twice the number of coefficients.
+The current input value is inserted in the buffer at the correct location and at the same
+location plus the number of coefficients. The last samples are then always contiguous in
+memory, starting with the most recent one, and the convolution is computed as a single
+inner product that the compiler can vectorize. \n
 The user must make sure that the internal type is large enough to contain the
 accumulated sum of the convolution operation
 Filtering can be made in place.
@@ -136,36 +332,493 @@ void FilterFir<InType, OutType, InternalType, CoefType>::step(const std::vector<
 	assert(signal.size() == filteredSignal.size());
 	#endif
 
+	step(signal.data(), signal.size(), filteredSignal.data());
+}
+
+
+/*-----------------------------------------------------------------------------
+FIR Filter
+
+Version of step() which filters a range of samples without any copy, for example
+part of a larger capture buffer. See step(const std::vector<InType> &, std::vector<OutType> &)
+
+@param signal First sample of the input of the filter
+@param size Number of samples to filter
+@param filteredSignal Output of the filter. Room for size samples. Can be the same
+location as the input
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+void FilterFir<InType, OutType, InternalType, CoefType>::step(const InType *signal, size_t size, OutType *filteredSignal)
+{
+	if (useFft && dsptl::fftConvolutionIsFaster(coeff->size(), size, directSpeedup()))
+	{
+		stepFft(signal, size, filteredSignal, typename dsptl_private::FirFftEligible<InType, OutType, InternalType, CoefType>::type());
+		return;
+	}
+	if (useSimd)
+	{
+		stepSimd(signal, size, filteredSignal, typename dsptl_private::FirSimdEligible<InType, OutType, InternalType, CoefType>::type());
+		return;
+	}
+
 	InternalType y;  							// Internal computation type
-	unsigned  n;						// Counting indexes
-	size_t numTaps = buffer.size();		// Number of taps in the filter
-	size_t inputSize = signal.size();		// Number of input samples
+	size_t numTaps = coeff->size();		// Number of taps in the filter
+	size_t inputSize = size;		// Number of input samples
+	const CoefType *c = coeff->data();
 
 
-	for(unsigned j = 0; j < inputSize ; j++)
+	for(size_t j = 0; j < inputSize ; j++)
 	{
 	// This loop is executed for each of the input samples
+		// The sample is written twice so that the last numTaps samples are always
+		// available from top, the most recent sample first
 		buffer[top] = signal[j];
-		y = InternalType();
-		n = 0;
+		buffer[top + numTaps] = buffer[top];
+		const InternalType *window = &buffer[top];
+
+		if (symmetry != dsptl_private::CoeffSymmetry::none)
+		{
+			y = dsptl_private::foldedInnerProduct<InternalType>(c, window, numTaps, symmetry);
+		}
+		else
+		{
+			dsptl_private::innerProduct(y, c, window, numTaps);
+		}
+		filteredSignal[j] = dsptl_private::outputScale16<OutType>(y, coeffScaling);
+
+		top = (top == 0) ? static_cast<unsigned>(numTaps - 1) : top - 1;
+	}
+}
+
+
+/*-----------------------------------------------------------------------------
+Vectorized FIR Filter
+
+Same algorithm as step() for complex 16 bits samples. The history buffer holds
+the samples as 16 bits values so that the convolution is a single inner product
+computed by the vectorized kernel.
 
-		// Process samples before and including Top
-		for(int k = top; k >= 0; k--)
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+void FilterFir<InType, OutType, InternalType, CoefType>::stepSimd(const InType *signal, size_t size, OutType *filteredSignal, std::true_type)
+{
+	static_assert(sizeof(std::complex<int16_t>) == 2 * sizeof(int16_t), "");
+	size_t numTaps = coeff->size();		// Number of taps in the filter
+	size_t inputSize = size;		// Number of input samples
+	const int16_t *hist = reinterpret_cast<const int16_t *>(history16.data());
+	int32_t re, im;
+
+	for (size_t j = 0; j < inputSize; j++)
+	{
+		history16[top] = signal[j];
+		history16[top + numTaps] = signal[j];
+		dsptl_private::dotComplex16(hist + 2 * top, coeff->data(), numTaps, re, im);
+		filteredSignal[j] = limitScale16(std::complex<int32_t>(re, im), coeffScaling);
+
+		top = (top == 0) ? static_cast<unsigned>(numTaps - 1) : top - 1;
+	}
+}
+
+
+/*-----------------------------------------------------------------------------
+FFT based FIR Filter
+
+The numTaps - 1 samples of the history buffer followed by the input samples are
+filtered by the overlap-save engine. Each output is rounded to the nearest integer,
+which is the exact result of the direct form as long as the internal type does not
+overflow, then scaled like in step().\n
+The last samples of the input are finally inserted in the history buffer so that
+the following calls can use either method.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+void FilterFir<InType, OutType, InternalType, CoefType>::stepFft(const InType *signal, size_t size, OutType *filteredSignal, std::true_type)
+{
+	size_t numTaps = coeff->size();			// Number of taps in the filter
+	size_t inputSize = size;				// Number of input samples
+
+	// The history starts at top + 1 with the most recent sample
+	fftInput.resize(inputSize + numTaps - 1);
+	for (size_t k = 0; k < numTaps - 1; ++k)
+	{
+		fftInput[numTaps - 2 - k] = useSimd ? dsptl_private::toComplexDouble(history16[top + 1 + k])
+			: dsptl_private::toComplexDouble(buffer[top + 1 + k]);
+	}
+	for (size_t j = 0; j < inputSize; ++j)
+		fftInput[numTaps - 1 + j] = dsptl_private::toComplexDouble(signal[j]);
+
+	fftOutput.resize(inputSize);
+	fastConvolution.filter(fftInput.data(), inputSize, fftOutput.data());
+
+	// Update the history with the last samples. This is done before the outputs
+	// are written since the filtering can be made in place
+	size_t first = inputSize > numTaps ? inputSize - numTaps : 0;
+	for (size_t j = first; j < inputSize; ++j)
+	{
+		if (useSimd)
 		{
-			y += coeff[n++] * buffer[k];
-			//y = scale32(y, 1);
+			history16[top] = signal[j];
+			history16[top + numTaps] = signal[j];
 		}
-		// Process samples after Top
-		for(unsigned k = numTaps-1; k > top; k--)
+		else
 		{
-			y += coeff[n++] * buffer[k];
-			//y = scale32(y, 1);
+			buffer[top] = signal[j];
+			buffer[top + numTaps] = buffer[top];
 		}
+		top = (top == 0) ? static_cast<unsigned>(numTaps - 1) : top - 1;
+	}
+
+	for (size_t j = 0; j < inputSize; ++j)
+	{
+		InternalType y(static_cast<int32_t>(llround(fftOutput[j].real())), static_cast<int32_t>(llround(fftOutput[j].imag())));
 		filteredSignal[j] = limitScale16(y, coeffScaling);
+	}
+}
+
+
+/*-----------------------------------------------------------------------------
+FIR Filter with a number of taps fixed at compile time
+
+@tparam InType Type of the input signal. Can be float, double, complex, int...
+@tparam OutType Type of the output signal
+@tparam InternalType Type used internally for the computation
+@tparam CoefType Type of the coefficients
+@tparam NTaps Number of taps of the filter
+
+The filter computes the same output as FilterFir. The coefficients and the history
+are stored in std::array so that the object does not perform any allocation, and the
+convolution is fully unrolled at compile time.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t NTaps>
+class FilterFirFixed
+{
+	static_assert(NTaps > 0, "The filter must have at least one tap");
+public:
+	FilterFirFixed() : coeff(), top(0), coeffScaling(0) { reset(); }
+	FilterFirFixed(const std::array<CoefType, NTaps> &firCoeff) : top(0) { setCoeffs(firCoeff); }
+	FilterFirFixed(const std::vector<CoefType> &firCoeff) : top(0) { setCoeffs(firCoeff); }
+	// This function is called for each iteration of the filtering process
+	void step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal);
+	// Version of step() working on a range of samples in place
+	void step(const InType *signal, size_t size, OutType *filteredSignal);
+	void reset();
+	void setCoeffs(const std::array<CoefType, NTaps> &firCoeff);
+	void setCoeffs(const std::vector<CoefType> &firCoeff);
+
+private:
+	std::array<CoefType, NTaps> coeff;			///< Coefficients
+	std::array<InternalType, 2 * NTaps> buffer;	///< History buffer. Each sample is stored twice
+	size_t top;									///< Current insertion point in the history buffer
+	int coeffScaling;
+};
+
+
+/*-----------------------------------------------------------------------------
+Sets or replaces the filter tap coefficients. The history is cleared.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t NTaps>
+void FilterFirFixed<InType, OutType, InternalType, CoefType, NTaps>::setCoeffs(const std::array<CoefType, NTaps> &firCoeff)
+{
+	coeff = firCoeff;
+	// bit growth due to coefficient  and number of taps
+	double sumMagnitude = 0;
+	for (size_t index = 0; index < NTaps; ++index)
+		sumMagnitude += abs(coeff[index]);
+	coeffScaling = static_cast<int>(floor(log2(sumMagnitude)));
+	reset();
+}
+
+/*-----------------------------------------------------------------------------
+Sets or replaces the filter tap coefficients. The vector must contain NTaps values.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t NTaps>
+void FilterFirFixed<InType, OutType, InternalType, CoefType, NTaps>::setCoeffs(const std::vector<CoefType> &firCoeff)
+{
+	assert(firCoeff.size() == NTaps);
+	std::array<CoefType, NTaps> tmp;
+	std::copy(firCoeff.begin(), firCoeff.end(), tmp.begin());
+	setCoeffs(tmp);
+}
+
+/*-----------------------------------------------------------------------------
+Reset the internal state of the filter. All history is cleared.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t NTaps>
+void FilterFirFixed<InType, OutType, InternalType, CoefType, NTaps>::reset()
+{
+	top = 0;
+	buffer.fill(InternalType{});
+}
+
+/*-----------------------------------------------------------------------------
+FIR Filter
+
+Same algorithm as FilterFir::step(). The history buffer holds each sample twice so
+that the last NTaps samples are contiguous and the unrolled inner product is
+computed without any loop.
+
+@param signal Input to the filter
+@param filteredSignal Output of the filter. Must be the same size as signal
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t NTaps>
+void FilterFirFixed<InType, OutType, InternalType, CoefType, NTaps>::step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal)
+{
+	assert(signal.size() == filteredSignal.size());
+	step(signal.data(), signal.size(), filteredSignal.data());
+}
+
+/*-----------------------------------------------------------------------------
+Version of step() which filters a range of samples without any copy
+
+@param signal First sample of the input of the filter
+@param size Number of samples to filter
+@param filteredSignal Output of the filter. Room for size samples. Can be the same
+location as the input
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t NTaps>
+void FilterFirFixed<InType, OutType, InternalType, CoefType, NTaps>::step(const InType *signal, size_t size, OutType *filteredSignal)
+{
+	size_t inputSize = size;		// Number of input samples
+
+	for (size_t j = 0; j < inputSize; j++)
+	{
+		buffer[top] = signal[j];
+		buffer[top + NTaps] = buffer[top];
+		InternalType y{};
+		dsptl_private::FirUnroll<0, NTaps>::accumulate(y, coeff.data(), &buffer[top]);
+		filteredSignal[j] = dsptl_private::outputScale16<OutType>(y, coeffScaling);
+
+		top = (top == 0) ? NTaps - 1 : top - 1;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+Bank of identical FIR filters
+
+@tparam InType Type of the input signal. Can be float, double, complex, int...
+@tparam OutType Type of the output signal
+@tparam InternalType Type used internally for the computation
+@tparam CoefType Type of the coefficients
+@tparam K Number of channels
+
+The K channels are filtered with the same coefficients and each channel computes
+the same output as a FilterFir with these coefficients. The coefficient table is
+shared by all the channels, and with other filters when it is set from shared
+coefficients.\n
+
+The signals are channel interleaved: sample t of channel ch is located at
+t * K + ch. The history buffer uses the same layout, with each group of K samples
+stored twice like in FilterFir, so that the inner loop over the channels reads
+contiguous samples and each coefficient is applied to several channels by a
+single instruction.\n
+
+For complex 16 bits signals, with the same conditions as for FilterFir, the
+vectorized kernel dotComplex16Channels() processes 8 channels (AVX2) or 4 channels
+(SSE2) at a time.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+class FilterFirBank
+{
+	static_assert(K > 0, "The bank must have at least one channel");
+public:
+	FilterFirBank() : coeff(new std::vector<CoefType>()), top(0), coeffScaling(0), useSimd(false) {}
+	FilterFirBank(const std::vector<CoefType> &firCoeff) : top(0), useSimd(false) { setCoeffs(firCoeff); }
+	FilterFirBank(const std::shared_ptr<const std::vector<CoefType> > &firCoeff) : top(0), useSimd(false) { setCoeffs(firCoeff); }
+	// Filter size samples of each channel. The signals are channel interleaved
+	void step(const InType *signal, size_t size, OutType *filteredSignal);
+	// Version of step() with vectors. The size must be a multiple of K
+	void step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal);
+	void reset();
+	void setCoeffs(const std::vector<CoefType> &firCoeff);
+	// Version of setCoeffs() sharing the coefficients with other filters
+	void setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+	/// Number of channels of the bank
+	static size_t getNumChannels() { return K; }
+
+private:
+	// Vectorized version of step() for the eligible types
+	void stepSimd(const InType *signal, size_t size, OutType *filteredSignal, std::true_type);
+	void stepSimd(const InType *, size_t, OutType *, std::false_type) {}
+	// Prepare the history used by stepSimd(). Return false if the coefficients do not allow it
+	bool setupSimd(std::true_type);
+	bool setupSimd(std::false_type) { return false; }
+
+	std::shared_ptr<const std::vector<CoefType> > coeff;	///< Coefficients shared by all the channels, possibly with other filters
+	std::vector<InternalType> buffer;	///< Channel interleaved history buffer. Each group of K samples is stored twice
+	size_t top;							///< Current insertion point in the history buffer, in groups of K samples
+	int coeffScaling;
+	bool useSimd;						///< True if the vectorized version of step() is used
+	std::vector<std::complex<int16_t> > history16;	///< History buffer of the vectorized version
+};
+
+
+/*-----------------------------------------------------------------------------
+Sets or replaces the filter tap coefficients. The history of all the channels
+is cleared.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+void FilterFirBank<InType, OutType, InternalType, CoefType, K>::setCoeffs(const std::vector<CoefType> &firCoeff)
+{
+	setCoeffs(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+}
+
+/*-----------------------------------------------------------------------------
+Sets or replaces the filter tap coefficients without copying them. The filters
+using the same table share it. The table must not be modified afterwards. The
+history of all the channels is cleared.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+void FilterFirBank<InType, OutType, InternalType, CoefType, K>::setCoeffs(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+{
+	assert(firCoeff && !firCoeff->empty());
+	coeff = firCoeff;
+	// bit growth due to coefficient  and number of taps
+	double sumMagnitude = 0;
+	for (size_t index = 0; index < coeff->size(); ++index)
+		sumMagnitude += abs((*coeff)[index]);
+	coeffScaling = static_cast<int>(floor(log2(sumMagnitude)));
+	useSimd = setupSimd(typename dsptl_private::FirSimdEligible<InType, OutType, InternalType, CoefType>::type());
+	if (useSimd)
+		buffer.clear();
+	else
+		buffer.resize(2 * coeff->size() * K);
+	reset();
+}
+
+/*-----------------------------------------------------------------------------
+Prepare the history of the vectorized version of the filter.
+
+@return true if all coefficients fit in 16 bits and the vectorized version can
+be used
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+bool FilterFirBank<InType, OutType, InternalType, CoefType, K>::setupSimd(std::true_type)
+{
+	for (size_t index = 0; index < coeff->size(); ++index)
+		if ((*coeff)[index] > INT16_MAX || (*coeff)[index] < INT16_MIN)
+			return false;
+	history16.resize(2 * coeff->size() * K);
+	return true;
+}
+
+/*-----------------------------------------------------------------------------
+Reset the internal state of the filters. All history is cleared.
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+void FilterFirBank<InType, OutType, InternalType, CoefType, K>::reset()
+{
+	top = 0;
+	for (size_t index = 0; index < buffer.size(); ++index)
+		buffer[index] = InternalType{};
+	for (size_t index = 0; index < history16.size(); ++index)
+		history16[index] = std::complex<int16_t>{};
+}
+
+/*-----------------------------------------------------------------------------
+Bank of FIR Filters
+
+@param signal Channel interleaved input. The size must be a multiple of K
+@param filteredSignal Channel interleaved output. Must be the same size as signal
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+void FilterFirBank<InType, OutType, InternalType, CoefType, K>::step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal)
+{
+	assert(signal.size() == filteredSignal.size());
+	assert(signal.size() % K == 0);
+	step(signal.data(), signal.size() / K, filteredSignal.data());
+}
+
+/*-----------------------------------------------------------------------------
+Bank of FIR Filters
+
+Same algorithm as FilterFir::step() where each sample is replaced by a group of
+K samples, one per channel.
+
+@param signal Channel interleaved input. size * K samples
+@param size Number of samples of each channel
+@param filteredSignal Channel interleaved output. Room for size * K samples. Can
+be the same location as the input
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+void FilterFirBank<InType, OutType, InternalType, CoefType, K>::step(const InType *signal, size_t size, OutType *filteredSignal)
+{
+	if (useSimd)
+	{
+		stepSimd(signal, size, filteredSignal, typename dsptl_private::FirSimdEligible<InType, OutType, InternalType, CoefType>::type());
+		return;
+	}
+
+	size_t numTaps = coeff->size();		// Number of taps of each filter
+	const CoefType *c = coeff->data();
+	std::array<InternalType, K> y;		// One result per channel
+
+	for (size_t j = 0; j < size; j++)
+	{
+		const InType *in = signal + j * K;
+		InternalType *slot = &buffer[top * K];
+		for (size_t ch = 0; ch < K; ++ch)
+		{
+			slot[ch] = in[ch];
+			slot[numTaps * K + ch] = slot[ch];
+		}
+
+		y.fill(InternalType{});
+		for (size_t n = 0; n < numTaps; n++)
+		{
+			const InternalType *w = slot + n * K;
+			for (size_t ch = 0; ch < K; ++ch)
+				y[ch] += c[n] * w[ch];
+		}
+		for (size_t ch = 0; ch < K; ++ch)
+			filteredSignal[j * K + ch] = dsptl_private::outputScale16<OutType>(y[ch], coeffScaling);
+
+		top = (top == 0) ? numTaps - 1 : top - 1;
+	}
+}
+
+/*-----------------------------------------------------------------------------
+Vectorized bank of FIR Filters
+
+Same algorithm as step() for complex 16 bits samples. The history holds the
+samples as 16 bits values for dotComplex16Channels().
+
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType, size_t K>
+void FilterFirBank<InType, OutType, InternalType, CoefType, K>::stepSimd(const InType *signal, size_t size, OutType *filteredSignal, std::true_type)
+{
+	size_t numTaps = coeff->size();		// Number of taps of each filter
+	const int16_t *hist = reinterpret_cast<const int16_t *>(history16.data());
+	std::array<int32_t, K> re;
+	std::array<int32_t, K> im;
+
+	for (size_t j = 0; j < size; j++)
+	{
+		const InType *in = signal + j * K;
+		std::complex<int16_t> *slot = &history16[top * K];
+		for (size_t ch = 0; ch < K; ++ch)
+		{
+			slot[ch] = in[ch];
+			slot[numTaps * K + ch] = in[ch];
+		}
+		dsptl_private::dotComplex16Channels(hist + 2 * top * K, K, coeff->data(), numTaps, K, re.data(), im.data());
+		for (size_t ch = 0; ch < K; ++ch)
+			filteredSignal[j * K + ch] = limitScale16(std::complex<int32_t>(re[ch], im[ch]), coeffScaling);
 
-		top++;
-		if(top >= numTaps) top = 0;
+		top = (top == 0) ? numTaps - 1 : top - 1;
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,453 @@
+#include "filters.h"
+#include "upsampling_filters.h"
+#include "dsptl_dnsampling_filters.h"
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+#include <complex>
+#include <string>
+#include <vector>
+#include <iostream>
+
+typedef std::complex<int16_t> Sample;
+typedef FilterFir<Sample, Sample, std::complex<int32_t>, int32_t> FilterFir16;
+
+std::vector<Sample> referenceFir(const std::vector<int32_t> &coeff, const std::vector<Sample> &input);
+bool testFirEquivalence(const char *name, const std::vector<int32_t> &coeff);
+template<unsigned L>
+bool testUpsamplingFir();
+template<size_t K>
+bool testFirBank(const char *name, const std::vector<int32_t> &coeff);
+template<class T>
+bool testFloatFilters(const char *name);
+template<size_t NTaps>
+bool testFirFixed(const char *name, const std::vector<int32_t> &coeff);
+
+int main()
+{
+	srand(1);
+	std::vector<int32_t> shortCoeff(24), longCoeff(1024), symmetricCoeff(301);
+	for (size_t k = 0; k < shortCoeff.size(); ++k)
+		shortCoeff[k] = rand() % 401 - 200;
+	for (size_t k = 0; k < longCoeff.size(); ++k)
+		longCoeff[k] = rand() % 401 - 200;
+	for (size_t k = 0; k <= symmetricCoeff.size() / 2; ++k)
+		symmetricCoeff[k] = symmetricCoeff[symmetricCoeff.size() - 1 - k] = rand() % 401 - 200;
+
+	// Coefficients which do not fit in 16 bits exclude the vectorized kernel
+	std::vector<int32_t> wideCoeff(longCoeff);
+	wideCoeff[10] = 40000;
+	std::vector<int32_t> wideSymmetricCoeff(symmetricCoeff);
+	wideSymmetricCoeff[150] = 40000;
+	std::vector<int32_t> wideShortCoeff(shortCoeff);
+	wideShortCoeff[5] = 40000;
+
+	bool passed = testFirEquivalence("24 taps", shortCoeff);
+	passed = testFirEquivalence("1024 taps", longCoeff) && passed;
+	passed = testFirEquivalence("301 symmetric taps", symmetricCoeff) && passed;
+	passed = testFirEquivalence("1024 taps, scalar", wideCoeff) && passed;
+	passed = testFirEquivalence("301 symmetric taps, scalar", wideSymmetricCoeff) && passed;
+	passed = testUpsamplingFir<2>() && passed;
+	passed = testUpsamplingFir<3>() && passed;
+	passed = testUpsamplingFir<4>() && passed;
+	passed = testUpsamplingFir<5>() && passed;
+	passed = testFirBank<3>("24 taps", shortCoeff) && passed;
+	passed = testFirBank<5>("24 taps", shortCoeff) && passed;
+	passed = testFirBank<7>("301 symmetric taps", symmetricCoeff) && passed;
+	passed = testFirBank<3>("24 taps, scalar", wideShortCoeff) && passed;
+	passed = testFirBank<7>("24 taps, scalar", wideShortCoeff) && passed;
+	passed = testFloatFilters<float>("float") && passed;
+	passed = testFloatFilters<double>("double") && passed;
+	std::vector<int32_t> oddSymmetricCoeff(symmetricCoeff.begin() + 139, symmetricCoeff.end() - 139);
+	passed = testFirFixed<1>("1 tap", std::vector<int32_t>(1, 20000)) && passed;
+	passed = testFirFixed<1>("1 negative tap", std::vector<int32_t>(1, -3)) && passed;
+	passed = testFirFixed<23>("23 symmetric taps", oddSymmetricCoeff) && passed;
+	passed = testFirFixed<24>("24 taps", shortCoeff) && passed;
+	passed = testFirFixed<24>("24 taps, wide", wideShortCoeff) && passed;
+
+	std::cout << (passed ? "+++++ All tests passed\n" : "+++++ Some tests FAILED\n");
+	return passed ? 0 : 1;
+}
+
+/*-----------------------------------------------------------------------------
+Direct form convolution computed sample by sample, with the scaling of FilterFir
+------------------------------------------------------------------------------*/
+std::vector<Sample> referenceFir(const std::vector<int32_t> &coeff, const std::vector<Sample> &input)
+{
+	double sumMagnitude = 0;
+	for (size_t k = 0; k < coeff.size(); ++k)
+		sumMagnitude += std::abs(coeff[k]);
+	unsigned scaling = static_cast<unsigned>(floor(log2(sumMagnitude)));
+
+	std::vector<Sample> output(input.size());
+	for (size_t n = 0; n < input.size(); ++n)
+	{
+		std::complex<int32_t> y;
+		for (size_t k = 0; k < coeff.size() && k <= n; ++k)
+			y += coeff[k] * std::complex<int32_t>(input[n - k].real(), input[n - k].imag());
+		output[n] = limitScale16(y, scaling);
+	}
+	return output;
+}
+
+/*-----------------------------------------------------------------------------
+FilterFir must give the output of the direct form whatever the method selected
+for each block: scalar or vectorized direct form, or fast convolution for the
+large blocks of the long filters. The blocks of different sizes also check the
+history handed over from one method to the other.
+------------------------------------------------------------------------------*/
+bool testFirEquivalence(const char *name, const std::vector<int32_t> &coeff)
+{
+	const size_t blockSizes[] = { 1, 7, 64, 8192, 3, 1000, 4096, 256 };
+
+	std::vector<Sample> input;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+		for (size_t j = 0; j < blockSizes[b]; ++j)
+			input.push_back(Sample(rand() % 8001 - 4000, rand() % 8001 - 4000));
+	std::vector<Sample> expected = referenceFir(coeff, input);
+
+	FilterFir16 filter(coeff);
+	std::vector<Sample> output(input.size());
+	size_t offset = 0;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+	{
+		filter.step(input.data() + offset, blockSizes[b], output.data() + offset);
+		offset += blockSizes[b];
+	}
+
+	size_t numErrors = 0;
+	for (size_t n = 0; n < input.size(); ++n)
+		numErrors += (output[n] != expected[n]);
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FilterFir " << name << ": " << numErrors << " differences with the direct form: "
+		<< (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+Samples at full scale: a run of the largest positive and negative values, then
+random values among the extremes and the whole range
+------------------------------------------------------------------------------*/
+std::vector<Sample> fullScaleInput(size_t size)
+{
+	std::vector<Sample> input(size / 3, Sample(32767, -32768));
+	const int16_t extremes[] = { 32767, -32768, 0 };
+	while (input.size() < size)
+	{
+		int16_t re = (rand() % 2) ? extremes[rand() % 3] : static_cast<int16_t>(rand() % 65536 - 32768);
+		int16_t im = (rand() % 2) ? extremes[rand() % 3] : static_cast<int16_t>(rand() % 65536 - 32768);
+		input.push_back(Sample(re, im));
+	}
+	return input;
+}
+
+/*-----------------------------------------------------------------------------
+Random coefficients, mostly positive so that the outputs saturate, whose sum of
+magnitudes over each phase is below 2^16: the outputs of 16 bits samples fit in
+32 bits. The middle coefficient of an odd length antisymmetric set is zero.
+------------------------------------------------------------------------------*/
+std::vector<int32_t> upsamplingTaps(size_t numTaps, unsigned L, dsptl_private::CoeffSymmetry symmetry)
+{
+	int32_t largest = static_cast<int32_t>(65000 / (numTaps / L));
+	std::vector<int32_t> coeff(numTaps);
+	for (size_t n = 0; n < numTaps; ++n)
+		coeff[n] = rand() % (largest + largest / 4) - largest / 4;
+	for (size_t n = 0; n < numTaps / 2 && symmetry != dsptl_private::CoeffSymmetry::none; ++n)
+		coeff[numTaps - 1 - n] = (symmetry == dsptl_private::CoeffSymmetry::symmetric) ? coeff[n] : -coeff[n];
+	if (numTaps % 2 != 0 && symmetry == dsptl_private::CoeffSymmetry::antisymmetric)
+		coeff[numTaps / 2] = 0;
+	return coeff;
+}
+
+/*-----------------------------------------------------------------------------
+Zero stuffing followed by a FIR filter, with the scaling and the saturation of
+the original FilterUpsamplingFir
+------------------------------------------------------------------------------*/
+std::vector<Sample> referenceUpsamplingFir(const std::vector<int32_t> &coeff, const std::vector<Sample> &input, unsigned L)
+{
+	unsigned shift = 15 - static_cast<unsigned>(round(log2(L)));
+	std::vector<Sample> output(input.size() * L);
+	for (size_t n = 0; n < output.size(); ++n)
+	{
+		std::complex<int64_t> y;
+		for (size_t k = n % L; k < coeff.size() && k <= n; k += L)
+			y += static_cast<int64_t>(coeff[k]) * std::complex<int64_t>(input[(n - k) / L].real(), input[(n - k) / L].imag());
+		output[n] = limitScale<Sample>(y, shift);
+	}
+	return output;
+}
+
+/*-----------------------------------------------------------------------------
+FilterUpsamplingFir must give the output of the original implementation, the
+zero stuffing followed by the direct form, for symmetric, antisymmetric and
+asymmetric coefficients with sub-filters of odd and even lengths, including the
+saturation of full scale inputs. The input is split into two calls.
+------------------------------------------------------------------------------*/
+template<unsigned L>
+bool testUpsamplingFir()
+{
+	using dsptl_private::CoeffSymmetry;
+	typedef dsptl::FilterUpsamplingFir<Sample, Sample, std::complex<int32_t>, int32_t, L> Upsampler;
+
+	std::vector<std::vector<int32_t> > coeffSets;
+	coeffSets.push_back(std::vector<int32_t>(32 * L, 1100));
+	const size_t lengths[] = { 12 * L, 13 * L, L };
+	for (size_t numTaps : lengths)
+	{
+		coeffSets.push_back(upsamplingTaps(numTaps, L, CoeffSymmetry::symmetric));
+		coeffSets.push_back(upsamplingTaps(numTaps, L, CoeffSymmetry::antisymmetric));
+		coeffSets.push_back(upsamplingTaps(numTaps, L, CoeffSymmetry::none));
+	}
+
+	bool passed = true;
+	size_t numErrors = 0;
+	for (const std::vector<int32_t> &coeff : coeffSets)
+	{
+		std::vector<Sample> input = fullScaleInput(300);
+		std::vector<Sample> expected = referenceUpsamplingFir(coeff, input, L);
+		Upsampler filter(coeff);
+		std::vector<Sample> output(input.size() * L);
+		filter.step(input.data(), 37, output.data());
+		filter.step(input.data() + 37, input.size() - 37, output.data() + 37 * L);
+		for (size_t n = 0; n < output.size(); ++n)
+			numErrors += (output[n] != expected[n]);
+	}
+	passed = numErrors == 0;
+	std::cout << "+++++ FilterUpsamplingFir L " << L << ": " << numErrors << " differences with the zero stuffing FIR: "
+		<< (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+Each channel of FilterFirBank must give the output of a FilterFir on its own,
+on the vectorized path and on the scalar path used when a coefficient does not
+fit in 16 bits. K is not a multiple of 4 or 8, so that the vectorized kernel also
+processes an incomplete group of channels. The blocks of different sizes check
+the history kept from one call to the other.
+------------------------------------------------------------------------------*/
+template<size_t K>
+bool testFirBank(const char *name, const std::vector<int32_t> &coeff)
+{
+	const size_t blockSizes[] = { 1, 7, 64, 3, 500, 2 };
+
+	std::vector<Sample> input;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+		for (size_t j = 0; j < blockSizes[b] * K; ++j)
+			input.push_back(Sample(rand() % 8001 - 4000, rand() % 8001 - 4000));
+
+	FilterFirBank<Sample, Sample, std::complex<int32_t>, int32_t, K> bank(coeff);
+	std::vector<Sample> output(input.size());
+	size_t offset = 0;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+	{
+		bank.step(input.data() + offset * K, blockSizes[b], output.data() + offset * K);
+		offset += blockSizes[b];
+	}
+
+	size_t numErrors = 0;
+	for (size_t ch = 0; ch < K; ++ch)
+	{
+		std::vector<Sample> channel(input.size() / K);
+		for (size_t t = 0; t < channel.size(); ++t)
+			channel[t] = input[t * K + ch];
+		FilterFir16 filter(coeff);
+		std::vector<Sample> expected(channel.size());
+		filter.step(channel.data(), channel.size(), expected.data());
+		for (size_t t = 0; t < channel.size(); ++t)
+			numErrors += (output[t * K + ch] != expected[t]);
+	}
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FilterFirBank K " << K << ", " << name << ": " << numErrors << " differences with FilterFir: "
+		<< (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+Random floating point sample between -1 and 1, real or complex
+------------------------------------------------------------------------------*/
+template<class T>
+void randomSample(T &x)
+{
+	x = static_cast<T>(rand() % 20001 - 10000) / 10000;
+}
+
+template<class T>
+void randomSample(std::complex<T> &x)
+{
+	T re, im;
+	randomSample(re);
+	randomSample(im);
+	x = std::complex<T>(re, im);
+}
+
+template<class T>
+std::complex<double> toComplexDouble(const T &x)
+{
+	return std::complex<double>(x, 0);
+}
+
+template<class T>
+std::complex<double> toComplexDouble(const std::complex<T> &x)
+{
+	return std::complex<double>(x.real(), x.imag());
+}
+
+/*-----------------------------------------------------------------------------
+Zero stuffing by L, FIR filter and decimation by M computed in double precision.
+The floating point filters do not scale their output.
+------------------------------------------------------------------------------*/
+template<class T, class Sample>
+std::vector<std::complex<double> > referenceFloatFilter(const std::vector<T> &coeff, const std::vector<Sample> &input, unsigned L, unsigned M)
+{
+	std::vector<std::complex<double> > output;
+	for (size_t n = 0; n < input.size() * L; n += M)
+	{
+		std::complex<double> y;
+		for (size_t k = n % L; k < coeff.size() && k <= n; k += L)
+			y += static_cast<double>(coeff[k]) * toComplexDouble(input[(n - k) / L]);
+		output.push_back(y);
+	}
+	return output;
+}
+
+/*-----------------------------------------------------------------------------
+Filtering of a block by each type of filter. Return the number of outputs.
+------------------------------------------------------------------------------*/
+template<class InType, class OutType, class InternalType, class CoefType>
+size_t filterBlock(FilterFir<InType, OutType, InternalType, CoefType> &filter, const InType *input, size_t size, OutType *output)
+{
+	filter.step(input, size, output);
+	return size;
+}
+
+template<class InType, class OutType, class InternalType, class CoefType, unsigned M>
+size_t filterBlock(dsptl::FilterDnsamplingFir<InType, OutType, InternalType, CoefType, M> &filter, const InType *input, size_t size, OutType *output)
+{
+	return filter.stepStream(input, size, output);
+}
+
+template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+size_t filterBlock(dsptl::FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L> &filter, const InType *input, size_t size, OutType *output)
+{
+	filter.step(input, size, output);
+	return size * L;
+}
+
+/*-----------------------------------------------------------------------------
+A floating point filter must match the double precision reference within the
+bound of the rounding errors of an inner product of numTaps terms: numTaps times
+the epsilon of the type times the sum of the magnitudes of the products. The
+bound does not depend on the order of the additions, so it holds for the FMA
+kernels and for the scalar loops, folded or not, used when the host does not
+support FMA or when the tree is built with DSPTL_NO_SIMD (filters_test_nosimd).
+------------------------------------------------------------------------------*/
+template<class Filter, class Sample, class T>
+bool testFloatFilter(const char *name, const std::vector<T> &coeff, unsigned L, unsigned M)
+{
+	const size_t blockSizes[] = { 1, 7, 64, 3, 250, 0, 175 };
+
+	std::vector<Sample> input;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+		for (size_t j = 0; j < blockSizes[b]; ++j)
+		{
+			Sample x;
+			randomSample(x);
+			input.push_back(x);
+		}
+	std::vector<std::complex<double> > expected = referenceFloatFilter(coeff, input, L, M);
+
+	Filter filter(coeff);
+	std::vector<Sample> output(input.size() * L / M + 1);
+	size_t offset = 0;
+	size_t numOut = 0;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+	{
+		numOut += filterBlock(filter, input.data() + offset, blockSizes[b], output.data() + numOut);
+		offset += blockSizes[b];
+	}
+
+	double sumMagnitude = 0;
+	for (size_t k = 0; k < coeff.size(); ++k)
+		sumMagnitude += std::abs(static_cast<double>(coeff[k]));
+	double bound = (coeff.size() + 1) * std::numeric_limits<T>::epsilon() * sumMagnitude * sqrt(2.0);
+	double maxError = (numOut == expected.size()) ? 0 : bound;
+	for (size_t n = 0; n < numOut && n < expected.size(); ++n)
+		maxError = std::max(maxError, std::abs(toComplexDouble(output[n]) - expected[n]));
+
+	bool passed = maxError < bound;
+	std::cout << "+++++ " << name << ", " << (dsptl_private::cpuHasAvx2Fma() ? "FMA" : "scalar") << ": maximum error "
+		<< maxError << ", bound " << bound << ": " << (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+Float or double versions of FilterFir, FilterDnsamplingFir and FilterUpsamplingFir,
+real and complex, with symmetric and asymmetric coefficients
+------------------------------------------------------------------------------*/
+template<class T>
+bool testFloatFilters(const char *name)
+{
+	typedef std::complex<T> Complex;
+	// The numbers of taps are multiples of the ratio of 3
+	std::vector<T> coeff(72), evenSymmetricCoeff(60), oddSymmetricCoeff(63);
+	for (size_t k = 0; k < coeff.size(); ++k)
+		randomSample(coeff[k]);
+	for (std::vector<T> *c : { &evenSymmetricCoeff, &oddSymmetricCoeff })
+		for (size_t k = 0; k <= c->size() / 2; ++k)
+		{
+			randomSample((*c)[k]);
+			(*c)[c->size() - 1 - k] = (*c)[k];
+		}
+
+	const std::string type(name);
+	bool passed = true;
+	for (const std::vector<T> *c : { &coeff, &evenSymmetricCoeff, &oddSymmetricCoeff })
+	{
+		std::string taps = ", " + std::to_string(c->size()) + " taps";
+		passed = testFloatFilter<FilterFir<T, T, T, T>, T>(("FilterFir " + type + taps).c_str(), *c, 1, 1) && passed;
+		passed = testFloatFilter<FilterFir<Complex, Complex, Complex, T>, Complex>(("FilterFir complex " + type + taps).c_str(), *c, 1, 1) && passed;
+		passed = testFloatFilter<dsptl::FilterDnsamplingFir<T, T, T, T, 3>, T>(("FilterDnsamplingFir " + type + taps).c_str(), *c, 1, 3) && passed;
+		passed = testFloatFilter<dsptl::FilterDnsamplingFir<Complex, Complex, Complex, T, 3>, Complex>(("FilterDnsamplingFir complex " + type + taps).c_str(), *c, 1, 3) && passed;
+		passed = testFloatFilter<dsptl::FilterUpsamplingFir<T, T, T, T, 3>, T>(("FilterUpsamplingFir " + type + taps).c_str(), *c, 3, 1) && passed;
+		passed = testFloatFilter<dsptl::FilterUpsamplingFir<Complex, Complex, Complex, T, 3>, Complex>(("FilterUpsamplingFir complex " + type + taps).c_str(), *c, 3, 1) && passed;
+	}
+	return passed;
+}
+
+/*-----------------------------------------------------------------------------
+FilterFirFixed must give the output of FilterFir with the same coefficients,
+including a single tap and odd numbers of symmetric taps. The input is split in
+blocks of different sizes, shorter and longer than the filter, to check the
+history kept from one call to step() to the other.
+------------------------------------------------------------------------------*/
+template<size_t NTaps>
+bool testFirFixed(const char *name, const std::vector<int32_t> &coeff)
+{
+	const size_t blockSizes[] = { 1, 7, 64, 3, 0, 500, 2 };
+
+	std::vector<Sample> input;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+		for (size_t j = 0; j < blockSizes[b]; ++j)
+			input.push_back(Sample(rand() % 8001 - 4000, rand() % 8001 - 4000));
+
+	FilterFir16 reference(coeff);
+	std::vector<Sample> expected(input.size());
+	reference.step(input.data(), input.size(), expected.data());
+
+	FilterFirFixed<Sample, Sample, std::complex<int32_t>, int32_t, NTaps> filter(coeff);
+	std::vector<Sample> output(input.size());
+	size_t offset = 0;
+	for (size_t b = 0; b < sizeof(blockSizes) / sizeof(blockSizes[0]); ++b)
+	{
+		filter.step(input.data() + offset, blockSizes[b], output.data() + offset);
+		offset += blockSizes[b];
+	}
+
+	size_t numErrors = 0;
+	for (size_t n = 0; n < input.size(); ++n)
+		numErrors += (output[n] != expected[n]);
+	bool passed = numErrors == 0;
+	std::cout << "+++++ FilterFirFixed " << name << ": " << numErrors << " differences with FilterFir: "
+		<< (passed ? "passed" : "FAILED") << "\n";
+	return passed;
+}
@@ -58,7 +58,12 @@ namespace dsptl
 		// Generate a number of samples equal to the size of the buffer given
 		void step(std::vector<OutType>& out)
 		{
-			for (unsigned i = 0; i < out.size(); ++i)
+			step(out.data(), out.size());
+		}
+		// Generate size samples at the location given
+		void step(OutType *out, size_t size)
+		{
+			for (size_t i = 0; i < size; ++i)
 			{
 				phase += freq;
 				// Limit the phase between 0 and 2pi
@@ -94,7 +99,12 @@ namespace dsptl
 		// Generate a number of samples equal to the size of the buffer given
 		void step(std::vector<std::complex<OutType> >& out)
 		{
-			for (unsigned i = 0; i < out.size(); ++i)
+			step(out.data(), out.size());
+		}
+		// Generate size samples at the location given
+		void step(std::complex<OutType> *out, size_t size)
+		{
+			for (size_t i = 0; i < size; ++i)
 			{
 				phase += freq;
 				// We maintain the phase between 0 and 2pi
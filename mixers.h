@@ -4,6 +4,8 @@
 
 #include <cstdint>
 #include <complex>
+#include <vector>
+#include <cassert>
 #include "generators.h" // for pi
 #include "dsp_complex.h"
 
@@ -132,7 +134,12 @@ namespace dsptl
 	{
 	public:
 		Mixer();
-		void step(std::vector<std::complex<int16_t>> & in, std::vector<std::complex<int16_t>> & out);
+		void step(const std::vector<std::complex<int16_t>> & in, std::vector<std::complex<int16_t>> & out);
+		void step(const std::complex<int16_t> *in, size_t size, std::complex<int16_t> *out);
+		// Mix a single sample and advance the local oscillator
+		std::complex<int16_t> mixOne(const std::complex<int16_t> &in);
+		// Advance the local oscillator without mixing
+		void advance(size_t numSamples);
 
 	};
 
@@ -166,25 +173,58 @@ namespace dsptl
 	@param out
 	------------------------------------------------------------------------------*/
 	template <unsigned N >
-	void Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::step(std::vector<std::complex<int16_t>> & in, std::vector<std::complex<int16_t>> & out)
+	void Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::step(const std::vector<std::complex<int16_t>> & in, std::vector<std::complex<int16_t>> & out)
+	{
+		assert(in.size() <= out.size());
+		step(in.data(), in.size(), out.data());
+	}
+
+	/*-----------------------------------------------------------------------------
+	Performs the mixing between a range of input samples and the local oscillator
+	without any copy. The mixing can be made in place.
+
+	@param in First input sample
+	@param size Number of samples to mix
+	@param out Room for size output samples
+	------------------------------------------------------------------------------*/
+	template <unsigned N >
+	void Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::step(const std::complex<int16_t> *in, size_t size, std::complex<int16_t> *out)
+	{
+		for (size_t k = 0; k < size; ++k)
+			out[k] = mixOne(in[k]);
+	}
+
+	/*-----------------------------------------------------------------------------
+	Performs the mixing of a single sample with the local oscillator, then advances
+	the phase of the local oscillator by one sample. The result is the same as
+	step() for one sample.
+
+	@param in Input sample
+	@return Mixed sample
+	------------------------------------------------------------------------------*/
+	template <unsigned N >
+	inline std::complex<int16_t> Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::mixOne(const std::complex<int16_t> &in)
 	{
 		// Full qualification of the base class members is due to a bug in gcc453
-		for (size_t k = 0; k < in.size(); ++k)
-		{		
-			// To maintain a gain of 1 , the output scaling must correspond to the amplitude of the local oscillator
-			out[k] = limitScale16(in[k] * std::complex<int32_t>(_Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::ptable[(_Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::phi + N / 4) % N],
-							_Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::ptable[_Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::phi]), 14);
-			_Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::phi = (_Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::phi + _Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::freq) % N;
-			
-#if 0
-			// Same as above without the full qualification
-			// To maintain a gain of 1 , the output scaling must correspond to the amplitude of the local oscillator
-			out[k] = limitScale16(in[k] * std::complex<int32_t>(this->ptable[(this->phi + N / 4) % N],
-							this->ptable[this->phi]), 14);
-
-			this->phi = (this->phi + this->freq) % N;
-#endif
-		}
+		typedef _Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N > Base;
+		// To maintain a gain of 1 , the output scaling must correspond to the amplitude of the local oscillator
+		std::complex<int16_t> out = limitScale16(in * std::complex<int32_t>(Base::ptable[(Base::phi + N / 4) % N],
+			Base::ptable[Base::phi]), 14);
+		Base::phi = (Base::phi + Base::freq) % N;
+		return out;
+	}
+
+	/*-----------------------------------------------------------------------------
+	Advances the phase of the local oscillator as if numSamples samples had been
+	mixed. Used to skip samples which are not needed.
+
+	@param numSamples Number of samples to skip
+	------------------------------------------------------------------------------*/
+	template <unsigned N >
+	void Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N >::advance(size_t numSamples)
+	{
+		typedef _Mixer<std::complex<int16_t>, std::complex<int16_t>, int16_t, N > Base;
+		Base::phi = static_cast<int16_t>((Base::phi + (numSamples % N) * Base::freq) % N);
 	}
 
 } // end of namespace
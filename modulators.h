@@ -102,9 +102,16 @@ namespace dsptl
 		/// The input bits can be either 0,1 or -1,1
 		void step(const std::vector<uint8_t> & bits , std::vector<std::complex<T> > & out)
 		{
-			const int N = 4;
 			assert(bits.size() == out.size());
-			for (size_t i = 0; i < bits.size(); i++)
+			step(bits.data(), bits.size(), out.data());
+		}
+
+		/// Version of step() working on a range of bits without any copy.
+		/// out must have room for numBits symbols
+		void step(const uint8_t *bits, size_t numBits, std::complex<T> *out)
+		{
+			const int N = 4;
+			for (size_t i = 0; i < numBits; i++)
 			{
 				// Generates a state from 0 to 3
 				state += (bits[i] > 0)? 1 : (N-1);
@@ -169,9 +176,17 @@ namespace dsptl
 		void step(const std::vector<uint8_t> & bits , std::vector<std::complex<T> > & out)
 		{
 			assert(bits.size() == 2 * out.size());
+			step(bits.data(), bits.size(), out.data());
+		}
+
+		/// Version of step() working on a range of bits without any copy.
+		/// numBits must be even and out must have room for numBits / 2 symbols
+		void step(const uint8_t *bits, size_t numBits, std::complex<T> *out)
+		{
+			assert(numBits % 2 == 0);
 
 			// Bits are grouped 
-			for (size_t i = 0; i < bits.size() /2 ; i++)
+			for (size_t i = 0; i < numBits /2 ; i++)
 			{
 				// The sequence of bits 00110110 become the symbols 0, 3, 1, 2
 				state = ((bits[2 * i] > 0 ?1:0) << 1) | (bits[2 * i + 1] > 0? 1:0);
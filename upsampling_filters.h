@@ -15,7 +15,10 @@ performing an upconversion.
 
 #include <cassert>
 #include <vector>
+#include <memory>
+#include <type_traits>
 #include "dsp_complex.h"
+#include "dsptl_filter_common.h"
 
 namespace dsptl
 {
@@ -32,6 +35,24 @@ namespace dsptl
 	It is the responsibility of the caller to make sure that the different types
 	work smoothly. Overflow and underflow conditions must not occur
 
+	With float or double samples, real or complex, the output is not scaled: the
+	gain is the one of the coefficients. The inner products then use the FMA
+	kernels of dsptl_simd.h when the host supports them. leftShiftFactor is not
+	applied either: with the same coefficients divided by 2^15, a float output is
+	the integer output divided by L. Multiply the coefficients by L to get the
+	same gain.
+
+	Symmetric and antisymmetric (linear phase) sets of coefficients are detected by
+	setCoefficients(). The polyphase sub-filter of phase p is then the mirror image
+	of the sub-filter of phase L-1-p and both outputs are computed together. With
+	floating point internal types, they are built from the sum and the difference of
+	the mirrored samples, with half of the multiplications. With integer internal
+	types, the sum of two outputs could overflow: each output is computed on its own
+	and the two phases only share the loads of the samples and of the coefficients.
+
+	The polyphase tables are derived from the coefficients once and shared by the
+	filters built from the same shared coefficients. See setCoefficients().
+
 	***************************************************************************/
 	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
 	class FilterUpsamplingFir
@@ -40,10 +61,15 @@ namespace dsptl
 		/// Constructor. Coefficients are defined. Size for the internal
 		/// buffer is reserved based on the number of coefficients
 		FilterUpsamplingFir(const std::vector<CoefType> &firCoeff = std::vector<CoefType>());
+		FilterUpsamplingFir(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
 		// Change the coefficients of the filter
 		void setCoefficients(const std::vector<CoefType> &firCoeff);
+		// Version of setCoefficients() sharing the coefficients and the polyphase tables with other filters
+		void setCoefficients(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
 		// This function is called for each iteration of the filtering process
 		void step(const std::vector<InType> & signal, std::vector<OutType> & filteredSignal, bool flush = false);
+		// Version of step working on a range of samples without any copy
+		void step(const InType *signal, size_t size, OutType *filteredSignal, bool flush = false);
 		// Version of step with an iterator as destination
 		void step(const std::vector<InType> & signal, typename std::vector<OutType>::iterator  filteredSignal, bool flush = false);
 		/// Reset the internal counters and buffers
@@ -68,8 +94,25 @@ namespace dsptl
 
 
 	private:
-		std::vector<CoefType> coeff;		///< Coefficients
-		std::vector<InType> buffer;  	///< History buffer
+		/// Tables derived from the coefficients, shared by the filters using the same coefficients
+		struct PolyphaseTables
+		{
+			PolyphaseTables(const std::shared_ptr<const std::vector<CoefType> > &firCoeff);
+			std::shared_ptr<const std::vector<CoefType> > coeff;	///< Coefficients
+			std::vector<CoefType> phaseCoeff;		///< Coefficients of the L sub-filters, one after the other
+			dsptl_private::CoeffSymmetry symmetry;	///< Symmetry of the coefficients
+			std::vector<CoefType> foldedSum;		///< Sums of the mirrored coefficients of each pair of phases
+			std::vector<CoefType> foldedDiff;		///< Differences of the mirrored coefficients of each pair of phases
+		};
+
+		// Insert a sample in the history buffer and compute the L corresponding outputs
+		void filterSample(const InType &sample, InternalType *y);
+		// Outputs of the pairs of mirrored phases of symmetric coefficients
+		void filterPhasePairs(const InType *w, InternalType *y, std::true_type);
+		void filterPhasePairs(const InType *w, InternalType *y, std::false_type);
+
+		std::shared_ptr<const PolyphaseTables> tables;	///< Coefficients and polyphase tables, possibly shared with other filters
+		std::vector<InType> buffer;  	///< History buffer. Each sample is stored twice
 		unsigned top; 					///< Current insertion point in the history buffer 
 		int leftShiftFactor;			///< Number of left shifts to operate on the output. This is linked to the upsampling ratio
 		unsigned length;				///< Number of coefficients of the filter excluding the null coeff at the end
@@ -95,6 +138,20 @@ namespace dsptl
 
 	}
 
+	/***********************************************************************//**
+	Upsampling FIR Filter Constructor with coefficients shared with other filters,
+	for example obtained from the cache of dsptl_filter_design.h
+
+	@param firCoeff Filter Coefficients. Must not be null
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+	FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::FilterUpsamplingFir(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+		: top(0), length(0), impLength(0)
+	{
+		setCoefficients(firCoeff);
+	}
+
 	/***********************************************************************//**
 	Upsampling FIR Filter Constructor
 
@@ -107,22 +164,211 @@ namespace dsptl
 	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
 	void FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::setCoefficients(const std::vector<CoefType> &firCoeff)
 	{
-		assert(!firCoeff.empty());
+		setCoefficients(std::shared_ptr<const std::vector<CoefType> >(new std::vector<CoefType>(firCoeff)));
+	}
+
+	/***********************************************************************//**
+	Sets the coefficients without copying them. The filters using the same table
+	share it, as well as the polyphase tables derived from it. The table must not
+	be modified afterwards.
+
+	@param firCoeff Filter Coefficients. Must not be null
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+	void FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::setCoefficients(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+	{
+		assert(firCoeff && !firCoeff->empty());
 		// We verify that the number of coefficient is a multiple
 		// of L
-		assert(firCoeff.size() % L == 0);
+		assert(firCoeff->size() % L == 0);
 
-		coeff = firCoeff;
+		tables = dsptl_private::sharedTables<PolyphaseTables>(firCoeff);
 		// The internal history buffer is sized according to the 
-		// number of coefficients
-		buffer.resize(firCoeff.size() / L);
+		// number of coefficients. Each sample is stored twice so that the
+		// history is always contiguous
+		buffer.resize(2 * (firCoeff->size() / L));
+		reset();
 		// Compute the scaling factor
 		leftShiftFactor = static_cast<int>(round(log2(L)));
 		// Compute the length of the filter. i.e. the numbers of coefficientss
+		const std::vector<CoefType> &coeff = *firCoeff;
 		length = impLength = coeff.size();
-		while (coeff[length -1 ] == 0) --length ;
+		while (length > 0 && coeff[length -1 ] == 0) --length ;
+	}
 
+	/***********************************************************************//**
+	Polyphase tables of a set of coefficients
 
+	@param firCoeff Filter Coefficients. The number of coefficients is a multiple of L
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+	FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::PolyphaseTables::PolyphaseTables(const std::shared_ptr<const std::vector<CoefType> > &firCoeff)
+		: coeff(firCoeff)
+	{
+		const std::vector<CoefType> &h = *coeff;
+		size_t histSize = h.size() / L;
+		// The sub-filter h[p + L*i] of phase p is stored contiguously from p * histSize
+		// so that each phase is a unit stride inner product with the history
+		phaseCoeff.resize(h.size());
+		for (size_t p = 0; p < L; ++p)
+			for (size_t i = 0; i < histSize; ++i)
+				phaseCoeff[p * histSize + i] = h[p + L * i];
+
+		// For symmetric coefficients, the sub-filter h[p + L*i] of phase p is the mirror image
+		// of the sub-filter of phase L-1-p. The sums and differences of the mirrored coefficients
+		// are stored for each pair of phases p < L-1-p. They are only used with floating
+		// point internal types
+		symmetry = dsptl_private::selectSymmetry<InternalType, InType>(h);
+		size_t halfHist = histSize / 2;
+		if (symmetry != dsptl_private::CoeffSymmetry::none && dsptl_private::IsFloatingSample<InternalType>::value)
+		{
+			for (size_t p = 0; p < L / 2; ++p)
+			{
+				for (size_t i = 0; i < halfHist; ++i)
+				{
+					foldedSum.push_back(h[p + L * i] + h[p + L * (histSize - 1 - i)]);
+					foldedDiff.push_back(h[p + L * i] - h[p + L * (histSize - 1 - i)]);
+				}
+			}
+		}
+	}
+
+
+	/***********************************************************************//**
+	Insert a sample in the history buffer then compute the L output samples
+	corresponding to this input sample.\n
+
+	The sample is written twice, at top and at top plus the size of the history,
+	so that the history is always contiguous from top, the most recent sample first.
+	The output of phase offset is the inner product of the history with the
+	coefficients offset, offset + L, offset + 2L..., which are stored contiguously
+	in phaseCoeff.\n
+
+	With symmetric coefficients, the outputs of phases p and q = L-1-p are computed
+	together by filterPhasePairs(). With an odd upsampling ratio, the middle phase is
+	itself symmetric and is folded like the taps of FilterFir.
+
+	@param sample Sample to insert in the history
+	@param y L output values before scaling
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+	void FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::filterSample(const InType &sample, InternalType *y)
+	{
+		size_t histSize = buffer.size() / 2;	// Number of taps of each phase
+		buffer[top] = sample;
+		buffer[top + histSize] = sample;
+		const InType *w = &buffer[top];
+		const std::vector<CoefType> &phaseCoeff = tables->phaseCoeff;
+
+		if (tables->symmetry == dsptl_private::CoeffSymmetry::none)
+		{
+			for (size_t offset = 0; offset < L; ++offset)
+			{
+				const CoefType *h = &phaseCoeff[offset * histSize];
+				dsptl_private::innerProduct(y[offset], h, w, histSize);
+			}
+		}
+		else
+		{
+			filterPhasePairs(w, y, typename dsptl_private::IsFloatingSample<InternalType>::type());
+			// With an odd upsampling ratio, the middle phase is itself symmetric
+			if (L % 2 != 0)
+			{
+				const CoefType *h = &phaseCoeff[(L / 2) * histSize];
+				y[L / 2] = dsptl_private::foldedInnerProduct<InternalType>(h, w, histSize, tables->symmetry);
+			}
+		}
+
+		top = (top == 0) ? static_cast<unsigned>(histSize - 1) : top - 1;
+	}
+
+	/***********************************************************************//**
+	Outputs of the phases p and q = L-1-p of symmetric coefficients, for floating
+	point internal types. With w the history and h the sub-filter of phase p:
+	@arg A = sum h[i] (w[i] + w[H-1-i]) = y_p + y_q
+	@arg B = sum h[i] (w[i] - w[H-1-i]) = y_p - y_q
+	Both sums only need H/2 multiplications because the terms are mirrored. y_q is
+	negated for antisymmetric coefficients.
+
+	@param w History, the most recent sample first
+	@param y L output values before scaling
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+	void FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::filterPhasePairs(const InType *w, InternalType *y, std::true_type)
+	{
+		size_t histSize = buffer.size() / 2;
+		size_t halfHist = histSize / 2;
+		bool odd = (histSize % 2 != 0);
+		for (size_t p = 0; p < L / 2; ++p)
+		{
+			const CoefType *sum = &tables->foldedSum[p * halfHist];
+			const CoefType *diff = &tables->foldedDiff[p * halfHist];
+			InternalType a{};
+			InternalType b{};
+			for (size_t i = 0; i < halfHist; ++i)
+			{
+				InternalType first(w[i]);
+				InternalType last(w[histSize - 1 - i]);
+				a += sum[i] * (first + last);
+				b += diff[i] * (first - last);
+			}
+			// The middle sample is only involved in A
+			if (odd)
+				a += tables->phaseCoeff[p * histSize + halfHist] * (InternalType(w[halfHist]) + InternalType(w[halfHist]));
+			y[p] = dsptl_private::halve(a + b);
+			y[L - 1 - p] = dsptl_private::halve(a - b);
+			if (tables->symmetry == dsptl_private::CoeffSymmetry::antisymmetric)
+				y[L - 1 - p] = -y[L - 1 - p];
+		}
+	}
+
+	/***********************************************************************//**
+	Outputs of the phases p and q = L-1-p of symmetric coefficients, for integer
+	internal types. y_p + y_q may not fit in the internal type, so each output is
+	accumulated on its own. With h the sub-filter of phase p, the sub-filter of
+	phase q is h in reverse order, so that the mirrored samples w[i] and w[H-1-i]
+	and the mirrored coefficients h[i] and h[H-1-i] are loaded once for both:
+	@arg y_p += h[i] w[i] + h[H-1-i] w[H-1-i]
+	@arg y_q += h[H-1-i] w[i] + h[i] w[H-1-i]
+	y_q is negated for antisymmetric coefficients.
+
+	@param w History, the most recent sample first
+	@param y L output values before scaling
+
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+	void FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::filterPhasePairs(const InType *w, InternalType *y, std::false_type)
+	{
+		size_t histSize = buffer.size() / 2;
+		size_t halfHist = histSize / 2;
+		for (size_t p = 0; p < L / 2; ++p)
+		{
+			const CoefType *h = &tables->phaseCoeff[p * histSize];
+			InternalType yp{};
+			InternalType yq{};
+			for (size_t i = 0; i < halfHist; ++i)
+			{
+				InternalType first(w[i]);
+				InternalType last(w[histSize - 1 - i]);
+				yp += h[i] * first;
+				yp += h[histSize - 1 - i] * last;
+				yq += h[histSize - 1 - i] * first;
+				yq += h[i] * last;
+			}
+			// The middle sample has the same coefficient in both phases
+			if (histSize % 2 != 0)
+			{
+				InternalType middle(w[halfHist]);
+				yp += h[halfHist] * middle;
+				yq += h[halfHist] * middle;
+			}
+			y[p] = yp;
+			y[L - 1 - p] = (tables->symmetry == dsptl_private::CoeffSymmetry::antisymmetric) ? -yq : yq;
+		}
 	}
 
 
@@ -132,8 +378,8 @@ namespace dsptl
 	The algorithm uses an internal buffer with a length equal to the number of coefficients
 	divided by the upsampling ratio \n
 	The current input value is inserted in the buffer at the correct location, then the convolution
-	is computed. The history buffer is processed with  a stride of 1 while the
-	coefficient buffer is processed with a stride of L\n
+	is computed. The history buffer and the coefficients of each phase are both
+	processed with a stride of 1\n
 
 	The user must make sure that the internal type is large enough to contain the
 	accumulated sum of the convolution operation\n
@@ -152,45 +398,42 @@ namespace dsptl
 		if (!flush)
 			assert(signal.size() * L == filteredSignal.size());
 
-		assert(!coeff.empty());
+		step(signal.data(), signal.size(), filteredSignal.data(), flush);
+	}
+
+	/***********************************************************************//**
+	Version of the step function which filters a range of samples without any copy,
+	for example part of a larger capture buffer. The scaling is the one of
+	step(const std::vector<InType> &, std::vector<OutType> &, bool)
+
+	@param signal First sample of the input of the filter
+	@param size Number of input samples
+	@param filteredSignal Output of the filter. Room for L times size samples plus
+	any space required for flushing. The output must not overlap the input.
+	@param flush If true the history buffer is fully flushed in the output buffer
 
-		InternalType y;  				// Output result
-		unsigned  n;				// Counting indexes
-		size_t histSize = buffer.size();	// Number of taps in the filter
-		size_t inputSize = signal.size();	// Number of input samples
+	***************************************************************************/
+	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
+	void FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::step(const InType *signal, size_t size, OutType *filteredSignal, bool flush)
+	{
+		assert(tables);
+
+		InternalType y[L];  				// Output result
+		size_t inputSize = size;			// Number of input samples
 
 
 		for (unsigned j = 0; j < inputSize; j++)
 		{
 			// This loop is executed for each of the input samples
-			buffer[top] = signal[j];
-			n = 0;
-
 			// For each input sample, we compute L output samples
+			filterSample(signal[j], y);
 			for (size_t offset = 0; offset < L; ++offset)
 			{
-				n = offset;
-				y = InternalType();
-
-				// Process samples before and including Top
-				for (int k = top; k >= 0; k--, n += L)
-				{
-					y += coeff[n] * buffer[k];
-				}
-				// Process samples after Top
-				for (unsigned k = histSize - 1; k > top; k--, n += L)
-				{
-					y += coeff[n] * buffer[k];
-				}
-
 				// The following line has been replaced synchronously with the addtion of an overload of the function limitScale in 
 				// order to hangle the case where the types are not complex
 				//filteredSignal[L*j + offset] = limitScale<typename OutType::value_type, typename InternalType::value_type>(y, 15 - leftShiftFactor);
-				filteredSignal[L*j + offset] = limitScale<OutType>(y, 15 - leftShiftFactor);
+				filteredSignal[L*j + offset] = dsptl_private::outputScale<OutType>(y[offset], 15 - leftShiftFactor);
 			}
-
-			top++;
-			if (top >= histSize) top = 0;
 		}
 
 		if (flush)
@@ -198,35 +441,9 @@ namespace dsptl
 			// We flush with length / L zeros
 			for (unsigned j = inputSize; j < (inputSize + length / L); j++)
 			{
-				// This loop is executed for each of the input samples
-				buffer[top] = InType{};
-				n = 0;
-
-				// For each input sample, we compute L output samples
+				filterSample(InType{}, y);
 				for (size_t offset = 0; offset < L; ++offset)
-				{
-					n = offset;
-					y = InternalType();
-
-					// Process samples before and including Top
-					for (int k = top; k >= 0; k--, n += L)
-					{
-						y += coeff[n] * buffer[k];
-					}
-					// Process samples after Top
-					for (unsigned k = histSize - 1; k > top; k--, n += L)
-					{
-						y += coeff[n] * buffer[k];
-					}
-
-					// The following line has been replaced synchronously with the addtion of an overload of the function limitScale in 
-					// order to hangle the case where the types are not complex
-					//filteredSignal[L*j + offset] = limitScale<typename OutType::value_type, typename InternalType::value_type>(y, 15 - leftShiftFactor);
-					filteredSignal[L*j + offset] = limitScale<OutType, InternalType>(y, 15 - leftShiftFactor);
-				}
-
-				top++;
-				if (top >= histSize) top = 0;
+					filteredSignal[L*j + offset] = dsptl_private::outputScale<OutType>(y[offset], 15 - leftShiftFactor);
 			}
 		}
 
@@ -240,47 +457,21 @@ namespace dsptl
 	template<class InType, class OutType, class InternalType, class CoefType, unsigned L>
 	void FilterUpsamplingFir<InType, OutType, InternalType, CoefType, L>::step(const std::vector<InType> & signal, typename std::vector<OutType>::iterator  filteredSignal, bool flush)
 	{
-		assert(!coeff.empty());
+		assert(tables);
 		int shiftFactor = 0; // This will need to be modified in order to accomodate the behavior of the version
 		// of the step function which takes a vector as input.
 
-		InternalType y;  				// Output result
-		unsigned  n;				// Counting indexes
-		size_t histSize = buffer.size();	// Number of taps in the filter
+		InternalType y[L];  				// Output result
 		size_t inputSize = signal.size();	// Number of input samples
 
 
 		for (unsigned j = 0; j < inputSize; j++)
 		{
 			// This loop is executed for each of the input samples
-			buffer[top] = signal[j];
-			n = 0;
-
 			// For each input sample, we compute L output samples
+			filterSample(signal[j], y);
 			for (size_t offset = 0; offset < L; ++offset)
-			{
-				n = offset;
-				y = InternalType();
-
-				// Process samples before and including Top
-				for (int k = top; k >= 0; k--, n += L)
-				{
-					y += coeff[n] * buffer[k];
-				}
-				// Process samples after Top
-				for (unsigned k = histSize - 1; k > top; k--, n += L)
-				{
-					y += coeff[n] * buffer[k];
-				}
-
-				// The following line has been replaced synchronzusly with the addtion of an overload of the function limitScale in 
-				// order to hangle the case where the types are not complex
-				//filteredSignal[L*j + offset] = limitScale<typename OutType::value_type, typename InternalType::value_type>(y, 15 - leftShiftFactor);
-				filteredSignal[L*j + offset] = limitScale<OutType,  InternalType>(y, shiftFactor);
-			}
-
-			top++;
-			if (top >= histSize) top = 0;
+				filteredSignal[L*j + offset] = dsptl_private::outputScale<OutType>(y[offset], shiftFactor);
 		}
 
 		if (flush)
@@ -288,35 +479,9 @@ namespace dsptl
 			// We flush with length / L zeros
 			for (unsigned j = inputSize; j < (inputSize + length / L); j++)
 			{
-				// This loop is executed for each of the input samples
-				buffer[top] = InType{};
-				n = 0;
-
-				// For each input sample, we compute L output samples
+				filterSample(InType{}, y);
 				for (size_t offset = 0; offset < L; ++offset)
-				{
-					n = offset;
-					y = InternalType();
-
-					// Process samples before and including Top
-					for (int k = top; k >= 0; k--, n += L)
-					{
-						y += coeff[n] * buffer[k];
-					}
-					// Process samples after Top
-					for (unsigned k = histSize - 1; k > top; k--, n += L)
-					{
-						y += coeff[n] * buffer[k];
-					}
-
-					// The following line has been replaced synchronously with the addtion of an overload of the function limitScale in 
-					// order to hangle the case where the types are not complex
-					//filteredSignal[L*j + offset] = limitScale<typename OutType::value_type, typename InternalType::value_type>(y, 15 - leftShiftFactor);
-					filteredSignal[L*j + offset] = limitScale<OutType, InternalType>(y, shiftFactor);
-				}
-
-				top++;
-				if (top >= histSize) top = 0;
+					filteredSignal[L*j + offset] = dsptl_private::outputScale<OutType>(y[offset], shiftFactor);
 			}
 		}
 